@@ -12,10 +12,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <unistd.h>
 
 #include "ftdi_spi.h"
+#include "mock_spi.h"
 
 unsigned int         chunksize;                 // set on open to the maximum size that can be sent/received per call
 static bool          ftdi_device_opened;        // true if device was opened (and should be closed at exit)
@@ -23,11 +25,16 @@ static bool          ftdi_set_device_latency;        // true if latency was set
 static unsigned char ftdi_original_latency;          // saved original FTDI latency value
 static bool          slow_clock = true;
 
-static struct ftdi_context ftdi_ctx;        // context for libftdi
+static struct ftdi_context ftdi_ctx;           // context for libftdi
+static e_host_spi_backend  spi_backend;        // selected SPI backend
+
+static FILE *          capture_file;         // SPI capture file (or nullptr when not capturing)
+static struct timespec capture_start;        // time capture was opened
 
 static void ftdi_put_byte(uint8_t data);
 static void ftdi_put_word(uint16_t data);
 static void host_spi_cleanup();
+static void capture_record(uint8_t type, uint8_t cs, size_t num, const uint8_t * data);
 
 // Toggle FTDI ADBUS3 (aka CTS) line used as FPGA SS on iCEBreaker (and UPduino 3.x via TP11)
 // NOTE: cs = false to select (active low)
@@ -40,6 +47,17 @@ void host_spi_cs(bool cs)
         gpio_pins |= SPI_CS;
     }
 
+    if (capture_file)
+    {
+        capture_record(HOST_SPI_REC_CS, cs, 0, nullptr);
+    }
+
+    if (spi_backend == HOST_SPI_MOCK)
+    {
+        mock_spi_cs(cs);
+        return;
+    }
+
     ftdi_put_byte(SET_BITS_LOW);
     ftdi_put_byte(gpio_pins);
     ftdi_put_byte(SPI_OUTPUTS);
@@ -109,20 +127,39 @@ int host_spi_xfer_bytes(size_t num, uint8_t * inout)
 
     //    host_spi_cs(false);
 
-    // read CIPO, write COPI, LSB first, update data on negative clock edge
-    ftdi_put_byte(MPSSE_DO_READ | MPSSE_DO_WRITE /* | MPSSE_LSB */ | MPSSE_WRITE_NEG);
-    ftdi_put_word(static_cast<uint16_t>(num - 1));
+    if (capture_file)
+    {
+        capture_record(HOST_SPI_REC_XFER, 0, num, inout);
+    }
 
-    int rc = ftdi_write_data(&ftdi_ctx, inout, static_cast<int>(num));
-    if (rc != static_cast<int>(num))
+    if (spi_backend == HOST_SPI_MOCK)
     {
-        fprintf(stderr, "host_spi_xfer_bytes: ftdi_write_data failed (c=%d, expected %zu).\n", rc, num);
-        fatal();
+        mock_spi_xfer_bytes(num, inout);
     }
+    else
+    {
+        // read CIPO, write COPI, LSB first, update data on negative clock edge
+        ftdi_put_byte(MPSSE_DO_READ | MPSSE_DO_WRITE /* | MPSSE_LSB */ | MPSSE_WRITE_NEG);
+        ftdi_put_word(static_cast<uint16_t>(num - 1));
+
+        int rc = ftdi_write_data(&ftdi_ctx, inout, static_cast<int>(num));
+        if (rc != static_cast<int>(num))
+        {
+            fprintf(stderr, "host_spi_xfer_bytes: ftdi_write_data failed (c=%d, expected %zu).\n", rc, num);
+            fatal();
+        }
 
-    for (size_t i = 0; i < num; i++)
+        for (size_t i = 0; i < num; i++)
+        {
+            inout[i] = ftdi_get_byte();
+        }
+    }
+
+    // received bytes follow sent bytes in capture record
+    if (capture_file && fwrite(inout, 1, num, capture_file) != num)
     {
-        inout[i] = ftdi_get_byte();
+        fprintf(stderr, "host_spi_xfer_bytes: capture write failed, capture stopped.\n");
+        host_spi_capture_close();
     }
 
     //    host_spi_cs(true);
@@ -130,8 +167,46 @@ int host_spi_xfer_bytes(size_t num, uint8_t * inout)
     return 0;
 }
 
+void host_spi_set_backend(e_host_spi_backend backend)
+{
+    spi_backend = backend;
+}
+
+// open mock Xosera backend (no FTDI device)
+static int host_spi_open_mock()
+{
+    mock_spi_reset();
+
+    printf("Opened mock Xosera SPI backend...\n");
+
+    chunksize = 4096;
+
+    atexit(host_spi_cleanup);
+
+    const char * capture_name = getenv(HOST_SPI_CAPTURE_ENV);
+    if (capture_name && *capture_name && host_spi_capture_open(capture_name) < 0)
+    {
+        return -1;
+    }
+
+    printf("Success.\n");
+
+    return 0;
+}
+
 int host_spi_open()
 {
+    const char * backend_name = getenv(HOST_SPI_BACKEND_ENV);
+    if (backend_name && strcmp(backend_name, "mock") == 0)
+    {
+        spi_backend = HOST_SPI_MOCK;
+    }
+
+    if (spi_backend == HOST_SPI_MOCK)
+    {
+        return host_spi_open_mock();
+    }
+
     int rc = ftdi_init(&ftdi_ctx);
     if (rc != 0)
     {
@@ -203,6 +278,12 @@ int host_spi_open()
 
     atexit(host_spi_cleanup);
 
+    const char * capture_name = getenv(HOST_SPI_CAPTURE_ENV);
+    if (capture_name && *capture_name && host_spi_capture_open(capture_name) < 0)
+    {
+        fatal();
+    }
+
     // enter MPSSE, mask ignored
     if (ftdi_set_bitmode(&ftdi_ctx, 0x00, BITMODE_MPSSE) < 0)
     {
@@ -243,6 +324,8 @@ int host_spi_close()
 
 static void host_spi_cleanup()
 {
+    host_spi_capture_close();
+
     if (ftdi_device_opened)
     {
         if (ftdi_set_device_latency)
@@ -256,3 +339,68 @@ static void host_spi_cleanup()
         ftdi_device_opened = false;
     }
 }
+
+// returns nanoseconds elapsed since capture_start
+static uint64_t capture_time_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return static_cast<uint64_t>(now.tv_sec - capture_start.tv_sec) * 1000000000ULL +
+           static_cast<uint64_t>(now.tv_nsec) - static_cast<uint64_t>(capture_start.tv_nsec);
+}
+
+// write capture record header (and num bytes of sent data for transfers)
+static void capture_record(uint8_t type, uint8_t cs, size_t num, const uint8_t * data)
+{
+    host_spi_capture_record_t rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.time_ns = capture_time_ns();
+    rec.num     = static_cast<uint32_t>(num);
+    rec.type    = type;
+    rec.cs      = cs ? 1 : 0;
+
+    if (fwrite(&rec, sizeof(rec), 1, capture_file) != 1 || (num && fwrite(data, 1, num, capture_file) != num))
+    {
+        fprintf(stderr, "capture_record: capture write failed, capture stopped.\n");
+        host_spi_capture_close();
+    }
+}
+
+int host_spi_capture_open(const char * filename)
+{
+    host_spi_capture_close();
+
+    capture_file = fopen(filename, "wb");
+    if (capture_file == nullptr)
+    {
+        fprintf(stderr, "host_spi_capture_open: can't open \"%s\" (%s).\n", filename, strerror(errno));
+        return -1;
+    }
+
+    host_spi_capture_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, HOST_SPI_CAPTURE_MAGIC, sizeof(hdr.magic));
+    hdr.version = HOST_SPI_CAPTURE_VERSION;
+
+    if (fwrite(&hdr, sizeof(hdr), 1, capture_file) != 1)
+    {
+        fprintf(stderr, "host_spi_capture_open: can't write \"%s\".\n", filename);
+        host_spi_capture_close();
+        return -1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &capture_start);
+    printf("Capturing SPI traffic to \"%s\"...\n", filename);
+
+    return 0;
+}
+
+void host_spi_capture_close()
+{
+    if (capture_file)
+    {
+        fclose(capture_file);
+        capture_file = nullptr;
+    }
+}
@@ -9,6 +9,7 @@
 #define HOST_SPI_H
 
 #include <ftdi.h>
+#include <stddef.h>
 #include <stdint.h>
 
 // Thanks to https://github.com/YosysHQ/icestorm/tree/master/iceprog
@@ -47,10 +48,57 @@
 #define FTDI_FT2232H 0x6010        // FT2232H Hi-Speed Dual USB UART/FIFO
 #define FTDI_FT4232H 0x6011        // FT4232H Hi-Speed Quad USB UART
 
+// SPI capture file format (written by host_spi_capture_open, played back by "host_spi -p")
+//
+// File starts with host_spi_capture_header_t, followed by a host_spi_capture_record_t for each CS change or transfer.
+// A HOST_SPI_REC_XFER record is followed by num bytes sent, then num bytes received.  All fields are in host byte
+// order (little-endian on all supported hosts).
+//
+// NOTE: Setting environment variable XOSERA_SPI_CAPTURE to a filename captures all SPI traffic from host_spi_open on.
+#define HOST_SPI_CAPTURE_MAGIC   "XOSPICAP"        // 8 byte file signature (no NUL)
+#define HOST_SPI_CAPTURE_VERSION 1
+#define HOST_SPI_CAPTURE_ENV     "XOSERA_SPI_CAPTURE"
+
+enum e_host_spi_rec
+{
+    HOST_SPI_REC_CS   = 0x01,        // chip select change, cs = new CS level (0 = selected)
+    HOST_SPI_REC_XFER = 0x02         // SPI transfer of num bytes (sent data, then received data)
+};
+
+typedef struct host_spi_capture_header
+{
+    char     magic[8];        // HOST_SPI_CAPTURE_MAGIC
+    uint32_t version;         // HOST_SPI_CAPTURE_VERSION
+    uint32_t reserved;        // zero
+} host_spi_capture_header_t;
+
+typedef struct host_spi_capture_record
+{
+    uint64_t time_ns;         // nanoseconds since capture was opened
+    uint32_t num;             // number of bytes transferred (HOST_SPI_REC_XFER) or zero
+    uint8_t  type;            // e_host_spi_rec type
+    uint8_t  cs;              // CS level (HOST_SPI_REC_CS)
+    uint16_t reserved;        // zero
+} host_spi_capture_record_t;
+
+// SPI backend selection (must be set before host_spi_open)
+//
+// NOTE: Setting environment variable XOSERA_SPI_BACKEND to "mock" also selects HOST_SPI_MOCK.
+#define HOST_SPI_BACKEND_ENV "XOSERA_SPI_BACKEND"
+
+enum e_host_spi_backend
+{
+    HOST_SPI_FTDI = 0,        // FTDI USB device connected to Xosera FPGA (default)
+    HOST_SPI_MOCK = 1         // in-process Xosera register and VRAM model (no hardware needed, see mock_spi.cpp)
+};
+
 extern unsigned int chunksize;                   // set on open to the maximum size that can be sent/received per call
 int                 host_spi_open();             // open FTDI device for FPGA SPI I/O
 int                 host_spi_close();            // close FTDI device
 void                host_spi_cs(bool cs);        // cs = false to select FPGA peripheral
 int                 host_spi_xfer_bytes(size_t num, uint8_t * buffer);        // send and receive num bytes over SPI
+int                 host_spi_capture_open(const char * filename);             // capture SPI traffic to file
+void                host_spi_capture_close();                                 // stop SPI capture (and close file)
+void                host_spi_set_backend(e_host_spi_backend backend);         // select SPI backend before open
 
 #endif        // HOST_SPI_H
@@ -12,6 +12,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <unistd.h>
 
@@ -33,15 +34,664 @@ static void hexdump(size_t num, uint8_t * mem)
 static uint8_t to_send[65536] = {0};
 static uint8_t data[65536]    = {0};
 
+static uint64_t time_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+}
+
+// play back SPI capture file (from XOSERA_SPI_CAPTURE), at full speed or with original pacing
+static int replay_capture(const char * filename, bool paced)
+{
+    FILE * fp = fopen(filename, "rb");
+    if (fp == nullptr)
+    {
+        fprintf(stderr, "Can't open capture \"%s\" (%s).\n", filename, strerror(errno));
+        return -1;
+    }
+
+    host_spi_capture_header_t hdr;
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1 || memcmp(hdr.magic, HOST_SPI_CAPTURE_MAGIC, sizeof(hdr.magic)) != 0 ||
+        hdr.version != HOST_SPI_CAPTURE_VERSION)
+    {
+        fprintf(stderr, "\"%s\" is not a version %d SPI capture file.\n", filename, HOST_SPI_CAPTURE_VERSION);
+        fclose(fp);
+        return -1;
+    }
+
+    printf("Replaying \"%s\" %s...\n", filename, paced ? "with original pacing" : "at full speed");
+
+    size_t   num_cs       = 0;
+    size_t   num_xfers    = 0;
+    size_t   num_bytes    = 0;
+    size_t   num_mismatch = 0;
+    uint64_t capture_ns   = 0;
+    uint64_t replay_start = time_ns();
+    bool     truncated    = false;
+
+    host_spi_capture_record_t rec;
+    while (fread(&rec, sizeof(rec), 1, fp) == 1)
+    {
+        if (paced)
+        {
+            uint64_t now = time_ns() - replay_start;
+            if (rec.time_ns > now)
+            {
+                usleep(static_cast<useconds_t>((rec.time_ns - now) / 1000));
+            }
+        }
+        capture_ns = rec.time_ns;
+
+        if (rec.type == HOST_SPI_REC_CS)
+        {
+            host_spi_cs(rec.cs != 0);
+            num_cs++;
+        }
+        else if (rec.type == HOST_SPI_REC_XFER)
+        {
+            if (rec.num < 1 || rec.num > sizeof(to_send) || fread(to_send, 1, rec.num, fp) != rec.num ||
+                fread(data, 1, rec.num, fp) != rec.num)
+            {
+                truncated = true;
+                break;
+            }
+
+            host_spi_xfer_bytes(rec.num, to_send);
+
+            // compare reply with captured reply (to help spot glitches)
+            for (size_t i = 0; i < rec.num; i++)
+            {
+                if (to_send[i] != data[i])
+                {
+                    if (num_mismatch < 16)
+                    {
+                        printf("  reply mismatch xfer #%zu byte %zu: 0x%02x vs captured 0x%02x\n",
+                               num_xfers,
+                               i,
+                               to_send[i],
+                               data[i]);
+                    }
+                    num_mismatch++;
+                }
+            }
+
+            num_xfers++;
+            num_bytes += rec.num;
+        }
+        else
+        {
+            truncated = true;
+            break;
+        }
+    }
+
+    uint64_t replay_ns = time_ns() - replay_start;
+    fclose(fp);
+
+    if (truncated)
+    {
+        printf("*** Capture file truncated or corrupt after %zu transfers.\n", num_xfers);
+    }
+
+    double secs = replay_ns / 1000000000.0;
+    printf("Replayed %zu transfers, %zu CS changes, %zu bytes in %.3f sec (captured in %.3f sec)\n",
+           num_xfers,
+           num_cs,
+           num_bytes,
+           secs,
+           capture_ns / 1000000000.0);
+    printf("Throughput %.1f KB/sec, %zu reply bytes differed from capture.\n",
+           secs > 0.0 ? (num_bytes / 1024.0) / secs : 0.0,
+           num_mismatch);
+
+    return (truncated || num_mismatch) ? 1 : 0;
+}
+
+// SPI command bytes (see rtl/spi_bus.sv)
+enum
+{
+    SPI_CMD_CS      = 0x80,
+    SPI_CMD_WR      = 0x40,
+    SPI_CMD_RS      = 0x20,
+    SPI_CMD_BYTESEL = 0x10,
+    SPI_CMD_STREAM  = 0x40,        // stream write header: 0100RRRR, word count-1, then N even/odd byte pairs
+    SPI_CMD_REGMASK = 0x0F
+};
+
+// Xosera registers used by benchmark
+enum
+{
+    XM_RD_INCR = 0x2,
+    XM_RD_ADDR = 0x3,
+    XM_WR_INCR = 0x4,
+    XM_WR_ADDR = 0x5,
+    XM_DATA    = 0x6
+};
+
+#define BENCH_LATENCY_READS 500         // single word register reads for latency test
+#define BENCH_WORDS         8192        // VRAM words written/read per throughput test
+#define BENCH_MAX_BATCH     256         // largest batch (words per transfer)
+#define BENCH_MAX_RESULTS   32
+
+struct bench_result_t
+{
+    const char * test;          // test name
+    size_t       batch;         // words per SPI transfer (with CS selected)
+    size_t       words;         // total words transferred
+    size_t       bytes;         // total SPI bytes transferred
+    size_t       xfers;         // number of SPI transfers
+    uint64_t     total_ns;      // total time
+    uint64_t     min_ns;        // fastest transfer
+    uint64_t     max_ns;        // slowest transfer
+    size_t       errors;        // words read back incorrectly
+};
+
+static bench_result_t bench_results[BENCH_MAX_RESULTS];
+static size_t         bench_num_results;
+
+static size_t put_cmd(uint8_t * buf, uint8_t cmd, uint8_t data)
+{
+    buf[0] = cmd;
+    buf[1] = data;
+    return 2;
+}
+
+static size_t put_setw(uint8_t * buf, uint8_t r, uint16_t word)
+{
+    put_cmd(buf, SPI_CMD_CS | SPI_CMD_WR | (r & SPI_CMD_REGMASK), word >> 8);
+    put_cmd(buf + 2, SPI_CMD_CS | SPI_CMD_WR | SPI_CMD_BYTESEL | (r & SPI_CMD_REGMASK), word & 0xff);
+    return 4;
+}
+
+// word read reply will be in buf[1] (MSB) and buf[3] (LSB) after transfer
+static size_t put_getw(uint8_t * buf, uint8_t r)
+{
+    put_cmd(buf, SPI_CMD_CS | (r & SPI_CMD_REGMASK), 0xff);
+    put_cmd(buf + 2, SPI_CMD_CS | SPI_CMD_BYTESEL | (r & SPI_CMD_REGMASK), 0xff);
+    return 4;
+}
+
+static inline uint16_t reply_word(const uint8_t * buf)
+{
+    return static_cast<uint16_t>((buf[1] << 8) | buf[3]);
+}
+
+static inline uint16_t bench_pattern(size_t i)
+{
+    return static_cast<uint16_t>((i * 0x9E37) ^ 0x5A5A);
+}
+
+// select, transfer len bytes and de-select, returning elapsed time
+static uint64_t bench_xfer(size_t len, uint8_t * buf)
+{
+    uint64_t start = time_ns();
+    host_spi_cs(false);
+    host_spi_xfer_bytes(len, buf);
+    host_spi_cs(true);
+
+    return time_ns() - start;
+}
+
+static void bench_setw(uint8_t r, uint16_t word)
+{
+    bench_xfer(put_setw(to_send, r, word), to_send);
+}
+
+static bench_result_t * bench_begin(const char * test, size_t batch)
+{
+    if (bench_num_results >= BENCH_MAX_RESULTS)
+    {
+        return nullptr;
+    }
+    bench_result_t * res = &bench_results[bench_num_results++];
+    memset(res, 0, sizeof(*res));
+    res->test   = test;
+    res->batch  = batch;
+    res->min_ns = UINT64_MAX;
+
+    return res;
+}
+
+static void bench_add(bench_result_t * res, size_t words, size_t bytes, uint64_t ns)
+{
+    res->words += words;
+    res->bytes += bytes;
+    res->xfers++;
+    res->total_ns += ns;
+    if (ns < res->min_ns)
+    {
+        res->min_ns = ns;
+    }
+    if (ns > res->max_ns)
+    {
+        res->max_ns = ns;
+    }
+}
+
+// round-trip latency of single register word reads (select, 4 bytes, de-select)
+static void bench_read_latency()
+{
+    bench_result_t * res = bench_begin("reg_read_latency", 1);
+    if (res == nullptr)
+    {
+        return;
+    }
+
+    bench_setw(XM_RD_INCR, 0xB007);
+    for (size_t i = 0; i < BENCH_LATENCY_READS; i++)
+    {
+        size_t   len = put_getw(to_send, XM_RD_INCR);
+        uint64_t ns  = bench_xfer(len, to_send);
+        bench_add(res, 1, len, ns);
+        if (reply_word(to_send) != 0xB007)
+        {
+            res->errors++;
+        }
+    }
+}
+
+// read back BENCH_WORDS words written by bench_write() (untimed), counting errors
+static void bench_write_verify(bench_result_t * res, size_t batch)
+{
+    bench_setw(XM_RD_INCR, 0x0001);
+    bench_setw(XM_RD_ADDR, 0x0000);
+    for (size_t w = 0; w < BENCH_WORDS; w += batch)
+    {
+        size_t len = 0;
+        for (size_t i = 0; i < batch; i++)
+        {
+            len += put_getw(to_send + len, XM_DATA);
+        }
+        bench_xfer(len, to_send);
+        for (size_t i = 0; i < batch; i++)
+        {
+            if (reply_word(to_send + i * 4) != bench_pattern(w + i))
+            {
+                res->errors++;
+            }
+        }
+    }
+}
+
+// sustained VRAM write throughput with batch words per transfer (using bus commands or stream packets), then read back
+static void bench_write(size_t batch, bool stream)
+{
+    bench_result_t * res = bench_begin(stream ? "vram_write_stream" : "vram_write_cmd", batch);
+    if (res == nullptr)
+    {
+        return;
+    }
+
+    bench_setw(XM_WR_INCR, 0x0001);
+    bench_setw(XM_WR_ADDR, 0x0000);
+    for (size_t w = 0; w < BENCH_WORDS; w += batch)
+    {
+        size_t len = 0;
+        if (stream)
+        {
+            len += put_cmd(to_send, SPI_CMD_STREAM | XM_DATA, static_cast<uint8_t>(batch - 1));
+            for (size_t i = 0; i < batch; i++)
+            {
+                uint16_t word  = bench_pattern(w + i);
+                to_send[len++] = word >> 8;
+                to_send[len++] = word & 0xff;
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < batch; i++)
+            {
+                len += put_setw(to_send + len, XM_DATA, bench_pattern(w + i));
+            }
+        }
+        bench_add(res, batch, len, bench_xfer(len, to_send));
+    }
+
+    bench_write_verify(res, batch);
+}
+
+// sustained VRAM read throughput with batch words per transfer, or de-selecting after every command
+static void bench_read(size_t batch, bool cs_toggle)
+{
+    bench_result_t * res = bench_begin(cs_toggle ? "vram_read_cs_toggle" : "vram_read", batch);
+    if (res == nullptr)
+    {
+        return;
+    }
+
+    bench_setw(XM_RD_INCR, 0x0001);
+    bench_setw(XM_RD_ADDR, 0x0000);
+    for (size_t w = 0; w < BENCH_WORDS; w += batch)
+    {
+        if (cs_toggle)
+        {
+            // each two byte command in its own transfer
+            uint8_t  msb[2], lsb[2];
+            uint64_t ns = 0;
+            put_cmd(msb, SPI_CMD_CS | XM_DATA, 0xff);
+            put_cmd(lsb, SPI_CMD_CS | SPI_CMD_BYTESEL | XM_DATA, 0xff);
+            ns += bench_xfer(sizeof(msb), msb);
+            ns += bench_xfer(sizeof(lsb), lsb);
+            bench_add(res, 1, sizeof(msb) + sizeof(lsb), ns);
+            if (static_cast<uint16_t>((msb[1] << 8) | lsb[1]) != bench_pattern(w))
+            {
+                res->errors++;
+            }
+        }
+        else
+        {
+            size_t len = 0;
+            for (size_t i = 0; i < batch; i++)
+            {
+                len += put_getw(to_send + len, XM_DATA);
+            }
+            bench_add(res, batch, len, bench_xfer(len, to_send));
+            for (size_t i = 0; i < batch; i++)
+            {
+                if (reply_word(to_send + i * 4) != bench_pattern(w + i))
+                {
+                    res->errors++;
+                }
+            }
+        }
+    }
+}
+
+// derived rates for result
+struct bench_rates_t
+{
+    double kbs;        // KB/sec
+    double wps;        // words/sec
+    double avg;        // average us per transfer
+    double mn;         // fastest us per transfer
+    double mx;         // slowest us per transfer
+};
+
+static bench_rates_t bench_rates(const bench_result_t * res)
+{
+    bench_rates_t r;
+    double        secs = res->total_ns / 1000000000.0;
+    r.kbs              = secs > 0.0 ? (res->bytes / 1024.0) / secs : 0.0;
+    r.wps              = secs > 0.0 ? res->words / secs : 0.0;
+    r.avg              = res->xfers ? (res->total_ns / 1000.0) / res->xfers : 0.0;
+    r.mn               = res->xfers ? res->min_ns / 1000.0 : 0.0;
+    r.mx               = res->max_ns / 1000.0;
+
+    return r;
+}
+
+static void bench_print()
+{
+    printf("%-20s %5s %6s %7s %9s %9s %9s %9s %9s %6s\n",
+           "test",
+           "batch",
+           "words",
+           "bytes",
+           "KB/sec",
+           "words/sec",
+           "avg us",
+           "min us",
+           "max us",
+           "errors");
+
+    for (size_t n = 0; n < bench_num_results; n++)
+    {
+        const bench_result_t * res = &bench_results[n];
+        bench_rates_t          r   = bench_rates(res);
+
+        printf("%-20s %5zu %6zu %7zu %9.1f %9.0f %9.1f %9.1f %9.1f %6zu\n",
+               res->test,
+               res->batch,
+               res->words,
+               res->bytes,
+               r.kbs,
+               r.wps,
+               r.avg,
+               r.mn,
+               r.mx,
+               res->errors);
+    }
+}
+
+// CSV header and all result rows as one block
+static void bench_print_csv(FILE * csv)
+{
+    fprintf(csv, "test,batch,words,bytes,xfers,total_us,kb_per_sec,words_per_sec,avg_us,min_us,max_us,errors\n");
+
+    for (size_t n = 0; n < bench_num_results; n++)
+    {
+        const bench_result_t * res = &bench_results[n];
+        bench_rates_t          r   = bench_rates(res);
+
+        fprintf(csv,
+                "%s,%zu,%zu,%zu,%zu,%.1f,%.3f,%.1f,%.3f,%.3f,%.3f,%zu\n",
+                res->test,
+                res->batch,
+                res->words,
+                res->bytes,
+                res->xfers,
+                res->total_ns / 1000.0,
+                r.kbs,
+                r.wps,
+                r.avg,
+                r.mn,
+                r.mx,
+                res->errors);
+    }
+}
+
+// SPI protocol check: bus command and stream writes of data bytes that look like command bytes (e.g., 0x4X looks
+// like a stream write header), in one transfer, then read back
+static int run_check()
+{
+    static const uint16_t words[] = {0x4142, 0x4040, 0x4f4f, 0x8040, 0x40c6, 0x4601, 0x00ff, 0x2020};
+    const size_t          num     = sizeof(words) / sizeof(words[0]);
+    size_t                errors  = 0;
+
+    printf("Checking SPI bus command and stream writes of command-like data bytes...\n");
+
+    for (int stream = 0; stream < 2; stream++)
+    {
+        uint16_t vaddr = static_cast<uint16_t>(0x4140 + stream * num);
+        size_t   len   = 0;
+        len += put_setw(to_send + len, XM_WR_INCR, 0x0001);
+        len += put_setw(to_send + len, XM_WR_ADDR, vaddr);
+        if (stream)
+        {
+            len += put_cmd(to_send + len, SPI_CMD_STREAM | XM_DATA, static_cast<uint8_t>(num - 1));
+            for (size_t i = 0; i < num; i++)
+            {
+                to_send[len++] = words[i] >> 8;
+                to_send[len++] = words[i] & 0xff;
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < num; i++)
+            {
+                len += put_setw(to_send + len, XM_DATA, words[i]);
+            }
+        }
+        len += put_setw(to_send + len, XM_RD_INCR, 0x0001);
+        len += put_setw(to_send + len, XM_RD_ADDR, vaddr);
+        size_t reply = len;
+        for (size_t i = 0; i < num; i++)
+        {
+            len += put_getw(to_send + len, XM_DATA);
+        }
+        bench_xfer(len, to_send);
+
+        for (size_t i = 0; i < num; i++)
+        {
+            uint16_t word = reply_word(to_send + reply + i * 4);
+            if (word != words[i])
+            {
+                printf("  %s write word %zu: read 0x%04x, expected 0x%04x\n",
+                       stream ? "stream" : "command",
+                       i,
+                       word,
+                       words[i]);
+                errors++;
+            }
+        }
+    }
+
+    if (errors)
+    {
+        printf("*** %zu words read incorrectly (stream writes need SPI stream support in bitstream).\n", errors);
+    }
+    else
+    {
+        printf("All words read back correctly.\n");
+    }
+
+    return errors ? 1 : 0;
+}
+
+// SPI latency and throughput benchmark (times are per transfer, "batch" is words per transfer)
+static int run_benchmark(const char * csv_filename)
+{
+    FILE * csv = stdout;
+    if (csv_filename)
+    {
+        csv = fopen(csv_filename, "w");
+        if (csv == nullptr)
+        {
+            fprintf(stderr, "Can't create CSV file \"%s\" (%s).\n", csv_filename, strerror(errno));
+            return -1;
+        }
+    }
+
+    // largest batch that fits in one transfer (4 bytes per word for bus commands)
+    size_t max_batch = chunksize / 4;
+    if (max_batch > BENCH_MAX_BATCH)
+    {
+        max_batch = BENCH_MAX_BATCH;
+    }
+
+    printf("Running SPI benchmark (%d words per throughput test, max batch %zu words)...\n", BENCH_WORDS, max_batch);
+
+    bench_num_results = 0;
+    bench_read_latency();
+    for (size_t batch = 1; batch <= max_batch; batch *= 4)
+    {
+        bench_write(batch, false);
+    }
+    for (size_t batch = 1; batch <= max_batch; batch *= 4)
+    {
+        bench_write(batch, true);
+    }
+    for (size_t batch = 1; batch <= max_batch; batch *= 4)
+    {
+        bench_read(batch, false);
+    }
+    bench_read(1, true);
+
+    // table, then CSV (after a blank line on stdout, or to -c file)
+    bench_print();
+    if (csv == stdout)
+    {
+        printf("\n");
+    }
+    bench_print_csv(csv);
+    if (csv != stdout)
+    {
+        fclose(csv);
+        printf("CSV written to \"%s\".\n", csv_filename);
+    }
+
+    size_t errors = 0;
+    for (size_t n = 0; n < bench_num_results; n++)
+    {
+        errors += bench_results[n].errors;
+    }
+    if (errors)
+    {
+        printf("*** %zu words read incorrectly (vram_write_stream needs SPI stream support in bitstream).\n", errors);
+    }
+
+    return errors ? 1 : 0;
+}
+
 int main(int argc, char ** argv)
 {
+    const char * replay_file = nullptr;
+    const char * csv_file    = nullptr;
+    bool         paced       = false;
+    bool         benchmark   = false;
+    bool         check       = false;
+    int          argn        = 1;
+
+    while (argn < argc && argv[argn][0] == '-' && !isdigit(argv[argn][1]))
+    {
+        if (strcmp(argv[argn], "-p") == 0 && argn + 1 < argc)
+        {
+            replay_file = argv[++argn];
+        }
+        else if (strcmp(argv[argn], "-t") == 0)
+        {
+            paced = true;
+        }
+        else if (strcmp(argv[argn], "-b") == 0)
+        {
+            benchmark = true;
+        }
+        else if (strcmp(argv[argn], "-v") == 0)
+        {
+            check = true;
+        }
+        else if (strcmp(argv[argn], "-c") == 0 && argn + 1 < argc)
+        {
+            csv_file = argv[++argn];
+        }
+        else if (strcmp(argv[argn], "-m") == 0)
+        {
+            host_spi_set_backend(HOST_SPI_MOCK);
+        }
+        else
+        {
+            printf("Usage: host_spi [byte ...]                 - send bytes and show reply\n");
+            printf("       host_spi -p <capture file> [-t]      - replay SPI capture (-t original pacing)\n");
+            printf("       host_spi -b [-c <CSV file>]          - SPI latency/throughput benchmark\n");
+            printf("       host_spi -v                          - SPI protocol write/read back check\n");
+            printf("       -m                                   - use mock Xosera (no FTDI device needed)\n");
+            printf("Set %s=<file> to capture SPI traffic of any host program.\n", HOST_SPI_CAPTURE_ENV);
+            exit(EXIT_FAILURE);
+        }
+        argn++;
+    }
+
     if (host_spi_open() < 0)
     {
         exit(EXIT_FAILURE);
     }
+
+    if (replay_file)
+    {
+        int res = replay_capture(replay_file, paced);
+        host_spi_close();
+        exit(res == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    if (check)
+    {
+        int res = run_check();
+        host_spi_close();
+        exit(res == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    if (benchmark)
+    {
+        int res = run_benchmark(csv_file);
+        host_spi_close();
+        exit(res == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
     size_t len = 0;
 
-    for (int i = 1; i < argc && len < sizeof(to_send); i++)
+    for (int i = argn; i < argc && len < sizeof(to_send); i++)
     {
         char * endptr = nullptr;
         int    value  = static_cast<int>(strtoul(argv[i], &endptr, 0) & 0xffUL);
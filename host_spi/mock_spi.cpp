@@ -0,0 +1,403 @@
+// mock_spi.cpp - hardware-free mock Xosera SPI backend
+//
+// vim: set et ts=4 sw=4
+//
+// Copyright (c) 2020 Xark - https://hackaday.io/Xark
+//
+// See top-level LICENSE file for license information. (Hint: MIT)
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "mock_spi.h"
+
+// This models the SPI command protocol from rtl/spi_bus.sv (command byte then data byte, command byte reply 0xCB,
+// data byte reply is register byte before the command, plus stream write packets) and the main register behavior
+// from rtl/reg_interface.sv.  VRAM and XR memory accesses complete instantly (so SYS_CTRL mem_wait is never set) and
+// the blitter, copper and video are not modelled, except for a free running XR_SCANLINE and XM_TIMER.
+
+enum
+{
+    SPI_CMD_CS      = 0x80,
+    SPI_CMD_WR      = 0x40,
+    SPI_CMD_RS      = 0x20,
+    SPI_CMD_BYTESEL = 0x10,
+    SPI_CMD_STREAM  = 0x40,        // stream write header (cmd bits [7:4] = 0100)
+    SPI_CMD_REGMASK = 0x0F
+};
+
+enum
+{
+    XM_XR_ADDR   = 0x0,
+    XM_XR_DATA   = 0x1,
+    XM_RD_INCR   = 0x2,
+    XM_RD_ADDR   = 0x3,
+    XM_WR_INCR   = 0x4,
+    XM_WR_ADDR   = 0x5,
+    XM_DATA      = 0x6,
+    XM_DATA_2    = 0x7,
+    XM_SYS_CTRL  = 0x8,
+    XM_TIMER     = 0x9,
+    XM_UNUSED_A  = 0xA,
+    XM_UNUSED_B  = 0xB,
+    XM_RW_INCR   = 0xC,
+    XM_RW_ADDR   = 0xD,
+    XM_RW_DATA   = 0xE,
+    XM_RW_DATA_2 = 0xF
+};
+
+enum
+{
+    XR_SCANLINE  = 0x08,        // (RO) [15] in V blank, [14] in H blank [10:0] V scanline
+    XR_VID_HSIZE = 0x0D,        // (RO) native pixel width of monitor mode
+    XR_VID_VSIZE = 0x0E,        // (RO) native pixel height of monitor mode
+    XR_UNUSED_0F = 0x0F         // (RO) update frequency of monitor mode in BCD 1/100th Hz
+};
+
+// 640x480 @ 59.94 Hz mode timing (for XR_SCANLINE)
+#define MOCK_VID_H      640
+#define MOCK_VID_V      480
+#define MOCK_VID_VTOTAL 525
+#define MOCK_FRAME_NS   16683350ULL
+
+static uint16_t mock_vram[64 * 1024];        // 64K words of VRAM
+static uint16_t mock_xr[64 * 1024];          // XR registers and memory (sparse regions used)
+
+static struct
+{
+    uint16_t xr_addr;
+    uint16_t xr_data;
+    uint16_t rd_incr;
+    uint16_t rd_addr;
+    uint16_t rd_data;
+    uint16_t wr_incr;
+    uint16_t wr_addr;
+    uint16_t rw_incr;
+    uint16_t rw_addr;
+    uint16_t rw_data;
+    uint8_t  xr_data_even;
+    uint8_t  data_even;
+    uint8_t  intr_mask;
+    uint8_t  wrmask;
+    bool     rw_rd_inc;
+} regs;
+
+static bool    spi_selected;        // SPI CS asserted
+static bool    spi_payload;         // true if next byte is payload (data) byte
+static uint8_t spi_cmd;             // last command byte
+static bool    spi_stream_count;    // true if next byte is stream word count
+static int     spi_stream_bytes;    // stream data bytes remaining
+
+static uint64_t mock_time_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+}
+
+static void mock_reset_regs()
+{
+    memset(&regs, 0, sizeof(regs));
+    regs.wrmask = 0xf;
+}
+
+void mock_spi_reset()
+{
+    mock_reset_regs();
+    memset(mock_vram, 0, sizeof(mock_vram));
+    memset(mock_xr, 0, sizeof(mock_xr));
+    spi_selected = false;
+    spi_payload      = false;
+    spi_cmd          = 0;
+    spi_stream_count = false;
+    spi_stream_bytes = 0;
+}
+
+static uint16_t xr_read(uint16_t addr)
+{
+    switch (addr)
+    {
+        case XR_SCANLINE: {
+            uint32_t line = static_cast<uint32_t>((mock_time_ns() % MOCK_FRAME_NS) * MOCK_VID_VTOTAL / MOCK_FRAME_NS);
+            return static_cast<uint16_t>((line >= MOCK_VID_V ? 0x8000 : 0x0000) | line);
+        }
+        case XR_VID_HSIZE:
+            return MOCK_VID_H;
+        case XR_VID_VSIZE:
+            return MOCK_VID_V;
+        case XR_UNUSED_0F:
+            return 0x5994;
+        default:
+            return mock_xr[addr];
+    }
+}
+
+static void vram_write(uint16_t addr, uint16_t data)
+{
+    uint16_t mask = ((regs.wrmask & 0x8) ? 0xf000 : 0) | ((regs.wrmask & 0x4) ? 0x0f00 : 0) |
+                    ((regs.wrmask & 0x2) ? 0x00f0 : 0) | ((regs.wrmask & 0x1) ? 0x000f : 0);
+
+    mock_vram[addr] = (mock_vram[addr] & ~mask) | (data & mask);
+}
+
+// byte Xosera would put on the bus for a read of register r (even or odd byte)
+static uint8_t reg_read_byte(uint8_t r, bool odd)
+{
+    uint16_t v = 0;
+    switch (r)
+    {
+        case XM_XR_ADDR:
+            v = regs.xr_addr;
+            break;
+        case XM_XR_DATA:
+            v = regs.xr_data;
+            break;
+        case XM_RD_INCR:
+            v = regs.rd_incr;
+            break;
+        case XM_RD_ADDR:
+            v = regs.rd_addr;
+            break;
+        case XM_WR_INCR:
+            v = regs.wr_incr;
+            break;
+        case XM_WR_ADDR:
+            v = regs.wr_addr;
+            break;
+        case XM_DATA:
+        case XM_DATA_2:
+            v = regs.rd_data;
+            break;
+        case XM_SYS_CTRL:
+            v = static_cast<uint16_t>((regs.intr_mask << 8) | (regs.rw_rd_inc ? 0x10 : 0) | regs.wrmask);
+            break;
+        case XM_TIMER:
+            v = static_cast<uint16_t>(mock_time_ns() / 100000ULL);
+            break;
+        case XM_RW_INCR:
+            v = regs.rw_incr;
+            break;
+        case XM_RW_ADDR:
+            v = regs.rw_addr;
+            break;
+        case XM_RW_DATA:
+        case XM_RW_DATA_2:
+            v = regs.rw_data;
+            break;
+        default:
+            break;
+    }
+
+    return odd ? (v & 0xff) : (v >> 8);
+}
+
+// register byte written from bus (odd byte write triggers VRAM/XR action)
+static void reg_write_byte(uint8_t r, bool odd, uint8_t data)
+{
+    if (!odd)
+    {
+        switch (r)
+        {
+            case XM_XR_ADDR:
+                regs.xr_addr = static_cast<uint16_t>((data << 8) | (regs.xr_addr & 0xff));
+                break;
+            case XM_XR_DATA:
+                regs.xr_data_even = data;
+                break;
+            case XM_RD_INCR:
+                regs.rd_incr = static_cast<uint16_t>((data << 8) | (regs.rd_incr & 0xff));
+                break;
+            case XM_RD_ADDR:
+                regs.rd_addr = static_cast<uint16_t>((data << 8) | (regs.rd_addr & 0xff));
+                break;
+            case XM_WR_INCR:
+                regs.wr_incr = static_cast<uint16_t>((data << 8) | (regs.wr_incr & 0xff));
+                break;
+            case XM_WR_ADDR:
+                regs.wr_addr = static_cast<uint16_t>((data << 8) | (regs.wr_addr & 0xff));
+                break;
+            case XM_DATA:
+            case XM_DATA_2:
+            case XM_RW_DATA:
+            case XM_RW_DATA_2:
+                regs.data_even = data;
+                break;
+            case XM_SYS_CTRL:
+                if (data & 0x80)        // reconfigure (model as register reset)
+                {
+                    mock_reset_regs();
+                }
+                else
+                {
+                    regs.intr_mask = data & 0xf;
+                }
+                break;
+            case XM_RW_INCR:
+                regs.rw_incr = static_cast<uint16_t>((data << 8) | (regs.rw_incr & 0xff));
+                break;
+            case XM_RW_ADDR:
+                regs.rw_addr = static_cast<uint16_t>((data << 8) | (regs.rw_addr & 0xff));
+                break;
+            default:
+                break;
+        }
+        return;
+    }
+
+    switch (r)
+    {
+        case XM_XR_ADDR:
+            regs.xr_addr = static_cast<uint16_t>((regs.xr_addr & 0xff00) | data);
+            regs.xr_data = xr_read(regs.xr_addr);
+            break;
+        case XM_XR_DATA:
+            mock_xr[regs.xr_addr] = static_cast<uint16_t>((regs.xr_data_even << 8) | data);
+            regs.xr_addr++;
+            break;
+        case XM_RD_INCR:
+            regs.rd_incr = static_cast<uint16_t>((regs.rd_incr & 0xff00) | data);
+            break;
+        case XM_RD_ADDR:
+            regs.rd_addr = static_cast<uint16_t>((regs.rd_addr & 0xff00) | data);
+            regs.rd_data = mock_vram[regs.rd_addr];
+            regs.rd_addr += regs.rd_incr;
+            break;
+        case XM_WR_INCR:
+            regs.wr_incr = static_cast<uint16_t>((regs.wr_incr & 0xff00) | data);
+            break;
+        case XM_WR_ADDR:
+            regs.wr_addr = static_cast<uint16_t>((regs.wr_addr & 0xff00) | data);
+            break;
+        case XM_DATA:
+        case XM_DATA_2:
+            vram_write(regs.wr_addr, static_cast<uint16_t>((regs.data_even << 8) | data));
+            regs.wr_addr += regs.wr_incr;
+            break;
+        case XM_SYS_CTRL:
+            regs.rw_rd_inc = (data & 0x10) != 0;
+            regs.wrmask    = data & 0xf;
+            break;
+        case XM_RW_INCR:
+            regs.rw_incr = static_cast<uint16_t>((regs.rw_incr & 0xff00) | data);
+            break;
+        case XM_RW_ADDR:
+            regs.rw_addr = static_cast<uint16_t>((regs.rw_addr & 0xff00) | data);
+            regs.rw_data = mock_vram[regs.rw_addr];
+            if (regs.rw_rd_inc)
+            {
+                regs.rw_addr += regs.rw_incr;
+            }
+            break;
+        case XM_RW_DATA:
+        case XM_RW_DATA_2:
+            vram_write(regs.rw_addr, static_cast<uint16_t>((regs.data_even << 8) | data));
+            regs.rw_addr += regs.rw_incr;
+            break;
+        default:
+            break;
+    }
+}
+
+// register byte read from bus (odd byte read of data registers pre-reads next VRAM word)
+static void reg_read_strobe(uint8_t r, bool odd)
+{
+    if (!odd)
+    {
+        return;
+    }
+
+    if (r == XM_DATA || r == XM_DATA_2)
+    {
+        regs.rd_data = mock_vram[regs.rd_addr];
+        regs.rd_addr += regs.rd_incr;
+    }
+    else if (r == XM_RW_DATA || r == XM_RW_DATA_2)
+    {
+        regs.rw_data = mock_vram[regs.rw_addr];
+        if (regs.rw_rd_inc)
+        {
+            regs.rw_addr += regs.rw_incr;
+        }
+    }
+}
+
+void mock_spi_cs(bool cs)
+{
+    spi_selected = !cs;
+    if (!spi_selected)
+    {
+        spi_payload      = false;        // next byte will be command byte
+        spi_stream_count = false;
+        spi_stream_bytes = 0;
+    }
+}
+
+void mock_spi_xfer_bytes(size_t num, uint8_t * inout)
+{
+    for (size_t i = 0; i < num; i++)
+    {
+        uint8_t byte = inout[i];
+
+        if (!spi_selected)
+        {
+            inout[i] = 0xff;        // CIPO not driven when not selected
+            continue;
+        }
+
+        if (spi_stream_count)
+        {
+            inout[i]         = 0xcb;
+            spi_stream_bytes = (byte + 1) * 2;
+            spi_stream_count = false;
+            continue;
+        }
+
+        if (spi_stream_bytes)
+        {
+            inout[i] = 0xcb;
+            reg_write_byte(spi_cmd & SPI_CMD_REGMASK, (spi_stream_bytes & 1) != 0, byte);
+            spi_stream_bytes--;
+            continue;
+        }
+
+        if (!spi_payload)
+        {
+            inout[i] = 0xcb;
+            spi_cmd  = byte;
+
+            if ((byte & 0xf0) == SPI_CMD_STREAM)        // stream write header (only a command byte, never data)
+            {
+                spi_stream_count = true;
+                continue;
+            }
+            spi_payload = true;
+
+            if (spi_cmd & SPI_CMD_RS)
+            {
+                mock_reset_regs();
+            }
+            continue;
+        }
+
+        uint8_t r   = spi_cmd & SPI_CMD_REGMASK;
+        bool    odd = (spi_cmd & SPI_CMD_BYTESEL) != 0;
+
+        inout[i]    = reg_read_byte(r, odd);
+        spi_payload = false;
+
+        if (spi_cmd & SPI_CMD_CS)
+        {
+            if (spi_cmd & SPI_CMD_WR)
+            {
+                reg_write_byte(r, odd, byte);
+            }
+            else
+            {
+                reg_read_strobe(r, odd);
+            }
+        }
+    }
+}
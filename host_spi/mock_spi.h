@@ -0,0 +1,21 @@
+// mock_spi.h - header for hardware-free mock Xosera SPI backend
+//
+// vim: set et ts=4 sw=4
+//
+// Copyright (c) 2020 Xark - https://hackaday.io/Xark
+//
+// See top-level LICENSE file for license information. (Hint: MIT)
+#if !defined(MOCK_SPI_H)
+#define MOCK_SPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// In-process model of the Xosera SPI target and main registers, VRAM and XR memory.  Used by ftdi_spi.cpp when the
+// HOST_SPI_MOCK backend is selected (so host tools can run without an FTDI device or FPGA).
+
+void mock_spi_reset();                                    // reset registers and clear VRAM and XR memory
+void mock_spi_cs(bool cs);                                // cs = false to select mock Xosera
+void mock_spi_xfer_bytes(size_t num, uint8_t * inout);        // process num SPI bytes, replacing with reply bytes
+
+#endif        // MOCK_SPI_H
@@ -288,45 +288,21 @@ spi_target  spi_target(
             .reset_i(reset),
             .clk(pclk)
 );
-// SPI cmd byte (all active HIGH):
-//  7  6  5  4  3  2  1  0
-// CS WR RS BS R3 R2 R1 R0
-logic [7:0] spi_cmd_byte        = 8'h00;
-logic [7:0] spi_data_byte       = 8'h00;
-logic       spi_payload_byte    = 1'b0;   // true on 2nd byte (payload byte) of packet
-logic       spi_cs_hold0        = 1'b0;   // saved CS from spi_cmd_byte (held for two cycles)
-logic       spi_cs_hold1        = 1'b0;   // saved CS from spi_cmd_byte (held for two cycles)
-
-assign bus_cs_n             = ~spi_cs_hold0;                            // CS bit
-assign bus_rd_nwr           = ~spi_cmd_byte[6];                         // WR bit
-assign bus_bytesel          = spi_cmd_byte[4];                          // BS bit
-assign spi_reset            = spi_cmd_byte[5];                          // RS bit
-assign bus_reg_num          = spi_cmd_byte[3:0];                        // register bits
-assign bus_data_in          = spi_data_byte;                            // bus data to write
-assign spi_transmit_data    = spi_payload_byte ? bus_data_out_r : 8'hCB;  // bus data to read
-
-// DBUG assign { P2_1, P2_2, P2_3, P2_4, P2_7, P2_8, P2_9, P2_10 } = spi_cmd_byte;  // debug
-
-always_ff @(posedge pclk) begin
-    spi_cs_hold0        <= spi_cs_hold1;                 // clear held CS
-    spi_cs_hold1        <= 1'b0;                        // clear held CS
-    spi_cmd_byte[5]     <= 1'b0;                        // clear RS bit
-    if (!spi_select) begin                              // if SPI de-selected
-        spi_payload_byte    <= 1'b0;                    // next byte is command byte
-    end
-    if (spi_receive_strobe) begin                       // if an SPI byte received
-        if (!spi_payload_byte) begin                    // if not a payload byte (aka is a command byte)
-            spi_cmd_byte        <= spi_receive_data;    // save command byte
-            spi_payload_byte    <= 1'b1;
-        end
-        else begin                                      // else payload byte
-            spi_data_byte       <= spi_receive_data;    // put data byte on bus
-            spi_cs_hold0        <= spi_cmd_byte[7];     // hold CS for next cycle
-            spi_cs_hold1        <= spi_cmd_byte[7];     // hold CS for next cycle
-            spi_payload_byte    <= 1'b0;                // next byte is command byte
-        end
-    end
-end
+// SPI command bytes to Xosera bus signals (see spi_bus.sv for SPI command format)
+spi_bus spi_bus(
+            .spi_select_i(spi_select),
+            .spi_receive_strobe_i(spi_receive_strobe),
+            .spi_receive_byte_i(spi_receive_data),
+            .spi_transmit_byte_o(spi_transmit_data),
+            .bus_cs_n_o(bus_cs_n),
+            .bus_rd_nwr_o(bus_rd_nwr),
+            .bus_reg_num_o(bus_reg_num),
+            .bus_bytesel_o(bus_bytesel),
+            .bus_data_o(bus_data_in),
+            .bus_data_i(bus_data_out_r),
+            .spi_reset_o(spi_reset),
+            .clk(pclk)
+);
 
 `endif
 
@@ -116,6 +116,12 @@ VERILATOR_ARGS := --sv --language 1800-2012 -I$(SRCDIR) -Mdir sim/obj_dir -Wall
 # Verillator C++ source driver
 CSRC := sim/xosera_sim.cpp
 
+# Verilator SPI interface simulation top and C++ driver (tests SPI commands end-to-end)
+SPITOP := xosera_spi_top
+SPICSRC := sim/xosera_spi_sim.cpp
+SPI_VERILATOR_ARGS := --sv --language 1800-2012 -I$(SRCDIR) -Mdir sim/obj_dir_spi -Wall -Wno-DECLFILENAME -Wno-PINCONNECTEMPTY -Wno-STMTDLY
+SPI_CFLAGS := -CFLAGS "-std=c++14 -Wall -Wextra -Werror -Wno-sign-compare -Wno-unused-parameter"
+
 # default build native simulation executable
 all: vsim isim
 
@@ -133,6 +139,14 @@ vrun: sim/obj_dir/V$(VTOP) sim.mk
 	@mkdir -p $(LOGS)
 	sim/obj_dir/V$(VTOP) $(VRUN_TESTDATA)
 
+# build Verilator SPI interface simulation executable
+vspi: sim/obj_dir_spi/V$(SPITOP) sim.mk
+	@echo Completed building Verilator SPI interface simulation, use \"make vspirun\" to run.
+
+# build and run Verilator SPI interface simulation (exits with error if SPI test fails)
+vspirun: sim/obj_dir_spi/V$(SPITOP) sim.mk
+	sim/obj_dir_spi/V$(SPITOP)
+
 # run Verilator to build and run native simulation executable
 irun: sim/$(TBTOP) sim.mk
 	@mkdir -p $(LOGS)
@@ -143,6 +157,11 @@ sim/obj_dir/V$(VTOP): $(CSRC) $(INC) $(SRC) sim.mk
 	$(VERILATOR) $(VERILATOR_ARGS) --cc --exe --trace $(DEFINES) $(CFLAGS) $(LDFLAGS) --top-module $(VTOP) $(TECH_LIB) $(SRC) $(current_dir)/$(CSRC)
 	cd sim/obj_dir && make -f V$(VTOP).mk
 
+# use Verilator to build SPI interface simulation executable
+sim/obj_dir_spi/V$(SPITOP): $(SPICSRC) $(INC) $(SRC) sim/$(SPITOP).sv sim.mk
+	$(VERILATOR) $(SPI_VERILATOR_ARGS) --cc --exe $(DEFINES) $(SPI_CFLAGS) --top-module $(SPITOP) $(TECH_LIB) sim/$(SPITOP).sv $(SRC) $(current_dir)/$(SPICSRC)
+	cd sim/obj_dir_spi && make -f V$(SPITOP).mk
+
 # use Icarus Verilog to build vvp simulation executable
 sim/$(TBTOP): $(INC) sim/$(TBTOP).sv $(SRC) sim.mk
 	$(VERILATOR) $(VERILATOR_ARGS) --lint-only $(DEFINES)  -v $(TECH_LIB) --top-module $(TBTOP) sim/$(TBTOP).sv $(SRC)
@@ -150,10 +169,10 @@ sim/$(TBTOP): $(INC) sim/$(TBTOP).sv $(SRC) sim.mk
 
 # delete all targets that will be re-generated
 clean:
-	rm -rf sim/obj_dir sim/$(TBTOP)
+	rm -rf sim/obj_dir sim/obj_dir_spi sim/$(TBTOP)
 
 # prevent make from deleting any intermediate files
 .SECONDARY:
 
 # inform make about "phony" convenience targets
-.PHONY: all vsim isim vrun irun clean
+.PHONY: all vsim isim vrun irun vspi vspirun clean
@@ -0,0 +1,244 @@
+// C++ "driver" for Xosera SPI interface Verilator simulation
+//
+// vim: set et ts=4 sw=4
+//
+// Bit-bangs SPI commands into spi_target/spi_bus/xosera_main (see sim/xosera_spi_top.sv) and checks normal
+// two byte register commands and stream write commands end-to-end by reading back VRAM and XR memory.  Data bytes that
+// look like command bytes (0x4X looks like a stream header) are checked, and bus command writes are repeated near the
+// fastest SPI clock spi_target supports (so back-to-back bytes check the CS hold in spi_bus.sv).
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "verilated.h"
+
+#include "Vxosera_spi_top.h"
+
+#define SPI_HALF_CLOCKS      12        // pixel clocks per half SPI clock (~1 MHz SPI at 25 MHz)
+#define SPI_HALF_CLOCKS_FAST 3         // near fastest SPI clock for writes (spi_target needs clk ~4x SPI clock)
+#define SPI_HALF_CLOCKS_READ 6         // fastest SPI clock for reads (bus data must settle before reply is latched)
+#define STREAM_WORDS         256       // words per stream write packet (maximum)
+
+enum
+{
+    SPI_CMD_CS      = 0x80,
+    SPI_CMD_WR      = 0x40,
+    SPI_CMD_RS      = 0x20,
+    SPI_CMD_BYTESEL = 0x10,
+    SPI_CMD_STREAM  = 0x40,        // stream write (WR without CS) header, followed by count-1 and data bytes
+    SPI_CMD_REGMASK = 0x0F
+};
+
+enum
+{
+    XM_XR_ADDR = 0x0,
+    XM_XR_DATA = 0x1,
+    XM_RD_INCR = 0x2,
+    XM_RD_ADDR = 0x3,
+    XM_WR_INCR = 0x4,
+    XM_WR_ADDR = 0x5,
+    XM_DATA    = 0x6
+};
+
+#define XR_TILE_ADDR 0xA000
+
+vluint64_t main_time;
+
+static Vxosera_spi_top * top;
+static int               errors;
+static size_t            spi_bytes;
+static int               spi_half_clocks = SPI_HALF_CLOCKS;
+
+static void tick(int clocks)
+{
+    while (clocks--)
+    {
+        top->clk = 1;
+        top->eval();
+        main_time++;
+        top->clk = 0;
+        top->eval();
+        main_time++;
+    }
+}
+
+// SPI mode 0, MSB first (like FTDI MPSSE in host_spi)
+static uint8_t spi_byte(uint8_t out)
+{
+    uint8_t in = 0;
+    for (int b = 7; b >= 0; b--)
+    {
+        top->spi_sck_i  = 0;
+        top->spi_copi_i = (out >> b) & 1;
+        tick(spi_half_clocks);
+        in              = static_cast<uint8_t>((in << 1) | top->spi_cipo_o);
+        top->spi_sck_i  = 1;
+        tick(spi_half_clocks);
+    }
+    spi_bytes++;
+
+    return in;
+}
+
+static void spi_select(bool select)
+{
+    top->spi_sck_i  = 0;
+    top->spi_cs_n_i = select ? 0 : 1;
+    tick(SPI_HALF_CLOCKS * 2);
+}
+
+static void check(const char * what, uint16_t got, uint16_t expected)
+{
+    if (got != expected)
+    {
+        if (errors < 16)
+        {
+            printf("  *** %s: read 0x%04x, expected 0x%04x\n", what, got, expected);
+        }
+        errors++;
+    }
+}
+
+static void check_ack(uint8_t reply)
+{
+    check("SPI cmd ack", reply, 0xcb);
+}
+
+static void xm_setw(uint8_t r, uint16_t word)
+{
+    check_ack(spi_byte(SPI_CMD_CS | SPI_CMD_WR | r));
+    spi_byte(word >> 8);
+    check_ack(spi_byte(SPI_CMD_CS | SPI_CMD_WR | SPI_CMD_BYTESEL | r));
+    spi_byte(word & 0xff);
+}
+
+static uint16_t xm_getw(uint8_t r)
+{
+    check_ack(spi_byte(SPI_CMD_CS | r));
+    uint16_t msb = spi_byte(0xff);
+    check_ack(spi_byte(SPI_CMD_CS | SPI_CMD_BYTESEL | r));
+    uint16_t lsb = spi_byte(0xff);
+
+    return static_cast<uint16_t>((msb << 8) | lsb);
+}
+
+// write num words to register r with stream write packets
+static void xm_stream(uint8_t r, const uint16_t * words, int num)
+{
+    while (num > 0)
+    {
+        int count = num > STREAM_WORDS ? STREAM_WORDS : num;
+        check_ack(spi_byte(SPI_CMD_STREAM | r));
+        check_ack(spi_byte(static_cast<uint8_t>(count - 1)));
+        for (int i = 0; i < count; i++)
+        {
+            check_ack(spi_byte(words[i] >> 8));
+            check_ack(spi_byte(words[i] & 0xff));
+        }
+        words += count;
+        num -= count;
+    }
+}
+
+static void verify_vram(const char * what, uint16_t vaddr, const uint16_t * words, int num)
+{
+    xm_setw(XM_RD_INCR, 1);
+    xm_setw(XM_RD_ADDR, vaddr);
+    for (int i = 0; i < num; i++)
+    {
+        check(what, xm_getw(XM_DATA), words[i]);
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    Verilated::commandArgs(argc, argv);
+
+    top = new Vxosera_spi_top;
+
+    static const uint16_t cmd_like_words[] = {0x4142, 0x4040, 0x4f4f, 0x8040, 0x40c6, 0x4601, 0x00ff, 0x2020};
+    static uint16_t       test_words[1024];
+    for (int i = 0; i < 1024; i++)
+    {
+        test_words[i] = static_cast<uint16_t>((i * 0x9E37) ^ (i >> 3) ^ 0x5A00);
+    }
+
+    top->spi_cs_n_i = 1;
+    top->spi_sck_i  = 0;
+    top->reset_i    = 1;
+    tick(4);
+    top->reset_i = 0;
+    tick(1000);
+
+    printf("Xosera SPI interface simulation\n");
+
+    spi_select(true);
+
+    printf("Register write/read...\n");
+    xm_setw(XM_RD_INCR, 0xB007);
+    check("XM_RD_INCR", xm_getw(XM_RD_INCR), 0xB007);
+
+    printf("VRAM write with bus commands...\n");
+    size_t start = spi_bytes;
+    xm_setw(XM_WR_INCR, 1);
+    xm_setw(XM_WR_ADDR, 0x1000);
+    for (int i = 0; i < 64; i++)
+    {
+        xm_setw(XM_DATA, test_words[i]);
+    }
+    size_t cmd_bytes = spi_bytes - start;
+    verify_vram("VRAM bus cmd write", 0x1000, test_words, 64);
+
+    printf("VRAM write of command-like data bytes...\n");
+    xm_setw(XM_WR_INCR, 1);
+    xm_setw(XM_WR_ADDR, 0x4140);
+    for (int i = 0; i < 8; i++)
+    {
+        xm_setw(XM_DATA, cmd_like_words[i]);
+    }
+    verify_vram("VRAM bus cmd 0x4X write", 0x4140, cmd_like_words, 8);
+    xm_setw(XM_WR_ADDR, 0x4148);
+    xm_stream(XM_DATA, cmd_like_words, 8);
+    verify_vram("VRAM stream 0x4X write", 0x4148, cmd_like_words, 8);
+
+    printf("VRAM write with bus commands near fastest SPI clock...\n");
+    spi_half_clocks = SPI_HALF_CLOCKS_FAST;
+    xm_setw(XM_WR_ADDR, 0x3000);
+    for (int i = 0; i < 256; i++)
+    {
+        xm_setw(XM_DATA, test_words[i]);
+    }
+    spi_half_clocks = SPI_HALF_CLOCKS_READ;
+    verify_vram("VRAM fast bus cmd write", 0x3000, test_words, 256);
+    spi_half_clocks = SPI_HALF_CLOCKS;
+
+    printf("VRAM write with stream commands...\n");
+    start = spi_bytes;
+    xm_setw(XM_WR_INCR, 1);
+    xm_setw(XM_WR_ADDR, 0x2000);
+    xm_stream(XM_DATA, test_words, 1024);
+    size_t stream_bytes = spi_bytes - start;
+    verify_vram("VRAM stream write", 0x2000, test_words, 1024);
+
+    printf("XR tile memory write with stream command...\n");
+    xm_setw(XM_XR_ADDR, XR_TILE_ADDR);
+    xm_stream(XM_XR_DATA, test_words + 100, 64);
+    for (int i = 0; i < 64; i++)
+    {
+        xm_setw(XM_XR_ADDR, static_cast<uint16_t>(XR_TILE_ADDR + i));
+        check("XR stream write", xm_getw(XM_XR_DATA), test_words[100 + i]);
+    }
+
+    spi_select(false);
+
+    printf("SPI bytes per word: bus commands %.2f, stream commands %.2f\n",
+           cmd_bytes / 64.0,
+           stream_bytes / 1024.0);
+    printf("%s (%d errors)\n", errors ? "FAILED" : "PASSED", errors);
+
+    top->final();
+    delete top;
+
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+// xosera_spi_top.sv - Verilator top for SPI interface simulation
+//
+// vim: set et ts=4 sw=4
+//
+// Copyright (c) 2020 Xark - https://hackaday.io/Xark
+//
+// See top-level LICENSE file for license information. (Hint: MIT)
+//
+// Connects spi_target and spi_bus to xosera_main the same way as the iCEBreaker SPI_INTERFACE top, so
+// sim/xosera_spi_sim.cpp can test SPI commands end-to-end.
+
+`default_nettype none               // mandatory for Verilog sanity
+`timescale 1ns/1ps                  // mandatory to shut up Icarus Verilog
+
+`include "xosera_pkg.sv"
+
+module xosera_spi_top(
+    input  wire logic   spi_sck_i,          // SPI clock
+    input  wire logic   spi_copi_i,         // SPI data from initiator
+    output      logic   spi_cipo_o,         // SPI data to initiator
+    input  wire logic   spi_cs_n_i,         // SPI target select (active low)
+    input  wire logic   reset_i,            // reset signal
+    input  wire logic   clk                 // pixel clock
+);
+
+logic       bus_cs_n;
+logic       bus_rd_nwr;
+logic       bus_bytesel;
+logic [3:0] bus_reg_num;
+logic [7:0] bus_data_in;
+logic [7:0] bus_data_out;
+logic [7:0] bus_data_out_r;
+logic       spi_reset;
+logic       reset;
+
+logic       spi_select;
+logic       spi_receive_strobe;
+logic [7:0] spi_receive_data;
+logic [7:0] spi_transmit_data;
+
+/* verilator lint_off UNUSED */
+logic       spi_transmit_strobe;
+logic       bus_intr;
+logic [3:0] red, green, blue;
+logic       hsync, vsync, dv_de;
+logic       audio_l, audio_r;
+logic       reconfig;
+logic [1:0] boot_select;
+/* verilator lint_on UNUSED */
+
+always_ff @(posedge clk) begin
+    bus_data_out_r  <= bus_data_out;
+    reset           <= reset_i | spi_reset;
+end
+
+spi_target spi_target(
+    .spi_sck_i(spi_sck_i),
+    .spi_copi_i(spi_copi_i),
+    .spi_cipo_o(spi_cipo_o),
+    .spi_cs_i(spi_cs_n_i),
+    .select_o(spi_select),
+    .receive_strobe_o(spi_receive_strobe),
+    .receive_byte_o(spi_receive_data),
+    .transmit_strobe_o(spi_transmit_strobe),
+    .transmit_byte_i(spi_transmit_data),
+    .reset_i(reset),
+    .clk(clk)
+);
+
+spi_bus spi_bus(
+    .spi_select_i(spi_select),
+    .spi_receive_strobe_i(spi_receive_strobe),
+    .spi_receive_byte_i(spi_receive_data),
+    .spi_transmit_byte_o(spi_transmit_data),
+    .bus_cs_n_o(bus_cs_n),
+    .bus_rd_nwr_o(bus_rd_nwr),
+    .bus_reg_num_o(bus_reg_num),
+    .bus_bytesel_o(bus_bytesel),
+    .bus_data_o(bus_data_in),
+    .bus_data_i(bus_data_out_r),
+    .spi_reset_o(spi_reset),
+    .clk(clk)
+);
+
+xosera_main xosera_main(
+    .bus_cs_n_i(bus_cs_n),
+    .bus_rd_nwr_i(bus_rd_nwr),
+    .bus_reg_num_i(bus_reg_num),
+    .bus_bytesel_i(bus_bytesel),
+    .bus_data_i(bus_data_in),
+    .bus_data_o(bus_data_out),
+    .bus_intr_o(bus_intr),
+    .red_o(red),
+    .green_o(green),
+    .blue_o(blue),
+    .hsync_o(hsync),
+    .vsync_o(vsync),
+    .dv_de_o(dv_de),
+    .audio_l_o(audio_l),
+    .audio_r_o(audio_r),
+    .reconfig_o(reconfig),
+    .boot_select_o(boot_select),
+    .reset_i(reset),
+    .clk(clk)
+);
+
+endmodule
+`default_nettype wire               // restore default
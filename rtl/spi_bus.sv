@@ -0,0 +1,106 @@
+// spi_bus.sv
+//
+// vim: set et ts=4 sw=4
+//
+// Copyright (c) 2020 Xark - https://hackaday.io/Xark
+//
+// See top-level LICENSE file for license information. (Hint: MIT)
+//
+
+`default_nettype none               // mandatory for Verilog sanity
+`timescale 1ns/1ps                  // mandatory to shut up Icarus Verilog
+
+`include "xosera_pkg.sv"
+
+// Operate Xosera bus interface via SPI command bytes received by spi_target
+//
+// SPI "bus command" packet (two bytes):
+//
+// SPI cmd byte (all active HIGH):
+//  7  6  5  4  3  2  1  0
+// CS WR RS BS R3 R2 R1 R0
+// followed by data byte (written to register byte, or ignored for read)
+// Reply is 0xCB for cmd byte and register byte (before any write) for data byte.
+//
+// SPI "stream write" packet (2 + 2*N bytes):
+//
+// SPI cmd byte:
+//  7  6  5  4  3  2  1  0
+//  0  1  0  0 R3 R2 R1 R0
+// followed by word count byte (N-1, for 1 to 256 words), then N pairs of even and odd data bytes, each written to
+// register R (e.g., XM_DATA or XM_XR_DATA to write N words).  Reply is 0xCB for all stream packet bytes.
+
+module spi_bus(
+    input  wire logic           spi_select_i,           // SPI target selected
+    input  wire logic           spi_receive_strobe_i,   // SPI byte received
+    input  wire logic  [7:0]    spi_receive_byte_i,     // SPI byte from initiator
+    output      logic  [7:0]    spi_transmit_byte_o,    // SPI byte to initiator
+    output      logic           bus_cs_n_o,             // register select strobe (active low)
+    output      logic           bus_rd_nwr_o,           // 0 = write, 1 = read
+    output      logic  [3:0]    bus_reg_num_o,          // register number
+    output      logic           bus_bytesel_o,          // 0 = even byte, 1 = odd byte
+    output      logic  [7:0]    bus_data_o,             // 8-bit data bus output (to Xosera)
+    input  wire logic  [7:0]    bus_data_i,             // 8-bit data bus input (registered, from Xosera)
+    output      logic           spi_reset_o,            // SPI "soft" reset
+    input  wire logic           clk                     // input clk (should be ~4x faster than SPI clock)
+);
+
+logic [7:0] spi_cmd_byte        = 8'h00;
+logic [7:0] spi_data_byte       = 8'h00;
+logic       spi_payload_byte    = 1'b0;     // true on 2nd byte (payload byte) of packet
+logic [3:0] spi_cs_hold         = 4'h0;     // saved CS from spi_cmd_byte (held for four cycles)
+logic       spi_stream_count    = 1'b0;     // true on 2nd byte (word count byte) of stream packet
+logic       spi_stream          = 1'b0;     // true while receiving stream data bytes
+logic [8:0] spi_stream_bytes    = 9'h000;   // stream data bytes remaining minus one
+
+assign bus_cs_n_o           = ~spi_cs_hold[0];                          // CS bit
+assign bus_rd_nwr_o         = ~spi_cmd_byte[6];                         // WR bit
+assign bus_bytesel_o        = spi_cmd_byte[4];                          // BS bit
+assign spi_reset_o          = spi_cmd_byte[5];                          // RS bit
+assign bus_reg_num_o        = spi_cmd_byte[3:0];                        // register bits
+assign bus_data_o           = spi_data_byte;                            // bus data to write
+assign spi_transmit_byte_o  = spi_payload_byte ? bus_data_i : 8'hCB;    // bus data to read
+
+always_ff @(posedge clk) begin
+    spi_cs_hold         <= { 1'b0, spi_cs_hold[3:1] };  // shift out held CS
+    spi_cmd_byte[5]     <= 1'b0;                        // clear RS bit
+    if (!spi_select_i) begin                            // if SPI de-selected
+        spi_payload_byte    <= 1'b0;                    // next byte is command byte
+        spi_stream_count    <= 1'b0;
+        spi_stream          <= 1'b0;
+    end
+    if (spi_receive_strobe_i) begin                     // if an SPI byte received
+        if (spi_stream_count) begin                     // if stream word count byte
+            spi_stream_bytes    <= { spi_receive_byte_i, 1'b1 };    // (N-1)*2+1 = bytes minus one
+            spi_stream_count    <= 1'b0;
+            spi_stream          <= 1'b1;
+        end
+        else if (spi_stream) begin                      // else if stream data byte
+            spi_cmd_byte[4]     <= ~spi_stream_bytes[0];    // even then odd byte
+            spi_data_byte       <= spi_receive_byte_i;  // put data byte on bus
+            spi_cs_hold         <= 4'b1111;             // hold CS for write
+            spi_stream_bytes    <= spi_stream_bytes - 1'b1;
+            if (spi_stream_bytes == 9'h000) begin
+                spi_stream          <= 1'b0;            // next byte is command byte
+            end
+        end
+        else if (!spi_payload_byte) begin               // if not a payload byte (aka is a command byte)
+            if (spi_receive_byte_i[7:4] == 4'b0100) begin   // if stream write command
+                spi_cmd_byte        <= { 4'b1100, spi_receive_byte_i[3:0] };    // CS WR to register
+                spi_stream_count    <= 1'b1;            // next byte is word count
+            end
+            else begin
+                spi_cmd_byte        <= spi_receive_byte_i;  // save command byte
+                spi_payload_byte    <= 1'b1;
+            end
+        end
+        else begin                                      // else payload byte
+            spi_data_byte       <= spi_receive_byte_i;  // put data byte on bus
+            spi_cs_hold         <= {4{spi_cmd_byte[7]}};    // hold CS for next cycles
+            spi_payload_byte    <= 1'b0;                // next byte is command byte
+        end
+    end
+end
+
+endmodule
+`default_nettype wire               // restore default
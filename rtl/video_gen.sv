@@ -532,6 +532,11 @@ always_ff @(posedge clk) begin
         if (end_of_visible) begin
             intr_signal_o[3]  <= 1'b1;
         end
+        // audio 0 reload interrupt generation (channel latched START/LENGTH, so next can be set)
+        // NOTE: mixer also reloads every word while audio disabled, so only signal when enabled
+        if (audio_0_reload && audio_enable) begin
+            intr_signal_o[0]  <= 1'b1;
+        end
     end
 end
 
@@ -646,9 +651,10 @@ generate
         assign  audio_pdm_r_o   = 1'b0;
         assign  audio_0_fetch   = 1'b0;
         assign  audio_0_addr    = '0;
+        assign  audio_0_reload  = 1'b0;
 
         logic   audio_unused;
-        assign  audio_unused = &{1'b0, audio_enable, audio_0_vol, audio_0_period, audio_0_start, audio_0_len, audio_0_word };
+        assign  audio_unused = &{1'b0, audio_enable, audio_0_vol, audio_0_period, audio_0_start, audio_0_restart, audio_0_len, audio_0_word };
     end
 endgenerate
 
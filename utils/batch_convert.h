@@ -0,0 +1,191 @@
+// batch_convert.h - multi-threaded batch conversion for image utilities
+// Xark - 2021
+// See top-level LICENSE file for license information. (Hint: MIT)
+//
+// Converts a list of images (from a manifest file or a glob pattern) on a pool of worker threads, without any SDL
+// window, then prints a summary.  Each utility supplies a convert function that must only use read-only globals
+// (options) and report errors via the error string (not stdout).
+//
+// Manifest file format is one "<input file> [output file]" per line (blank lines and lines starting with '#' are
+// ignored).  When no output file is given, it is the input file name with extension replaced by out_ext (in out_dir
+// when set).
+#if !defined(BATCH_CONVERT_H)
+#define BATCH_CONVERT_H
+
+#include <glob.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct batch_item_t
+{
+    std::string in_file;         // input image
+    std::string out_file;        // output file (or basename for utilities writing several files)
+    std::string error;           // error message if conversion failed
+    bool        ok;              // true if converted successfully
+    double      secs;            // conversion time
+};
+
+typedef bool (*batch_convert_fn)(const char * in_file, const char * out_file, std::string * error);
+
+static inline double batch_time_secs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1000000000.0;
+}
+
+// output name for in_file, with extension replaced by out_ext and in out_dir (if not nullptr)
+static inline std::string batch_out_name(const std::string & in_file, const char * out_dir, const char * out_ext)
+{
+    std::string name  = in_file;
+    size_t      slash = name.find_last_of('/');
+    size_t      dot   = name.find_last_of('.');
+    if (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+    {
+        name.erase(dot);
+    }
+    if (out_dir && out_dir[0])
+    {
+        if (slash != std::string::npos)
+        {
+            name.erase(0, slash + 1);
+        }
+        name = std::string(out_dir) + "/" + name;
+    }
+
+    return name + out_ext;
+}
+
+static inline void batch_add(std::vector<batch_item_t> * items, const std::string & in_file, const std::string & out_file)
+{
+    batch_item_t item = {};
+    item.in_file      = in_file;
+    item.out_file     = out_file;
+    items->push_back(item);
+}
+
+// add images matching glob pattern, or listed in manifest file, returns false on error
+static inline bool batch_add_items(std::vector<batch_item_t> * items,
+                                   const char *                spec,
+                                   const char *                out_dir,
+                                   const char *                out_ext)
+{
+    if (strpbrk(spec, "*?[") != nullptr)
+    {
+        glob_t g = {};
+        int    rc = glob(spec, 0, nullptr, &g);
+        if (rc != 0 && rc != GLOB_NOMATCH)
+        {
+            printf("*** Error expanding \"%s\"\n", spec);
+            return false;
+        }
+        for (size_t i = 0; i < g.gl_pathc; i++)
+        {
+            batch_add(items, g.gl_pathv[i], batch_out_name(g.gl_pathv[i], out_dir, out_ext));
+        }
+        globfree(&g);
+
+        return true;
+    }
+
+    FILE * fp = fopen(spec, "r");
+    if (fp == nullptr)
+    {
+        printf("*** Unable to open manifest \"%s\" ", spec);
+        perror("error");
+        return false;
+    }
+
+    char line[4096];
+    while (fgets(line, sizeof(line), fp) != nullptr)
+    {
+        char in_name[4096]  = {};
+        char out_name[4096] = {};
+        int  n              = sscanf(line, "%4095s %4095s", in_name, out_name);
+        if (n < 1 || in_name[0] == '#')
+        {
+            continue;
+        }
+        batch_add(items, in_name, n > 1 ? std::string(out_name) : batch_out_name(in_name, out_dir, out_ext));
+    }
+    fclose(fp);
+
+    return true;
+}
+
+// convert all items with num_threads workers (0 for one per CPU), print summary and return number of failures
+static inline int batch_convert(std::vector<batch_item_t> * items, batch_convert_fn convert, int num_threads)
+{
+    if (num_threads <= 0)
+    {
+        num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    if (num_threads <= 0)
+    {
+        num_threads = 1;
+    }
+    if (num_threads > static_cast<int>(items->size()))
+    {
+        num_threads = items->size() ? static_cast<int>(items->size()) : 1;
+    }
+
+    printf("Batch converting %zu images with %d threads...\n", items->size(), num_threads);
+
+    std::atomic<size_t> next(0);
+    auto                worker = [&]() {
+        size_t i;
+        while ((i = next++) < items->size())
+        {
+            batch_item_t & item  = (*items)[i];
+            double         start = batch_time_secs();
+            item.ok              = convert(item.in_file.c_str(), item.out_file.c_str(), &item.error);
+            item.secs            = batch_time_secs() - start;
+        }
+    };
+
+    double                   start = batch_time_secs();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++)
+    {
+        threads.emplace_back(worker);
+    }
+    for (auto & t : threads)
+    {
+        t.join();
+    }
+    double elapsed = batch_time_secs() - start;
+
+    int    failed = 0;
+    double total  = 0.0;
+    for (const auto & item : *items)
+    {
+        total += item.secs;
+        if (item.ok)
+        {
+            printf("  OK   %6.3fs \"%s\" -> \"%s\"\n", item.secs, item.in_file.c_str(), item.out_file.c_str());
+        }
+        else
+        {
+            printf("  FAIL %6.3fs \"%s\": %s\n", item.secs, item.in_file.c_str(), item.error.c_str());
+            failed++;
+        }
+    }
+
+    printf("Converted %zu of %zu images in %.3fs (%.3fs total conversion time), %d failed.\n",
+           items->size() - failed,
+           items->size(),
+           elapsed,
+           total,
+           failed);
+
+    return failed;
+}
+
+#endif        // BATCH_CONVERT_H
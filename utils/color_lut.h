@@ -0,0 +1,57 @@
+// color_lut.h - nearest palette color lookup table for 12-bit Xosera colors
+// Xark - 2021
+// See top-level LICENSE file for license information. (Hint: MIT)
+//
+// Xosera colors are 12-bit 0xRGB, so nearest palette color for every possible color can be found once per palette
+// (4096 entries), after which matching a pixel is a single table lookup.  Works for palettes up to 256 colors.
+#if !defined(COLOR_LUT_H)
+#define COLOR_LUT_H
+
+#include <stdint.h>
+
+#define COLOR_LUT_SIZE 4096        // one entry per 12-bit 0xRGB color
+
+struct color_lut_t
+{
+    uint8_t index[COLOR_LUT_SIZE];        // palette index of nearest color for each 0xRGB
+};
+
+static inline int color_lut_dist(uint16_t color, int r, int g, int b)
+{
+    int dr = ((color & 0xf00) >> 8) - r;
+    int dg = ((color & 0x0f0) >> 4) - g;
+    int db = ((color & 0x00f) >> 0) - b;
+
+    return dr * dr + dg * dg + db * db;
+}
+
+// build table for palette of num_colors (1 to 256) 0xRGB entries (first entry wins on equal distance)
+static inline void color_lut_build(color_lut_t * lut, const uint16_t * palette, int num_colors)
+{
+    for (int rgb = 0; rgb < COLOR_LUT_SIZE; rgb++)
+    {
+        int r         = (rgb >> 8) & 0xf;
+        int g         = (rgb >> 4) & 0xf;
+        int b         = (rgb >> 0) & 0xf;
+        int best      = 0;
+        int best_dist = 99999;
+        for (int c = 0; c < num_colors; c++)
+        {
+            int dist = color_lut_dist(palette[c], r, g, b);
+            if (dist < best_dist)
+            {
+                best      = c;
+                best_dist = dist;
+            }
+        }
+        lut->index[rgb] = static_cast<uint8_t>(best);
+    }
+}
+
+// nearest palette index for 4-bit r, g, b
+static inline uint8_t color_lut_match(const color_lut_t * lut, int r, int g, int b)
+{
+    return lut->index[((r & 0xf) << 8) | ((g & 0xf) << 4) | (b & 0xf)];
+}
+
+#endif        // COLOR_LUT_H
@@ -0,0 +1,31 @@
+// dither.h - ordered dither matrix and reproducible noise for image utilities
+// Xark - 2021
+// See top-level LICENSE file for license information. (Hint: MIT)
+#if !defined(DITHER_H)
+#define DITHER_H
+
+#include <stdint.h>
+
+// 8x8 Bayer ordered dither matrix (0-63)
+static const uint8_t bayer8[8][8] = {{0, 32, 8, 40, 2, 34, 10, 42},
+                                     {48, 16, 56, 24, 50, 18, 58, 26},
+                                     {12, 44, 4, 36, 14, 46, 6, 38},
+                                     {60, 28, 52, 20, 62, 30, 54, 22},
+                                     {3, 35, 11, 43, 1, 33, 9, 41},
+                                     {51, 19, 59, 27, 49, 17, 57, 25},
+                                     {15, 47, 7, 39, 13, 45, 5, 37},
+                                     {63, 31, 55, 23, 61, 29, 53, 21}};
+
+// xorshift32 noise generator (same output for same seed on any platform, unlike rand())
+static inline uint32_t noise_next(uint32_t * state)
+{
+    uint32_t x = *state ? *state : 0x2545F491;        // (zero state would get stuck)
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return x;
+}
+
+#endif        // DITHER_H
@@ -8,6 +8,9 @@
 
 #include <algorithm>
 
+#include "color_lut.h"
+#include "image_rgba.h"
+
 bool   word_mode = false;
 bool   c_mode    = false;
 bool   invert    = false;
@@ -37,7 +40,7 @@ uint16_t palette[16] = {0x0000,
                         0x0FF5,
                         0x0FFF};
 
-Uint32 getpixel(SDL_Surface * surface, int x, int y);
+color_lut_t palette_lut;        // nearest palette color for each 12-bit color
 
 void matchmonocolors(uint8_t *& ptr, const SDL_Color rgb[8]);
 void matchcolors(uint8_t *& ptr, const SDL_Color * rgb);
@@ -118,6 +121,8 @@ int main(int argc, char ** argv)
 
     bool quit = false;
 
+    color_lut_build(&palette_lut, palette, sizeof(palette) / sizeof(palette[0]));
+
     SDL_Init(SDL_INIT_VIDEO);
     IMG_Init(IMG_INIT_PNG);
 
@@ -139,6 +144,7 @@ int main(int argc, char ** argv)
     }
 
     SDL_Surface * image = IMG_Load(in_file);
+    image_rgba_t  rgba  = {};
 
     int w = 0;
     int h = 0;
@@ -148,6 +154,11 @@ int main(int argc, char ** argv)
         printf("*** Unable to load \"%s\"\n", in_file);
         quit = true;
     }
+    else if (!image_rgba_init(&rgba, image))
+    {
+        printf("*** Unable to convert \"%s\" to RGBA8888: %s\n", in_file, SDL_GetError());
+        quit = true;
+    }
     else
     {
         w = image->w;
@@ -196,11 +207,10 @@ int main(int argc, char ** argv)
     int c = 0;
     for (int y = 0; y < h; y += 15)
     {
+        const rgba_t * row = image_rgba_row(&rgba, y);
         for (int x = 0; x < w; x += 20)
         {
-            SDL_Color rgb;
-            Uint32    data = getpixel(image, x, y);
-            SDL_GetRGB(data, image->format, &rgb.r, &rgb.g, &rgb.b);
+            const rgba_t & rgb = row[x];
 #if 0
             printf("0%x%x%x    // %3d (0x%02x)\n", (rgb.r & 0xf0) >> 4, (rgb.g & 0xf0) >> 4, (rgb.b & 0xf0) >> 4, c, c);
             c++;
@@ -236,29 +246,36 @@ int main(int argc, char ** argv)
         {
             printf("Writing output: \"%s\" %d x %d...\n", out_file, out_width, out_height);
 
+            uint8_t * row_bits = static_cast<uint8_t *>(malloc(w > 0 ? w : 1));
+            if (!row_bits)
+            {
+                printf("OOM!\n");
+                fclose(fp);
+                break;
+            }
+
             for (int y = 0; y < out_height; y++)
             {
+                const rgba_t * row = y < h ? image_rgba_row(&rgba, y) : nullptr;
+                if (row)
+                {
+                    image_rgba_threshold_row(row, row_bits, w, invert);
+                }
+
                 for (int x = 0; x < out_width; x += 8)
                 {
                     uint16_t  val            = 0;
                     SDL_Color byte_pixels[8] = {};
-                    if (y < h && x < w)
+                    if (row && x < w)
                     {
                         for (int b = 0; b < 8; b++)
                         {
-                            SDL_Color rgb;
-                            Uint32    data = getpixel(image, x + b, y);
-                            SDL_GetRGB(data, image->format, &rgb.r, &rgb.g, &rgb.b);
-                            byte_pixels[b] = rgb;
-                            int v          = (rgb.r + rgb.g + rgb.b) / 3;
-
-                            bool pixel = (v >= 128);
-                            if (invert)
-                            {
-                                pixel = !pixel;
-                            }
+                            byte_pixels[b].r = row[x + b].r;
+                            byte_pixels[b].g = row[x + b].g;
+                            byte_pixels[b].b = row[x + b].b;
+                            byte_pixels[b].a = row[x + b].a;
 
-                            if (pixel)
+                            if (row_bits[x + b])
                             {
                                 val |= (0x80 >> b);
                             }
@@ -282,6 +299,8 @@ int main(int argc, char ** argv)
                 }
             }
 
+            free(row_bits);
+
             bool good = (fwrite(out_pixels, out_size, 1, fp) == 1);
 
             fclose(fp);
@@ -296,6 +315,7 @@ int main(int argc, char ** argv)
         break;
     }
 #endif
+    image_rgba_free(&rgba);
     if (image)
     {
         SDL_FreeSurface(image);
@@ -308,38 +328,6 @@ int main(int argc, char ** argv)
     return 0;
 }
 
-Uint32 getpixel(SDL_Surface * surface, int x, int y)
-{
-    int bpp = surface->format->BytesPerPixel;
-    /* Here p is the address to the pixel we want to retrieve */
-    Uint8 * p = (Uint8 *)surface->pixels + y * surface->pitch + x * bpp;
-
-    switch (bpp)
-    {
-        case 1:
-            return *p;
-            break;
-
-        case 2:
-            return *(Uint16 *)p;
-            break;
-
-        case 3:
-            if (SDL_BYTEORDER == SDL_BIG_ENDIAN)
-                return p[0] << 16 | p[1] << 8 | p[2];
-            else
-                return p[0] | p[1] << 8 | p[2] << 16;
-            break;
-
-        case 4:
-            return *(Uint32 *)p;
-            break;
-
-        default:
-            return 0; /* shouldn't happen, but avoids warnings */
-    }
-}
-
 void matchmonocolors(uint8_t *& ptr, const SDL_Color rgb[8])
 {
     SDL_Color qrgb[8]  = {};
@@ -367,21 +355,8 @@ void matchmonocolors(uint8_t *& ptr, const SDL_Color rgb[8])
 
     for (int b = 0; b < 8; b++)
     {
-        int best      = -1;
-        int best_dist = 99999;
-        for (int c = 0; c < 16; c++)
-        {
-            int dist = (((palette[c] & 0xf00) >> 8) - qrgb[b].r) * (((palette[c] & 0xf00) >> 8) - qrgb[b].r) +
-                       (((palette[c] & 0x0f0) >> 4) - qrgb[b].g) * (((palette[c] & 0x0f0) >> 4) - qrgb[b].g) +
-                       (((palette[c] & 0x00f) >> 0) - qrgb[b].b) * (((palette[c] & 0x00f) >> 0) - qrgb[b].b);
-
-            if (dist < best_dist)
-            {
-                best      = c;
-                best_dist = dist;
-            }
-        }
-        irgb[b] = best;
+        int best = color_lut_match(&palette_lut, qrgb[b].r, qrgb[b].g, qrgb[b].b);
+        irgb[b]  = best;
         icnt[best] += 1;
     }
 
@@ -448,21 +423,7 @@ void matchcolors(uint8_t *& ptr, const SDL_Color * rgb)
 
     for (int b = 0; b < 4; b++)
     {
-        int best      = -1;
-        int best_dist = 99999;
-        for (int c = 0; c < 16; c++)
-        {
-            int dist = (((palette[c] & 0xf00) >> 8) - qrgb[b].r) * (((palette[c] & 0xf00) >> 8) - qrgb[b].r) +
-                       (((palette[c] & 0x0f0) >> 4) - qrgb[b].g) * (((palette[c] & 0x0f0) >> 4) - qrgb[b].g) +
-                       (((palette[c] & 0x00f) >> 0) - qrgb[b].b) * (((palette[c] & 0x00f) >> 0) - qrgb[b].b);
-
-            if (dist < best_dist)
-            {
-                best      = c;
-                best_dist = dist;
-            }
-        }
-        irgb[b] = best;
+        irgb[b] = color_lut_match(&palette_lut, qrgb[b].r, qrgb[b].g, qrgb[b].b);
     }
 
     *ptr++ = ((irgb[0] & 0xf) << 4) | irgb[1];
@@ -0,0 +1,682 @@
+// Quick & Dirty PNG to Xosera 4-bpp or 8-bpp bitmap with optimized 12-bit palette
+// Xark - 2021
+// See top-level LICENSE file for license information. (Hint: MIT)
+//
+// Builds a 16 or 256 color 12-bit palette for each image (median cut, optionally refined with k-means), then maps
+// pixels to it with Floyd-Steinberg or ordered (Bayer) dithering.  Writes "<basename>.raw" (4-bpp packed with even
+// pixel in high nibble, or 8-bpp) and "<basename>_pal.raw" (big-endian 0xRGB words) like the other loaders expect.
+// With -z the bitmap is written word RLE compressed as "<basename>.xrle" instead (see xosera_rle.h).
+#include <SDL.h>
+#include <SDL_image.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "batch_convert.h"
+#include "color_lut.h"
+#include "dither.h"
+#include "image_rgba.h"
+#include "xosera_rle.h"
+
+enum e_quant_mode
+{
+    QUANT_MEDIAN_CUT,
+    QUANT_KMEANS
+};
+
+enum e_dither_mode
+{
+    DITHER_NONE,
+    DITHER_FLOYD_STEINBERG,
+    DITHER_BAYER
+};
+
+int           num_colors    = 16;
+e_quant_mode  quant_mode    = QUANT_KMEANS;
+e_dither_mode dither_mode   = DITHER_FLOYD_STEINBERG;
+int           kmeans_iters  = 8;
+bool          compress      = false;        // write bitmap as .xrle
+bool          verbose       = true;
+char *        in_file       = nullptr;
+char *        out_file      = nullptr;
+char *        batch         = nullptr;        // manifest file or glob pattern for batch mode
+char *        out_dir       = nullptr;        // batch output directory
+int           threads       = 0;              // batch worker threads (0 = one per CPU)
+const char *  quant_name[]  = {"median cut", "median cut + k-means"};
+const char *  dither_name[] = {"none", "Floyd-Steinberg", "ordered 8x8 Bayer"};
+
+#define HIST_SIZE  4096        // 12-bit color histogram
+#define MAX_COLORS 256
+
+struct hist_bin_t
+{
+    uint32_t count;          // pixels in bin
+    uint32_t r, g, b;        // sum of 8-bit channel values of pixels in bin
+};
+
+struct quant_box_t
+{
+    std::vector<uint16_t> bins;         // non-empty histogram bins in box
+    uint64_t              count;        // pixels in box
+};
+
+bool convert_file(const char * in_name, const char * out_name, std::string * error);
+
+// 8-bit channel to nearest 4-bit value
+static inline int to4(int v)
+{
+    return (v * 15 + 127) / 255;
+}
+
+static inline int clamp8(int v)
+{
+    return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+static inline uint16_t rgb12(float r, float g, float b)
+{
+    return static_cast<uint16_t>((to4(clamp8(static_cast<int>(r + 0.5f))) << 8) |
+                                 (to4(clamp8(static_cast<int>(g + 0.5f))) << 4) |
+                                 to4(clamp8(static_cast<int>(b + 0.5f))));
+}
+
+// squared distance from r, g, b to each of n colors (structure of arrays, four colors per SIMD step)
+static void color_dist_kernel(const float * cr,
+                              const float * cg,
+                              const float * cb,
+                              int           n,
+                              float         r,
+                              float         g,
+                              float         b,
+                              float *       dist)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128 vr = _mm_set1_ps(r);
+    const __m128 vg = _mm_set1_ps(g);
+    const __m128 vb = _mm_set1_ps(b);
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 dr = _mm_sub_ps(_mm_loadu_ps(cr + i), vr);
+        __m128 dg = _mm_sub_ps(_mm_loadu_ps(cg + i), vg);
+        __m128 db = _mm_sub_ps(_mm_loadu_ps(cb + i), vb);
+        _mm_storeu_ps(dist + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db)));
+    }
+#elif defined(__ARM_NEON)
+    const float32x4_t vr = vdupq_n_f32(r);
+    const float32x4_t vg = vdupq_n_f32(g);
+    const float32x4_t vb = vdupq_n_f32(b);
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4_t dr = vsubq_f32(vld1q_f32(cr + i), vr);
+        float32x4_t dg = vsubq_f32(vld1q_f32(cg + i), vg);
+        float32x4_t db = vsubq_f32(vld1q_f32(cb + i), vb);
+        vst1q_f32(dist + i, vaddq_f32(vaddq_f32(vmulq_f32(dr, dr), vmulq_f32(dg, dg)), vmulq_f32(db, db)));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        float dr = cr[i] - r;
+        float dg = cg[i] - g;
+        float db = cb[i] - b;
+        dist[i]  = dr * dr + dg * dg + db * db;
+    }
+}
+
+static int min_index(const float * dist, int n)
+{
+    int   best      = 0;
+    float best_dist = dist[0];
+    for (int i = 1; i < n; i++)
+    {
+        if (dist[i] < best_dist)
+        {
+            best      = i;
+            best_dist = dist[i];
+        }
+    }
+
+    return best;
+}
+
+static void build_histogram(const image_rgba_t * rgba, std::vector<hist_bin_t> * hist)
+{
+    hist->assign(HIST_SIZE, hist_bin_t());
+    for (int y = 0; y < rgba->h; y++)
+    {
+        const rgba_t * row = image_rgba_row(rgba, y);
+        for (int x = 0; x < rgba->w; x++)
+        {
+            hist_bin_t & bin = (*hist)[(to4(row[x].r) << 8) | (to4(row[x].g) << 4) | to4(row[x].b)];
+            bin.count++;
+            bin.r += row[x].r;
+            bin.g += row[x].g;
+            bin.b += row[x].b;
+        }
+    }
+}
+
+static inline float bin_mean(const hist_bin_t & bin, int channel)
+{
+    uint32_t sum = channel == 0 ? bin.r : (channel == 1 ? bin.g : bin.b);
+    return static_cast<float>(sum) / bin.count;
+}
+
+// split box along channel with largest spread at weighted median, returns false if box can't be split
+static bool split_box(const std::vector<hist_bin_t> & hist, quant_box_t * box, quant_box_t * newbox)
+{
+    if (box->bins.size() < 2)
+    {
+        return false;
+    }
+
+    float lo[3] = {255.0f, 255.0f, 255.0f};
+    float hi[3] = {0.0f, 0.0f, 0.0f};
+    for (uint16_t i : box->bins)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            float v = bin_mean(hist[i], c);
+            lo[c]   = std::min(lo[c], v);
+            hi[c]   = std::max(hi[c], v);
+        }
+    }
+    int axis = 0;
+    for (int c = 1; c < 3; c++)
+    {
+        if (hi[c] - lo[c] > hi[axis] - lo[axis])
+        {
+            axis = c;
+        }
+    }
+
+    std::sort(box->bins.begin(), box->bins.end(), [&](uint16_t a, uint16_t b) {
+        return bin_mean(hist[a], axis) < bin_mean(hist[b], axis);
+    });
+
+    uint64_t half  = box->count / 2;
+    uint64_t sum   = 0;
+    size_t   split = 1;
+    for (size_t i = 0; i < box->bins.size() - 1; i++)
+    {
+        sum += hist[box->bins[i]].count;
+        split = i + 1;
+        if (sum >= half)
+        {
+            break;
+        }
+    }
+
+    newbox->bins.assign(box->bins.begin() + split, box->bins.end());
+    box->bins.resize(split);
+    newbox->count = 0;
+    for (uint16_t i : newbox->bins)
+    {
+        newbox->count += hist[i].count;
+    }
+    box->count -= newbox->count;
+
+    return true;
+}
+
+// median cut into at most num_colors boxes, returning box mean colors (8-bit) in cr/cg/cb
+static int median_cut(const std::vector<hist_bin_t> & hist, float * cr, float * cg, float * cb)
+{
+    std::vector<quant_box_t> boxes(1);
+    for (int i = 0; i < HIST_SIZE; i++)
+    {
+        if (hist[i].count)
+        {
+            boxes[0].bins.push_back(static_cast<uint16_t>(i));
+            boxes[0].count += hist[i].count;
+        }
+    }
+
+    while (static_cast<int>(boxes.size()) < num_colors)
+    {
+        // split most populated box that has more than one color
+        int best = -1;
+        for (size_t i = 0; i < boxes.size(); i++)
+        {
+            if (boxes[i].bins.size() > 1 && (best < 0 || boxes[i].count > boxes[best].count))
+            {
+                best = static_cast<int>(i);
+            }
+        }
+        quant_box_t newbox;
+        if (best < 0 || !split_box(hist, &boxes[best], &newbox))
+        {
+            break;
+        }
+        boxes.push_back(newbox);
+    }
+
+    int n = 0;
+    for (const quant_box_t & box : boxes)
+    {
+        uint64_t r = 0, g = 0, b = 0;
+        for (uint16_t i : box.bins)
+        {
+            r += hist[i].r;
+            g += hist[i].g;
+            b += hist[i].b;
+        }
+        if (box.count)
+        {
+            cr[n] = static_cast<float>(r) / box.count;
+            cg[n] = static_cast<float>(g) / box.count;
+            cb[n] = static_cast<float>(b) / box.count;
+            n++;
+        }
+    }
+
+    return n;
+}
+
+// refine n colors in cr/cg/cb with weighted k-means (Lloyd) iterations over histogram bins
+static void kmeans_refine(const std::vector<hist_bin_t> & hist, float * cr, float * cg, float * cb, int n)
+{
+    float  dist[MAX_COLORS];
+    double sr[MAX_COLORS], sg[MAX_COLORS], sb[MAX_COLORS], sn[MAX_COLORS];
+
+    for (int iter = 0; iter < kmeans_iters; iter++)
+    {
+        std::fill(sr, sr + n, 0.0);
+        std::fill(sg, sg + n, 0.0);
+        std::fill(sb, sb + n, 0.0);
+        std::fill(sn, sn + n, 0.0);
+
+        for (int i = 0; i < HIST_SIZE; i++)
+        {
+            const hist_bin_t & bin = hist[i];
+            if (!bin.count)
+            {
+                continue;
+            }
+            color_dist_kernel(cr, cg, cb, n, bin_mean(bin, 0), bin_mean(bin, 1), bin_mean(bin, 2), dist);
+            int c = min_index(dist, n);
+            sr[c] += bin.r;
+            sg[c] += bin.g;
+            sb[c] += bin.b;
+            sn[c] += bin.count;
+        }
+
+        for (int c = 0; c < n; c++)
+        {
+            if (sn[c] > 0.0)        // (unused colors keep old value)
+            {
+                cr[c] = static_cast<float>(sr[c] / sn[c]);
+                cg[c] = static_cast<float>(sg[c] / sn[c]);
+                cb[c] = static_cast<float>(sb[c] / sn[c]);
+            }
+        }
+    }
+}
+
+// build num_colors 0xRGB palette for image (unused entries are 0x000)
+static void build_palette(const image_rgba_t * rgba, uint16_t * palette)
+{
+    std::vector<hist_bin_t> hist;
+    float                   cr[MAX_COLORS], cg[MAX_COLORS], cb[MAX_COLORS];
+
+    build_histogram(rgba, &hist);
+    int n = median_cut(hist, cr, cg, cb);
+    if (quant_mode == QUANT_KMEANS)
+    {
+        kmeans_refine(hist, cr, cg, cb, n);
+    }
+
+    for (int c = 0; c < num_colors; c++)
+    {
+        palette[c] = c < n ? rgb12(cr[c], cg[c], cb[c]) : 0x000;
+    }
+}
+
+static inline int pal_chan(uint16_t color, int shift)
+{
+    return ((color >> shift) & 0xf) * 17;
+}
+
+// map image pixels to palette indices (one byte per pixel) with dithering, returns mean squared error
+static double quantize_image(const image_rgba_t * rgba,
+                             const uint16_t *     palette,
+                             const color_lut_t *  lut,
+                             uint8_t *            out)
+{
+    int              w = rgba->w;
+    int              h = rgba->h;
+    std::vector<int> err_cur((w + 2) * 3), err_next((w + 2) * 3);        // error * 16, with 1 pixel border
+    double           sq_err = 0.0;
+
+    // ordered dither offset range (about palette spacing in each channel)
+    float spread = 255.0f / cbrtf(static_cast<float>(num_colors));
+
+    for (int y = 0; y < h; y++)
+    {
+        const rgba_t * row = image_rgba_row(rgba, y);
+        uint8_t *      dst = out + y * w;
+        std::fill(err_next.begin(), err_next.end(), 0);
+
+        for (int x = 0; x < w; x++)
+        {
+            int r = row[x].r;
+            int g = row[x].g;
+            int b = row[x].b;
+
+            if (dither_mode == DITHER_FLOYD_STEINBERG)
+            {
+                const int * e = &err_cur[(x + 1) * 3];
+                r             = clamp8(r + e[0] / 16);
+                g             = clamp8(g + e[1] / 16);
+                b             = clamp8(b + e[2] / 16);
+            }
+            else if (dither_mode == DITHER_BAYER)
+            {
+                int offset = static_cast<int>(((bayer8[y & 7][x & 7] + 0.5f) / 64.0f - 0.5f) * spread);
+                r          = clamp8(r + offset);
+                g          = clamp8(g + offset);
+                b          = clamp8(b + offset);
+            }
+
+            uint8_t  c     = color_lut_match(lut, to4(r), to4(g), to4(b));
+            uint16_t color = palette[c];
+            dst[x]         = c;
+
+            int pr = pal_chan(color, 8);
+            int pg = pal_chan(color, 4);
+            int pb = pal_chan(color, 0);
+
+            int sr = row[x].r - pr;
+            int sg = row[x].g - pg;
+            int sb = row[x].b - pb;
+            sq_err += sr * sr + sg * sg + sb * sb;
+
+            if (dither_mode == DITHER_FLOYD_STEINBERG)
+            {
+                int er[3] = {r - pr, g - pg, b - pb};
+                for (int i = 0; i < 3; i++)
+                {
+                    err_cur[(x + 2) * 3 + i] += er[i] * 7;
+                    err_next[(x + 0) * 3 + i] += er[i] * 3;
+                    err_next[(x + 1) * 3 + i] += er[i] * 5;
+                    err_next[(x + 2) * 3 + i] += er[i] * 1;
+                }
+            }
+        }
+        std::swap(err_cur, err_next);
+    }
+
+    return (w > 0 && h > 0) ? sq_err / (3.0 * w * h) : 0.0;
+}
+
+// write packed bitmap and palette files, returns false and sets error on failure
+static bool write_raw(const char *     out_base,
+                      const uint8_t *  pixels,
+                      int              w,
+                      int              h,
+                      const uint16_t * palette,
+                      std::string *    error)
+{
+    std::string          raw_name = std::string(out_base) + (compress ? ".xrle" : ".raw");
+    std::string          pal_name = std::string(out_base) + "_pal.raw";
+    std::vector<uint8_t> data;
+
+    if (num_colors <= 16)
+    {
+        int bytes_per_row = (w + 1) / 2;
+        data.assign(bytes_per_row * h, 0);
+        for (int y = 0; y < h; y++)
+        {
+            for (int x = 0; x < w; x++)
+            {
+                data[y * bytes_per_row + x / 2] |= (x & 1) ? pixels[y * w + x] : (pixels[y * w + x] << 4);
+            }
+        }
+    }
+    else
+    {
+        data.assign(pixels, pixels + w * h);
+    }
+    if (compress)
+    {
+        if (data.size() & 1)
+        {
+            data.push_back(0);        // pad to whole word
+        }
+        std::vector<uint8_t> xrle(XRLE_MAX_BYTES(data.size() / 2));
+        xrle.resize(xrle_encode(data.data(), data.size(), xrle.data()));
+        data.swap(xrle);
+    }
+
+    FILE * fp = fopen(raw_name.c_str(), "wb");
+    if (fp == nullptr)
+    {
+        *error = "Unable to open \"" + raw_name + "\"";
+        return false;
+    }
+    bool good = fwrite(data.data(), 1, data.size(), fp) == data.size();
+    good      = (fclose(fp) == 0) && good;
+
+    fp = fopen(pal_name.c_str(), "wb");
+    if (fp == nullptr)
+    {
+        *error = "Unable to open \"" + pal_name + "\"";
+        return false;
+    }
+    for (int c = 0; c < num_colors; c++)
+    {
+        // big-endian
+        fputc(palette[c] >> 8, fp);
+        fputc(palette[c] & 0xff, fp);
+    }
+    good = (fclose(fp) == 0) && good;
+
+    if (!good)
+    {
+        *error = "Failed writing \"" + raw_name + "\" or \"" + pal_name + "\"";
+    }
+
+    return good;
+}
+
+bool convert_file(const char * in_name, const char * out_name, std::string * error)
+{
+    SDL_Surface * image = IMG_Load(in_name);
+    if (!image)
+    {
+        *error = std::string("Unable to load: ") + SDL_GetError();
+        return false;
+    }
+
+    image_rgba_t rgba = {};
+    bool         good = false;
+    if (!image_rgba_init(&rgba, image))
+    {
+        *error = std::string("Unable to convert to RGBA8888: ") + SDL_GetError();
+    }
+    else
+    {
+        uint16_t             palette[MAX_COLORS];
+        color_lut_t          lut;
+        std::vector<uint8_t> pixels(rgba.w * rgba.h);
+
+        build_palette(&rgba, palette);
+        color_lut_build(&lut, palette, num_colors);
+        double mse = quantize_image(&rgba, palette, &lut, pixels.data());
+
+        if (verbose)
+        {
+            printf("Input image size: %d x %d\n", rgba.w, rgba.h);
+            printf("Palette (%d colors):", num_colors);
+            for (int c = 0; c < num_colors; c++)
+            {
+                printf("%s0x%03x", (c & 0xf) ? ", " : "\n    ", palette[c]);
+            }
+            printf("\nMean squared error %.2f (PSNR %.2f dB)\n",
+                   mse,
+                   mse > 0.0 ? 10.0 * log10(255.0 * 255.0 / mse) : 99.0);
+        }
+
+        good = write_raw(out_name, pixels.data(), rgba.w, rgba.h, palette, error);
+    }
+
+    image_rgba_free(&rgba);
+    SDL_FreeSurface(image);
+
+    return good;
+}
+
+int main(int argc, char ** argv)
+{
+    printf("Xosera image to 4-bpp/8-bpp bitmap with optimized palette - Xark\n\n");
+
+    for (int a = 1; a < argc; a++)
+    {
+        if (argv[a][0] == '-')
+        {
+            if (strcmp("-16", argv[a]) == 0)
+            {
+                num_colors = 16;
+            }
+            else if (strcmp("-256", argv[a]) == 0)
+            {
+                num_colors = 256;
+            }
+            else if (strcmp("-m", argv[a]) == 0)
+            {
+                quant_mode = QUANT_MEDIAN_CUT;
+            }
+            else if (strcmp("-k", argv[a]) == 0 && a + 1 < argc)
+            {
+                quant_mode   = QUANT_KMEANS;
+                kmeans_iters = atoi(argv[++a]);
+            }
+            else if (strcmp("-f", argv[a]) == 0)
+            {
+                dither_mode = DITHER_FLOYD_STEINBERG;
+            }
+            else if (strcmp("-d", argv[a]) == 0)
+            {
+                dither_mode = DITHER_BAYER;
+            }
+            else if (strcmp("-n", argv[a]) == 0)
+            {
+                dither_mode = DITHER_NONE;
+            }
+            else if (strcmp("-z", argv[a]) == 0)
+            {
+                compress = true;
+            }
+            else if (strcmp("-B", argv[a]) == 0 && a + 1 < argc)
+            {
+                batch = argv[++a];
+            }
+            else if (strcmp("-o", argv[a]) == 0 && a + 1 < argc)
+            {
+                out_dir = argv[++a];
+            }
+            else if (strcmp("-j", argv[a]) == 0 && a + 1 < argc)
+            {
+                threads = atoi(argv[++a]);
+            }
+            else
+            {
+                printf("Unexpected option: '%s'\n", argv[a]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else
+        {
+            if (!in_file)
+            {
+                in_file = argv[a];
+            }
+            else if (!out_file)
+            {
+                out_file = argv[a];
+            }
+            else
+            {
+                printf("Unexpected extra argument: '%s'\n", argv[a]);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    if (!batch && (!in_file || !out_file))
+    {
+        printf("image_quantize: Convert image to 4-bpp or 8-bpp bitmap with optimized 12-bit palette\n");
+        printf("Usage:  image_quantize <input image> <output basename> [options]\n");
+        printf("        (will create \"<basename>.raw\" and \"<basename>_pal.raw\")\n");
+        printf("        image_quantize -B <manifest | \"glob\"> [-o <dir>] [-j <threads>] [options]\n");
+        printf("   -16  16 color palette, 4-bpp output (default)\n");
+        printf("   -256 256 color palette, 8-bpp output\n");
+        printf("   -m   Median cut palette only\n");
+        printf("   -k <n> Median cut refined with <n> k-means iterations (default 8)\n");
+        printf("   -f   Floyd-Steinberg error diffusion dither (default)\n");
+        printf("   -d   Ordered 8x8 Bayer dither\n");
+        printf("   -n   No dither\n");
+        printf("   -z   Write word RLE compressed \"<basename>.xrle\" instead of \"<basename>.raw\"\n");
+        printf("   -B <manifest | \"glob\">  Batch convert images (manifest has \"<input> [basename]\" lines)\n");
+        printf("   -o <dir>      Batch output directory (default is beside input)\n");
+        printf("   -j <threads>  Batch worker threads (default one per CPU)\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (kmeans_iters < 0)
+    {
+        kmeans_iters = 0;
+    }
+
+    printf("Palette: %d colors (%s), dither: %s\n",
+           num_colors,
+           quant_name[quant_mode],
+           dither_name[dither_mode]);
+
+    IMG_Init(IMG_INIT_PNG);
+
+    int failed = 0;
+    if (batch)
+    {
+        std::vector<batch_item_t> items;
+
+        verbose = false;
+        failed  = -1;
+        if (batch_add_items(&items, batch, out_dir, ""))
+        {
+            failed = batch_convert(&items, convert_file, threads);
+        }
+    }
+    else
+    {
+        std::string error;
+
+        printf("Input image file     : \"%s\"\n", in_file);
+        printf("Output files         : \"%s%s\" and \"%s_pal.raw\"\n", out_file, compress ? ".xrle" : ".raw", out_file);
+        if (convert_file(in_file, out_file, &error))
+        {
+            printf("Success.\n");
+        }
+        else
+        {
+            printf("*** %s\n", error.c_str());
+            failed = 1;
+        }
+    }
+
+    IMG_Quit();
+    SDL_Quit();
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
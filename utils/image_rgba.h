@@ -0,0 +1,70 @@
+// image_rgba.h - fixed RGBA8888 pixel rows for image utilities
+// Xark - 2021
+// See top-level LICENSE file for license information. (Hint: MIT)
+//
+// Loaded SDL surfaces can be any pixel format, and reading them with getpixel() + SDL_GetRGB() per pixel is very
+// slow for large images.  image_rgba converts the surface once to RGBA8888 (bytes R, G, B, A in memory) so
+// conversion loops can walk plain row pointers with fixed size pixels instead of making calls per pixel.
+#if !defined(IMAGE_RGBA_H)
+#define IMAGE_RGBA_H
+
+#include <SDL.h>
+#include <stdint.h>
+
+struct rgba_t
+{
+    uint8_t r, g, b, a;
+};
+
+struct image_rgba_t
+{
+    SDL_Surface * surface;        // converted RGBA8888 surface (owns pixels)
+    int           w;              // width in pixels
+    int           h;              // height in pixels
+    int           pitch;          // row pitch in pixels
+};
+
+// convert image to RGBA8888 (image is not freed), returns false on failure
+static inline bool image_rgba_init(image_rgba_t * rgba, SDL_Surface * image)
+{
+    rgba->surface = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0);
+    if (!rgba->surface)
+    {
+        rgba->w     = 0;
+        rgba->h     = 0;
+        rgba->pitch = 0;
+        return false;
+    }
+    rgba->w     = rgba->surface->w;
+    rgba->h     = rgba->surface->h;
+    rgba->pitch = rgba->surface->pitch / static_cast<int>(sizeof(rgba_t));
+
+    return true;
+}
+
+static inline void image_rgba_free(image_rgba_t * rgba)
+{
+    if (rgba->surface)
+    {
+        SDL_FreeSurface(rgba->surface);
+        rgba->surface = nullptr;
+    }
+}
+
+static inline const rgba_t * image_rgba_row(const image_rgba_t * rgba, int y)
+{
+    return static_cast<const rgba_t *>(rgba->surface->pixels) + y * rgba->pitch;
+}
+
+// set out[x] to 1 if average of R, G and B is >= 128 (else 0), inverted if invert set
+static inline void image_rgba_threshold_row(const rgba_t * row, uint8_t * out, int w, bool invert)
+{
+    const uint8_t on = invert ? 0 : 1;
+    for (int x = 0; x < w; x++)
+    {
+        int sum = row[x].r + row[x].g + row[x].b;
+        out[x]  = (sum >= 3 * 128) ? on : static_cast<uint8_t>(on ^ 1);
+    }
+}
+
+#endif        // IMAGE_RGBA_H
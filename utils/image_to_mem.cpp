@@ -3,24 +3,53 @@
 // See top-level LICENSE file for license information. (Hint: MIT)
 #include <SDL.h>
 #include <SDL_image.h>
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <string>
+#include <vector>
+
+#include "batch_convert.h"
+#include "image_rgba.h"
+
 bool   word_mode = false;
 bool   c_mode    = false;
 bool   invert    = false;
 char * in_file   = nullptr;
 char * out_file  = nullptr;
+char * batch     = nullptr;        // manifest file or glob pattern for batch mode
+char * out_dir   = nullptr;        // batch output directory
+int    threads   = 0;              // batch worker threads (0 = one per CPU)
+char * tile_out  = nullptr;        // tile memory image basename (fonts packed for XR_TILE_ADDR)
+
+std::vector<char *> font_files;        // input fonts for tile memory image
 
 int font_height = 0;
 int font_chars  = 0;
 
-Uint32 getpixel(SDL_Surface * surface, int x, int y);
+int     cmd_argc;        // command line (for C mode comment)
+char ** cmd_argv;
+
+int  detect_font_height(int w, int h);
+bool write_font(const uint8_t * bits, int w, int h, int height, const char * out_name, std::string * error);
+bool load_font(const char *  in_name,
+               int           force_height,
+               uint8_t **    bits_out,
+               int *         w_out,
+               int *         h_out,
+               int *         height_out,
+               std::string * error);
+bool convert_file(const char * in_name, const char * out_name, std::string * error);
+bool write_tile_image(const std::vector<char *> & fonts, const char * out_base);
 
 int main(int argc, char ** argv)
 {
     printf("Xosera image to Verilog mem utility for 8x8 or 8x16 monochrome fonts - Xark\n\n");
 
+    cmd_argc = argc;
+    cmd_argv = argv;
+
     for (int a = 1; a < argc; a++)
     {
         if (argv[a][0] == '-')
@@ -45,6 +74,22 @@ int main(int argc, char ** argv)
             {
                 font_height = 16;
             }
+            else if (strcmp("-B", argv[a]) == 0 && a + 1 < argc)
+            {
+                batch = argv[++a];
+            }
+            else if (strcmp("-o", argv[a]) == 0 && a + 1 < argc)
+            {
+                out_dir = argv[++a];
+            }
+            else if (strcmp("-j", argv[a]) == 0 && a + 1 < argc)
+            {
+                threads = atoi(argv[++a]);
+            }
+            else if (strcmp("-t", argv[a]) == 0 && a + 1 < argc)
+            {
+                tile_out = argv[++a];
+            }
             else
             {
                 printf("Unexpected option: '%s'\n", argv[a]);
@@ -53,6 +98,7 @@ int main(int argc, char ** argv)
         }
         else
         {
+            font_files.push_back(argv[a]);
             if (!in_file)
             {
                 in_file = argv[a];
@@ -61,7 +107,7 @@ int main(int argc, char ** argv)
             {
                 out_file = argv[a];
             }
-            else
+            else if (!tile_out)
             {
                 printf("Unexpected extra argument: '%s'\n", argv[a]);
                 exit(EXIT_FAILURE);
@@ -69,7 +115,22 @@ int main(int argc, char ** argv)
         }
     }
 
-    if (!in_file || !out_file)
+    if (tile_out)
+    {
+        if (font_files.empty())
+        {
+            printf("*** No input fonts for tile memory image\n");
+            exit(EXIT_FAILURE);
+        }
+        IMG_Init(IMG_INIT_PNG);
+        bool good = write_tile_image(font_files, tile_out);
+        IMG_Quit();
+        SDL_Quit();
+
+        return good ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (!batch && (!in_file || !out_file))
     {
         printf("image_to_mem: Convert image to monochome 8x8 or 8x16 Verilog \"mem\" file.\n");
         printf("Usage:  image_to_mem <input font image> <output font mem> [-i]\n");
@@ -78,9 +139,32 @@ int main(int argc, char ** argv)
         printf("   -w   16-bit word output\n");
         printf("   -8   Override font size auto-detect and use 8x8\n");
         printf("   -16  Override font size auto-detect and use 8x16\n");
+        printf("   -B <manifest | \"glob\">  Batch convert images (manifest has \"<input> [output]\" lines), no window\n");
+        printf("   -o <dir>      Batch output directory (default is beside input, with \".mem\" extension)\n");
+        printf("   -j <threads>  Batch worker threads (default one per CPU)\n");
+        printf("        image_to_mem -t <basename> <font image> [<font image> ...] [-i] [-8 | -16]\n");
+        printf("   -t <basename> Pack fonts into binary tile memory image \"<basename>.raw\" (for XR_TILE_ADDR) and\n");
+        printf("                 C header \"<basename>.h\" with font index and proportional glyph metrics, no window\n");
         exit(EXIT_FAILURE);
     }
 
+    if (batch)
+    {
+        std::vector<batch_item_t> items;
+        IMG_Init(IMG_INIT_PNG);
+
+        int failed = -1;
+        if (batch_add_items(&items, batch, out_dir, c_mode ? ".h" : ".mem"))
+        {
+            failed = batch_convert(&items, convert_file, threads);
+        }
+
+        IMG_Quit();
+        SDL_Quit();
+
+        return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     printf("Input image file     : \"%s\"\n", in_file);
     printf("Output mem font file : \"%s\"\n", out_file);
     if (invert)
@@ -120,6 +204,8 @@ int main(int argc, char ** argv)
     }
 
     SDL_Surface * image = IMG_Load(in_file);
+    image_rgba_t  rgba  = {};
+    uint8_t *     bits  = nullptr;        // 1 byte per pixel, 1 if pixel set (after invert)
 
     int w = 0;
     int h = 0;
@@ -129,6 +215,11 @@ int main(int argc, char ** argv)
         printf("*** Unable to load \"%s\"\n", in_file);
         quit = true;
     }
+    else if (!image_rgba_init(&rgba, image))
+    {
+        printf("*** Unable to convert \"%s\" to RGBA8888: %s\n", in_file, SDL_GetError());
+        quit = true;
+    }
     else
     {
         w = image->w;
@@ -141,19 +232,17 @@ int main(int argc, char ** argv)
         }
         else
         {
-            int pixelcount = w * h;
+            font_height = detect_font_height(w, h);
 
-            if (pixelcount <= 16384)
+            if (font_height == 8)
             {
                 printf("8x8 font detected.\n");
-                font_height = 8;
-                font_chars  = (w / 8) * (h / 8);
+                font_chars = (w / 8) * (h / 8);
             }
-            else if (pixelcount <= 32768)
+            else if (font_height == 16)
             {
                 printf("256 8x16 font detected.\n");
-                font_height = 16;
-                font_chars  = (w / 8) * (h / 16);
+                font_chars = (w / 8) * (h / 16);
             }
             else
             {
@@ -165,6 +254,24 @@ int main(int argc, char ** argv)
         }
     }
 
+    if (!quit)
+    {
+        // threshold whole image once, row by row
+        bits = static_cast<uint8_t *>(malloc(w * h));
+        if (!bits)
+        {
+            printf("*** Out of memory\n");
+            quit = true;
+        }
+        else
+        {
+            for (int y = 0; y < h; y++)
+            {
+                image_rgba_threshold_row(image_rgba_row(&rgba, y), bits + y * w, w, invert);
+            }
+        }
+    }
+
     // process the image
     if (!quit)
     {
@@ -197,145 +304,455 @@ int main(int argc, char ** argv)
             }
         }
 
-        FILE * fp = fopen(out_file, "w");
-        if (fp != nullptr)
+        std::string error;
+        printf("Writing output...\n");
+        if (write_font(bits, w, h, font_height, out_file, &error))
+        {
+            printf("Success.\n");
+        }
+        else
+        {
+            printf("*** %s\n", error.c_str());
+        }
+    }
+
+    free(bits);
+    image_rgba_free(&rgba);
+    if (image)
+    {
+        SDL_FreeSurface(image);
+    }
+    SDL_DestroyWindow(window);
+
+    IMG_Quit();
+    SDL_Quit();
+
+    return 0;
+}
+
+// font height for image size (8 or 16), or 0 if it can't be autodetected
+int detect_font_height(int w, int h)
+{
+    int pixelcount = w * h;
+
+    if (pixelcount <= 16384)
+    {
+        return 8;
+    }
+    else if (pixelcount <= 32768)
+    {
+        return 16;
+    }
+
+    return 0;
+}
+
+// write thresholded image bits (1 byte per pixel) as 8 x height glyphs, returns false and sets error on failure
+bool write_font(const uint8_t * bits, int w, int h, int height, const char * out_name, std::string * error)
+{
+    FILE * fp = fopen(out_name, "w");
+    if (fp == nullptr)
+    {
+        *error = std::string("Unable to open write to output file \"") + out_name + "\"";
+        return false;
+    }
+
+    if (c_mode)
+    {
+        fprintf(fp, "// Generated by: image_to_mem ");
+        for (int i = 1; i < cmd_argc; i++)
         {
-            printf("Writing output...\n");
+            fprintf(fp, "%s ", cmd_argv[i]);
+        }
+        fprintf(fp, "\n");
+        fprintf(fp, "uint8_t font[256*%d] =\n", height);
+        fprintf(fp, "{\n");
+    }
 
-            if (c_mode)
+    uint8_t cn = 0;
+    for (int cy = 0; cy < h; cy += height)
+    {
+        for (int cx = 0; cx < w; cx += 8)
+        {
+            char hex[8] = {0};
+            char lit[8] = {0};
+            sprintf(hex, "\\x%02x", cn);
+            sprintf(lit, "%c", cn);
+            fprintf(fp, "// 0x%02x '%s'\n", cn, isprint(cn) ? lit : hex);
+            for (int y = 0; y < height; y++)
             {
-                fprintf(fp, "// Generated by: image_to_mem ");
-                for (int i = 1; i < argc; i++)
+                if (c_mode && (!word_mode || !(y & 1)))
                 {
-                    fprintf(fp, "%s ", argv[i]);
+                    fprintf(fp, "0b");
                 }
-                fprintf(fp, "\n");
-                fprintf(fp, "uint8_t font[256*%d] =\n", font_height);
-                fprintf(fp, "{\n");
-            }
-
-            uint8_t cn = 0;
-            for (int cy = 0; cy < h; cy += font_height)
-            {
-                for (int cx = 0; cx < w; cx += 8)
+                const uint8_t * glyph_row = bits + (cy + y) * w + cx;
+                for (int x = 0; x < 8; x++)
                 {
-                    char hex[8] = {0};
-                    char lit[8] = {0};
-                    sprintf(hex, "\\x%02x", cn);
-                    sprintf(lit, "%c", cn);
-                    fprintf(fp, "// 0x%02x '%s'\n", cn, isprint(cn) ? lit : hex);
-                    for (int y = 0; y < font_height; y++)
+                    fprintf(fp, "%s", glyph_row[x] ? "1" : "0");
+                }
+                if (!word_mode)
+                {
+                    if (c_mode)
                     {
-                        if (c_mode && (!word_mode || !(y & 1)))
-                        {
-                            fprintf(fp, "0b");
-                        }
-                        for (int x = 0; x < 8; x++)
-                        {
-                            SDL_Color rgb;
-                            Uint32    data = getpixel(image, cx + x, cy + y);
-                            SDL_GetRGB(data, image->format, &rgb.r, &rgb.g, &rgb.b);
-                            int v = (rgb.r + rgb.g + rgb.b) / 3;
-
-                            bool pixel = (v >= 128);
-                            if (invert)
-                            {
-                                pixel = !pixel;
-                            }
-                            fprintf(fp, "%s", pixel ? "1" : "0");
-                        }
-                        if (!word_mode)
-                        {
-                            if (c_mode)
-                            {
-                                fprintf(fp, ",");
-                            }
-                            fprintf(fp, "    // ");
-                            for (int x = 0; x < 8; x++)
-                            {
-                                SDL_Color rgb;
-                                Uint32    data = getpixel(image, cx + x, cy + y);
-                                SDL_GetRGB(data, image->format, &rgb.r, &rgb.g, &rgb.b);
-                                int v = (rgb.r + rgb.g + rgb.b) / 3;
-
-                                bool pixel = (v >= 128);
-                                if (invert)
-                                {
-                                    pixel = !pixel;
-                                }
-                                fprintf(fp, "%s", pixel ? "#" : ".");
-                            }
-                            fprintf(fp, "\n");
-                        }
-                        else
+                        fprintf(fp, ",");
+                    }
+                    fprintf(fp, "    // ");
+                    for (int x = 0; x < 8; x++)
+                    {
+                        fprintf(fp, "%s", glyph_row[x] ? "#" : ".");
+                    }
+                    fprintf(fp, "\n");
+                }
+                else
+                {
+                    if (y & 1)
+                    {
+                        if (c_mode)
                         {
-                            if (y & 1)
-                            {
-                                if (c_mode)
-                                {
-                                    fprintf(fp, ",");
-                                }
-                                fprintf(fp, "\n");
-                            }
+                            fprintf(fp, ",");
                         }
+                        fprintf(fp, "\n");
                     }
-                    fprintf(fp, "\n");
-                    cn++;
                 }
             }
-            if (c_mode)
+            fprintf(fp, "\n");
+            cn++;
+        }
+    }
+    if (c_mode)
+    {
+        fprintf(fp, "};\n");
+    }
+    if (fclose(fp) != 0)
+    {
+        *error = std::string("Failed to write \"") + out_name + "\"";
+        return false;
+    }
+
+    return true;
+}
+
+// load and threshold font image in_name (1 byte per pixel in malloc'd *bits_out), uses force_height or autodetects
+// glyph height (8 or 16), returns false and sets error on failure
+bool load_font(const char *  in_name,
+               int           force_height,
+               uint8_t **    bits_out,
+               int *         w_out,
+               int *         h_out,
+               int *         height_out,
+               std::string * error)
+{
+    SDL_Surface * image = IMG_Load(in_name);
+    if (!image)
+    {
+        *error = std::string("Unable to load \"") + in_name + "\": " + SDL_GetError();
+        return false;
+    }
+
+    image_rgba_t rgba   = {};
+    uint8_t *    bits   = nullptr;
+    bool         good   = false;
+    int          height = force_height;
+    if (!image_rgba_init(&rgba, image))
+    {
+        *error = std::string("Unable to convert to RGBA8888: ") + SDL_GetError();
+    }
+    else if ((rgba.w & 0x7) != 0 || (rgba.h & 0x7) != 0 || (rgba.h % (height ? height : 8)) != 0)
+    {
+        *error = "Unsupported image size (width and height should be multiple of 8, or of 16 for 8x16)";
+    }
+    else if (height == 0 && (height = detect_font_height(rgba.w, rgba.h)) == 0)
+    {
+        *error = "Can't autodetect 8x8 or 8x16";
+    }
+    else if ((bits = static_cast<uint8_t *>(malloc(rgba.w * rgba.h))) == nullptr)
+    {
+        *error = "Out of memory";
+    }
+    else
+    {
+        for (int y = 0; y < rgba.h; y++)
+        {
+            image_rgba_threshold_row(image_rgba_row(&rgba, y), bits + y * rgba.w, rgba.w, invert);
+        }
+        *bits_out   = bits;
+        *w_out      = rgba.w;
+        *h_out      = rgba.h;
+        *height_out = height;
+        good        = true;
+    }
+
+    image_rgba_free(&rgba);
+    SDL_FreeSurface(image);
+
+    return good;
+}
+
+// batch mode conversion of one font image file (no window)
+bool convert_file(const char * in_name, const char * out_name, std::string * error)
+{
+    uint8_t * bits   = nullptr;
+    int       w      = 0;
+    int       h      = 0;
+    int       height = 0;
+    bool      good   = false;
+    if (load_font(in_name, 0, &bits, &w, &h, &height, error))
+    {
+        good = write_font(bits, w, h, height, out_name, error);
+    }
+    free(bits);
+
+    return good;
+}
+
+// Tile memory image
+//
+// Fonts are packed in the 1-BPP tile layout used by video_playfield (and the default fonts in tilemem.sv), each glyph
+// is height/2 words with the even line in the high byte, so glyph n of a font is at word offset + n * (height / 2).
+// Each font starts on a 1KW boundary (TILE_CTRL tile base granularity), so the image can be uploaded with one write
+// to XR_TILE_ADDR and each font selected by its Px_TILE_CTRL value.
+
+#define TILE_MEM_WORDS   0x1400        // XR tile memory size in words (5KW)
+#define TILE_BASE_ALIGN  0x0400        // TILE_CTRL tile base alignment in words
+#define TILE_MAX_GLYPHS  256           // 1-BPP tile index is 8 bits
+#define GLYPH_WIDTH      8             // glyph cell width in pixels
+
+struct tile_font_t
+{
+    std::string          name;              // C identifier from file name
+    int                  offset;            // word offset in tile memory
+    int                  height;            // glyph height (8 or 16)
+    int                  glyphs;            // number of glyphs
+    std::vector<uint8_t> metrics;           // per glyph (left << 4) | ink width, 0 for blank glyph
+};
+
+// C identifier from file name (without directory or extension)
+static std::string font_ident(const char * filename)
+{
+    const char * base = strrchr(filename, '/');
+    base              = base ? base + 1 : filename;
+    std::string name;
+    for (const char * p = base; *p && *p != '.'; p++)
+    {
+        name += isalnum(static_cast<unsigned char>(*p)) ? static_cast<char>(tolower(*p)) : '_';
+    }
+    if (name.empty() || isdigit(static_cast<unsigned char>(name[0])))
+    {
+        name = "font_" + name;
+    }
+
+    return name;
+}
+
+static std::string upper(std::string str)
+{
+    for (auto & c : str)
+    {
+        c = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+    }
+
+    return str;
+}
+
+// pack glyphs from thresholded font image bits into tile memory words at font->offset and compute glyph metrics
+static void pack_font(const uint8_t * bits, int w, int h, tile_font_t * font, std::vector<uint16_t> * mem)
+{
+    int glyph_words = font->height / 2;
+    int g           = 0;
+    for (int cy = 0; cy + font->height <= h && g < font->glyphs; cy += font->height)
+    {
+        for (int cx = 0; cx + GLYPH_WIDTH <= w && g < font->glyphs; cx += GLYPH_WIDTH, g++)
+        {
+            uint8_t columns = 0;        // OR of all glyph lines (bit 7 is leftmost column)
+            for (int y = 0; y < font->height; y++)
             {
-                fprintf(fp, "};\n");
+                const uint8_t * glyph_row = bits + (cy + y) * w + cx;
+                uint8_t         line      = 0;
+                for (int x = 0; x < GLYPH_WIDTH; x++)
+                {
+                    line = static_cast<uint8_t>((line << 1) | (glyph_row[x] ? 1 : 0));
+                }
+                columns |= line;
+
+                uint16_t & word = (*mem)[font->offset + g * glyph_words + y / 2];
+                word            = static_cast<uint16_t>((y & 1) ? (word | line) : (line << 8));
             }
-            fclose(fp);
-            printf("Success.\n");
+
+            uint8_t metric = 0;
+            if (columns)
+            {
+                int left  = 0;
+                int right = GLYPH_WIDTH - 1;
+                while (!(columns & (0x80 >> left)))
+                {
+                    left++;
+                }
+                while (!(columns & (0x80 >> right)))
+                {
+                    right--;
+                }
+                metric = static_cast<uint8_t>((left << 4) | (right - left + 1));
+            }
+            font->metrics[g] = metric;
         }
-        else
+    }
+}
+
+static bool write_tile_header(const char *                     filename,
+                              const char *                     raw_name,
+                              const char *                     out_base,
+                              const std::vector<tile_font_t> & fonts,
+                              int                              total_words)
+{
+    FILE * fp = fopen(filename, "w");
+    if (fp == nullptr)
+    {
+        printf("*** Unable to open write to output file \"%s\"\n", filename);
+        return false;
+    }
+
+    std::string guard = upper(font_ident(out_base)) + "_H";
+    std::string base  = upper(font_ident(out_base));
+
+    fprintf(fp, "// Generated by: image_to_mem ");
+    for (int i = 1; i < cmd_argc; i++)
+    {
+        fprintf(fp, "%s ", cmd_argv[i]);
+    }
+    fprintf(fp, "\n");
+    fprintf(fp, "// Tile memory image \"%s\" (%d words, upload to XR_TILE_ADDR)\n", raw_name, total_words);
+    fprintf(fp, "#if !defined(%s)\n", guard.c_str());
+    fprintf(fp, "#define %s\n\n", guard.c_str());
+    fprintf(fp, "#include <stdint.h>\n\n");
+    fprintf(fp, "#define %s_WORDS 0x%04x        // words in tile memory image\n\n", base.c_str(), total_words);
+    fprintf(fp, "// font index: tile memory word offset, Px_TILE_CTRL value (1-BPP, tilemap in VRAM), glyph height and\n");
+    fprintf(fp, "// number of glyphs\n");
+    for (auto & f : fonts)
+    {
+        std::string id = upper(f.name);
+        fprintf(fp, "#define %s_ADDR      0x%04x\n", id.c_str(), f.offset);
+        fprintf(fp, "#define %s_TILE_CTRL 0x%04x\n", id.c_str(), f.offset | (f.height - 1));
+        fprintf(fp, "#define %s_HEIGHT    %d\n", id.c_str(), f.height);
+        fprintf(fp, "#define %s_GLYPHS    %d\n\n", id.c_str(), f.glyphs);
+    }
+    fprintf(fp, "// proportional metrics per glyph: (left blank columns << 4) | ink width in pixels (0 for blank glyph,\n");
+    fprintf(fp, "// e.g., space, where the renderer should use its own advance)\n");
+    for (auto & f : fonts)
+    {
+        fprintf(fp, "static const uint8_t %s_metrics[%d] = {", f.name.c_str(), f.glyphs);
+        for (int g = 0; g < f.glyphs; g++)
         {
-            printf("*** Unable to open write to output file\n");
+            fprintf(fp, "%s0x%02x%s", (g % 16) ? " " : "\n    ", f.metrics[g], g + 1 < f.glyphs ? "," : "");
         }
+        fprintf(fp, "\n};\n");
     }
+    fprintf(fp, "\n#endif        // %s\n", guard.c_str());
 
-    if (image)
+    if (fclose(fp) != 0)
     {
-        SDL_FreeSurface(image);
+        printf("*** Failed to write \"%s\"\n", filename);
+        return false;
     }
-    SDL_DestroyWindow(window);
 
-    IMG_Quit();
-    SDL_Quit();
-
-    return 0;
+    return true;
 }
 
-Uint32 getpixel(SDL_Surface * surface, int x, int y)
+// pack fonts into "<out_base>.raw" tile memory image (big-endian words) and write "<out_base>.h" index and metrics
+bool write_tile_image(const std::vector<char *> & font_names, const char * out_base)
 {
-    int bpp = surface->format->BytesPerPixel;
-    /* Here p is the address to the pixel we want to retrieve */
-    Uint8 * p = (Uint8 *)surface->pixels + y * surface->pitch + x * bpp;
+    std::vector<tile_font_t> fonts;
+    std::vector<uint16_t>    mem;
 
-    switch (bpp)
+    for (auto fn : font_names)
     {
-        case 1:
-            return *p;
-            break;
+        uint8_t *   bits   = nullptr;
+        int         w      = 0;
+        int         h      = 0;
+        int         height = 0;
+        std::string error;
+        if (!load_font(fn, font_height, &bits, &w, &h, &height, &error))
+        {
+            printf("*** \"%s\": %s\n", fn, error.c_str());
+            free(bits);
+            return false;
+        }
 
-        case 2:
-            return *(Uint16 *)p;
-            break;
+        tile_font_t font;
+        font.name   = font_ident(fn);
+        font.offset = static_cast<int>(mem.size());
+        font.height = height;
+        font.glyphs = (w / GLYPH_WIDTH) * (h / height);
+        if (font.glyphs > TILE_MAX_GLYPHS)
+        {
+            printf("NOTE: \"%s\" has %d glyphs, only first %d used\n", fn, font.glyphs, TILE_MAX_GLYPHS);
+            font.glyphs = TILE_MAX_GLYPHS;
+        }
+        for (auto & f : fonts)
+        {
+            if (f.name == font.name)
+            {
+                font.name += "_" + std::to_string(fonts.size());
+                break;
+            }
+        }
+        font.metrics.resize(font.glyphs, 0);
+
+        int words = font.glyphs * (height / 2);
+        mem.resize(mem.size() + (words + TILE_BASE_ALIGN - 1) / TILE_BASE_ALIGN * TILE_BASE_ALIGN, 0);
+        pack_font(bits, w, h, &font, &mem);
+        free(bits);
+
+        printf("0x%04x: \"%s\" as %s, %d 8x%d glyphs (%d words)\n",
+               font.offset,
+               fn,
+               font.name.c_str(),
+               font.glyphs,
+               height,
+               words);
+        fonts.push_back(font);
+    }
 
-        case 3:
-            if (SDL_BYTEORDER == SDL_BIG_ENDIAN)
-                return p[0] << 16 | p[1] << 8 | p[2];
-            else
-                return p[0] | p[1] << 8 | p[2] << 16;
-            break;
+    // last font only needs its glyph words (no padding to next tile base)
+    const tile_font_t & last  = fonts.back();
+    int                 total = last.offset + last.glyphs * (last.height / 2);
+    if (total > TILE_MEM_WORDS)
+    {
+        printf("*** Fonts need %d words, more than %d words of tile memory\n", total, TILE_MEM_WORDS);
+        return false;
+    }
 
-        case 4:
-            return *(Uint32 *)p;
-            break;
+    std::string raw_name    = std::string(out_base) + ".raw";
+    std::string header_name = std::string(out_base) + ".h";
+    FILE *      fp          = fopen(raw_name.c_str(), "wb");
+    if (fp == nullptr)
+    {
+        printf("*** Unable to open write to output file \"%s\"\n", raw_name.c_str());
+        return false;
+    }
+    bool good = true;
+    for (int i = 0; i < total && good; i++)
+    {
+        uint8_t word[2] = {static_cast<uint8_t>(mem[i] >> 8), static_cast<uint8_t>(mem[i])};        // big-endian
+        good            = fwrite(word, sizeof(word), 1, fp) == 1;
+    }
+    good = (fclose(fp) == 0) && good;
+    if (!good)
+    {
+        printf("*** Failed to write \"%s\"\n", raw_name.c_str());
+        return false;
+    }
 
-        default:
-            return 0; /* shouldn't happen, but avoids warnings */
+    const char * raw_base = strrchr(raw_name.c_str(), '/');
+    if (!write_tile_header(header_name.c_str(), raw_base ? raw_base + 1 : raw_name.c_str(), out_base, fonts, total))
+    {
+        return false;
     }
+
+    printf("Wrote \"%s\" (%d of %d tile memory words) and \"%s\".\n",
+           raw_name.c_str(),
+           total,
+           TILE_MEM_WORDS,
+           header_name.c_str());
+
+    return true;
 }
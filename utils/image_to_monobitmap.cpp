@@ -8,13 +8,22 @@
 
 #include <algorithm>
 
+#include "batch_convert.h"
+#include "color_lut.h"
+#include "image_rgba.h"
+#include "xosera_rle.h"
+
 bool   word_mode = false;
 bool   c_mode    = false;
 bool   invert    = false;
 bool   monocolor = false;
 bool   color16   = false;
+bool   compress  = false;        // write word RLE compressed (see xosera_rle.h)
 char * in_file   = nullptr;
 char * out_file  = nullptr;
+char * batch     = nullptr;        // manifest file or glob pattern for batch mode
+char * out_dir   = nullptr;        // batch output directory
+int    threads   = 0;              // batch worker threads (0 = one per CPU)
 
 int     out_width  = 640;
 int     out_height = 480;
@@ -37,10 +46,12 @@ uint16_t palette[16] = {0x0000,
                         0x0FF5,
                         0x0FFF};
 
-Uint32 getpixel(SDL_Surface * surface, int x, int y);
+color_lut_t palette_lut;        // nearest palette color for each 12-bit color
 
 void matchmonocolors(uint8_t *& ptr, const SDL_Color rgb[8]);
 void matchcolors(uint8_t *& ptr, const SDL_Color * rgb);
+bool write_bitmap(const image_rgba_t * rgba, const char * out_name, std::string * error);
+bool convert_file(const char * in_name, const char * out_name, std::string * error);
 
 int main(int argc, char ** argv)
 {
@@ -68,6 +79,22 @@ int main(int argc, char ** argv)
             {
                 out_width = 848;
             }
+            else if (strcmp("-z", argv[a]) == 0)
+            {
+                compress = true;
+            }
+            else if (strcmp("-B", argv[a]) == 0 && a + 1 < argc)
+            {
+                batch = argv[++a];
+            }
+            else if (strcmp("-o", argv[a]) == 0 && a + 1 < argc)
+            {
+                out_dir = argv[++a];
+            }
+            else if (strcmp("-j", argv[a]) == 0 && a + 1 < argc)
+            {
+                threads = atoi(argv[++a]);
+            }
             else
             {
                 printf("Unexpected option: '%s'\n", argv[a]);
@@ -92,14 +119,37 @@ int main(int argc, char ** argv)
         }
     }
 
-    if (!in_file || !out_file)
+    if (!batch && (!in_file || !out_file))
     {
         printf("image_to_mem: Convert image to monochome bitmap file.\n");
         printf("Usage:  image_to_mem <input font image> <output font mem> [-i]\n");
+        printf("        image_to_mem -B <manifest | \"glob\"> [-o <dir>] [-j <threads>] [-i]\n");
         printf("   -i   Invert pixels\n");
+        printf("   -z   Write word RLE compressed output (\".xrle\" extension in batch mode)\n");
+        printf("   -B   Batch convert images in manifest (\"<input> [output]\" lines) or glob, without window\n");
+        printf("   -o   Batch output directory (default is beside input, with \".raw\" extension)\n");
+        printf("   -j   Batch worker threads (default one per CPU)\n");
         exit(EXIT_FAILURE);
     }
 
+    if (batch)
+    {
+        std::vector<batch_item_t> items;
+        color_lut_build(&palette_lut, palette, sizeof(palette) / sizeof(palette[0]));
+        IMG_Init(IMG_INIT_PNG);
+
+        int failed = -1;
+        if (batch_add_items(&items, batch, out_dir, compress ? ".xrle" : ".raw"))
+        {
+            failed = batch_convert(&items, convert_file, threads);
+        }
+
+        IMG_Quit();
+        SDL_Quit();
+
+        return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     printf("Input image file     : \"%s\"\n", in_file);
     printf("Output monochrome bitmap file : \"%s\"\n", out_file);
     if (invert)
@@ -118,6 +168,8 @@ int main(int argc, char ** argv)
 
     bool quit = false;
 
+    color_lut_build(&palette_lut, palette, sizeof(palette) / sizeof(palette[0]));
+
     SDL_Init(SDL_INIT_VIDEO);
     IMG_Init(IMG_INIT_PNG);
 
@@ -139,6 +191,7 @@ int main(int argc, char ** argv)
     }
 
     SDL_Surface * image = IMG_Load(in_file);
+    image_rgba_t  rgba  = {};
 
     int w = 0;
     int h = 0;
@@ -148,6 +201,11 @@ int main(int argc, char ** argv)
         printf("*** Unable to load \"%s\"\n", in_file);
         quit = true;
     }
+    else if (!image_rgba_init(&rgba, image))
+    {
+        printf("*** Unable to convert \"%s\" to RGBA8888: %s\n", in_file, SDL_GetError());
+        quit = true;
+    }
     else
     {
         w = image->w;
@@ -192,85 +250,21 @@ int main(int argc, char ** argv)
         }
     }
 
-    while (!quit)
+    if (!quit)
     {
-        int       out_size   = color16 ? (out_width / 2) * out_height : (out_width / 8) * 2 * out_height;
-        uint8_t * out_pixels = (uint8_t *)malloc(out_size);
-
-        if (!out_pixels)
+        std::string error;
+        printf("Writing output: \"%s\" %d x %d...\n", out_file, out_width, out_height);
+        if (write_bitmap(&rgba, out_file, &error))
         {
-            printf("OOM!\n");
-            break;
-        }
-
-        memset(out_pixels, 0, out_size);
-        uint8_t * pptr = out_pixels;
-
-        FILE * fp = fopen(out_file, "w");
-        if (fp != nullptr)
-        {
-            printf("Writing output: \"%s\" %d x %d...\n", out_file, out_width, out_height);
-
-            for (int y = 0; y < out_height; y++)
-            {
-                for (int x = 0; x < out_width; x += 8)
-                {
-                    uint16_t  val            = 0;
-                    SDL_Color byte_pixels[8] = {};
-                    if (y < h && x < w)
-                    {
-                        for (int b = 0; b < 8; b++)
-                        {
-                            SDL_Color rgb;
-                            Uint32    data = getpixel(image, x + b, y);
-                            SDL_GetRGB(data, image->format, &rgb.r, &rgb.g, &rgb.b);
-                            byte_pixels[b] = rgb;
-                            int v          = (rgb.r + rgb.g + rgb.b) / 3;
-
-                            bool pixel = (v >= 128);
-                            if (invert)
-                            {
-                                pixel = !pixel;
-                            }
-
-                            if (pixel)
-                            {
-                                val |= (0x80 >> b);
-                            }
-                        }
-                    }
-                    if (color16)
-                    {
-                        matchcolors(pptr, &byte_pixels[4]);
-                        matchcolors(pptr, &byte_pixels[0]);
-                    }
-                    else if (monocolor)
-                    {
-                        matchmonocolors(pptr, byte_pixels);
-                    }
-                    else
-                    {
-                        // big-endian!
-                        *pptr++ = val;
-                        *pptr++ = color_byte;
-                    }
-                }
-            }
-
-            bool good = (fwrite(out_pixels, out_size, 1, fp) == 1);
-
-            fclose(fp);
-
-            printf(good ? "Success.\n" : "Failed to write");
+            printf("Success.\n");
         }
         else
         {
-            printf("*** Unable to open write to output file\n");
+            printf("*** %s\n", error.c_str());
         }
-
-        break;
     }
 
+    image_rgba_free(&rgba);
     if (image)
     {
         SDL_FreeSurface(image);
@@ -283,38 +277,6 @@ int main(int argc, char ** argv)
     return 0;
 }
 
-Uint32 getpixel(SDL_Surface * surface, int x, int y)
-{
-    int bpp = surface->format->BytesPerPixel;
-    /* Here p is the address to the pixel we want to retrieve */
-    Uint8 * p = (Uint8 *)surface->pixels + y * surface->pitch + x * bpp;
-
-    switch (bpp)
-    {
-        case 1:
-            return *p;
-            break;
-
-        case 2:
-            return *(Uint16 *)p;
-            break;
-
-        case 3:
-            if (SDL_BYTEORDER == SDL_BIG_ENDIAN)
-                return p[0] << 16 | p[1] << 8 | p[2];
-            else
-                return p[0] | p[1] << 8 | p[2] << 16;
-            break;
-
-        case 4:
-            return *(Uint32 *)p;
-            break;
-
-        default:
-            return 0; /* shouldn't happen, but avoids warnings */
-    }
-}
-
 void matchmonocolors(uint8_t *& ptr, const SDL_Color rgb[8])
 {
     SDL_Color qrgb[8]  = {};
@@ -342,21 +304,8 @@ void matchmonocolors(uint8_t *& ptr, const SDL_Color rgb[8])
 
     for (int b = 0; b < 8; b++)
     {
-        int best      = -1;
-        int best_dist = 99999;
-        for (int c = 0; c < 16; c++)
-        {
-            int dist = (((palette[c] & 0xf00) >> 8) - qrgb[b].r) * (((palette[c] & 0xf00) >> 8) - qrgb[b].r) +
-                       (((palette[c] & 0x0f0) >> 4) - qrgb[b].g) * (((palette[c] & 0x0f0) >> 4) - qrgb[b].g) +
-                       (((palette[c] & 0x00f) >> 0) - qrgb[b].b) * (((palette[c] & 0x00f) >> 0) - qrgb[b].b);
-
-            if (dist < best_dist)
-            {
-                best      = c;
-                best_dist = dist;
-            }
-        }
-        irgb[b] = best;
+        int best = color_lut_match(&palette_lut, qrgb[b].r, qrgb[b].g, qrgb[b].b);
+        irgb[b]  = best;
         icnt[best] += 1;
     }
 
@@ -423,23 +372,138 @@ void matchcolors(uint8_t *& ptr, const SDL_Color * rgb)
 
     for (int b = 0; b < 4; b++)
     {
-        int best      = -1;
-        int best_dist = 99999;
-        for (int c = 0; c < 16; c++)
+        irgb[b] = color_lut_match(&palette_lut, qrgb[b].r, qrgb[b].g, qrgb[b].b);
+    }
+
+    *ptr++ = ((irgb[0] & 0xf) << 4) | irgb[1];
+    *ptr++ = ((irgb[2] & 0xf) << 4) | irgb[3];
+}
+
+// write rgba image as Xosera bitmap (using global options), returns false and sets error on failure
+bool write_bitmap(const image_rgba_t * rgba, const char * out_name, std::string * error)
+{
+    int w = rgba->w;
+    int h = rgba->h;
+
+    int       out_size   = color16 ? (out_width / 2) * out_height : (out_width / 8) * 2 * out_height;
+    uint8_t * out_pixels = static_cast<uint8_t *>(calloc(out_size, 1));
+    uint8_t * row_bits   = static_cast<uint8_t *>(malloc(w > 0 ? w : 1));
+
+    if (!out_pixels || !row_bits)
+    {
+        free(out_pixels);
+        free(row_bits);
+        *error = "OOM!";
+        return false;
+    }
+
+    uint8_t * pptr = out_pixels;
+
+    for (int y = 0; y < out_height; y++)
+    {
+        const rgba_t * row = y < h ? image_rgba_row(rgba, y) : nullptr;
+        if (row)
+        {
+            image_rgba_threshold_row(row, row_bits, w, invert);
+        }
+
+        for (int x = 0; x < out_width; x += 8)
         {
-            int dist = (((palette[c] & 0xf00) >> 8) - qrgb[b].r) * (((palette[c] & 0xf00) >> 8) - qrgb[b].r) +
-                       (((palette[c] & 0x0f0) >> 4) - qrgb[b].g) * (((palette[c] & 0x0f0) >> 4) - qrgb[b].g) +
-                       (((palette[c] & 0x00f) >> 0) - qrgb[b].b) * (((palette[c] & 0x00f) >> 0) - qrgb[b].b);
+            uint16_t  val            = 0;
+            SDL_Color byte_pixels[8] = {};
+            if (row && x < w)
+            {
+                for (int b = 0; b < 8; b++)
+                {
+                    byte_pixels[b].r = row[x + b].r;
+                    byte_pixels[b].g = row[x + b].g;
+                    byte_pixels[b].b = row[x + b].b;
+                    byte_pixels[b].a = row[x + b].a;
 
-            if (dist < best_dist)
+                    if (row_bits[x + b])
+                    {
+                        val |= (0x80 >> b);
+                    }
+                }
+            }
+            if (color16)
             {
-                best      = c;
-                best_dist = dist;
+                matchcolors(pptr, &byte_pixels[4]);
+                matchcolors(pptr, &byte_pixels[0]);
+            }
+            else if (monocolor)
+            {
+                matchmonocolors(pptr, byte_pixels);
+            }
+            else
+            {
+                // big-endian!
+                *pptr++ = val;
+                *pptr++ = color_byte;
             }
         }
-        irgb[b] = best;
     }
 
-    *ptr++ = ((irgb[0] & 0xf) << 4) | irgb[1];
-    *ptr++ = ((irgb[2] & 0xf) << 4) | irgb[3];
-}
\ No newline at end of file
+    free(row_bits);
+
+    const uint8_t *      out_data = out_pixels;
+    std::vector<uint8_t> xrle;
+    if (compress)
+    {
+        xrle.resize(XRLE_MAX_BYTES(out_size / 2));
+        xrle.resize(xrle_encode(out_data, out_size & ~1, xrle.data()));
+        out_data = xrle.data();
+        out_size = static_cast<int>(xrle.size());
+    }
+
+    bool   good = false;
+    FILE * fp   = fopen(out_name, "w");
+    if (fp != nullptr)
+    {
+        good = (fwrite(out_data, out_size, 1, fp) == 1);
+        good = (fclose(fp) == 0) && good;
+        if (!good)
+        {
+            *error = std::string("Failed to write \"") + out_name + "\"";
+        }
+    }
+    else
+    {
+        *error = std::string("Unable to open write to output file \"") + out_name + "\"";
+    }
+
+    free(out_pixels);
+
+    return good;
+}
+
+// batch mode conversion of one image file (no window)
+bool convert_file(const char * in_name, const char * out_name, std::string * error)
+{
+    SDL_Surface * image = IMG_Load(in_name);
+    if (!image)
+    {
+        *error = std::string("Unable to load: ") + SDL_GetError();
+        return false;
+    }
+
+    image_rgba_t rgba = {};
+    bool         good = false;
+    if (!image_rgba_init(&rgba, image))
+    {
+        *error = std::string("Unable to convert to RGBA8888: ") + SDL_GetError();
+    }
+    else if ((rgba.w & 0x7) != 0)
+    {
+        *error = "Unsupported image size (width should be multiple of 8)";
+    }
+    else
+    {
+        good = write_bitmap(&rgba, out_name, error);
+    }
+
+    image_rgba_free(&rgba);
+    SDL_FreeSurface(image);
+
+    return good;
+}
@@ -0,0 +1,504 @@
+// Quick & Dirty PNG to Xosera tile set and tilemap converter
+// Xark - 2021
+// See top-level LICENSE file for license information. (Hint: MIT)
+//
+// Slices an image into tiles, keeps only unique tiles (a tile that matches another mirrored horizontally and/or
+// vertically, or in 1-bpp mode with fore/back colors swapped, reuses it with the tilemap attribute bits) and writes:
+//
+//   "<basename>_tiles.raw"    tile definitions, laid out as Xosera fetches them from tile memory (or VRAM)
+//   "<basename>_map.raw"      tilemap words (attributes and tile index, row by row)
+//   "<basename>_pal.raw"      palette (only for indexed color images)
+//
+// Tile formats (see calc_tile_addr in video_playfield.sv):
+//   1-bpp   8x8 (4 words) or 8x16 (8 words), 1 byte per line (even line in high byte), 8-bit index, attribute
+//           forecolor in bits [11:8] and backcolor in [15:12], no mirroring
+//   4-bpp   8x8 (16 words), 2 words per line (left pixel in high nibble), 10-bit index, V mirror bit 10, H mirror bit
+//           11 and upper 4 bits of color index in [15:12]
+//   8-bpp   8x8 (32 words), 4 words per line (left pixel in high byte), 10-bit index, V mirror bit 10, H mirror bit 11
+//
+// Indexed color images use their pixel indices, other images are matched to the closest color in the palette
+// (default Xosera 16 color palette or "-p <file_pal.raw>"), 1-bpp uses average brightness.
+#include <SDL.h>
+#include <SDL_image.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "color_lut.h"
+#include "image_rgba.h"
+
+#define TILE_W          8             // tiles are always 8 pixels wide
+#define TILE_MEM_WORDS  5120          // XR tile memory size (tilemem.sv)
+#define ATTR_VREV       (1 << 10)     // tilemap mirror tile vertically (not in 1-bpp)
+#define ATTR_HREV       (1 << 11)     // tilemap mirror tile horizontally (not in 1-bpp)
+
+int          bpp        = 4;              // 1, 4 or 8
+int          tile_h     = 8;              // 8 or 16 (16 only in 1-bpp)
+bool         mirror     = true;           // allow mirrored tile matches
+bool         invert     = false;          // 1-bpp invert pixels
+uint8_t      attr_1bpp  = 0x0F;           // 1-bpp tilemap attribute (backcolor << 4 | forecolor)
+int          first_tile = 0;              // first tile index (e.g., to share tile memory with a font)
+char *       in_file    = nullptr;
+char *       out_file   = nullptr;
+char *       pal_file   = nullptr;        // palette for matching non-indexed images
+
+uint16_t palette[256] = {0x0000,
+                         0x000A,
+                         0x00A0,
+                         0x00AA,
+                         0x0A00,
+                         0x0A0A,
+                         0x0AA0,
+                         0x0AAA,
+                         0x0555,
+                         0x055F,
+                         0x05F5,
+                         0x05FF,
+                         0x0F55,
+                         0x0F5F,
+                         0x0FF5,
+                         0x0FFF};
+int      num_colors   = 16;
+bool     indexed      = false;        // palette came from image
+
+color_lut_t palette_lut;        // nearest palette color for each 12-bit color
+
+typedef std::vector<uint8_t> tile_t;        // 8 x tile_h pixel indices (0 or 1 in 1-bpp)
+
+static bool load_palette(const char * filename)
+{
+    FILE * fp = fopen(filename, "rb");
+    if (fp == nullptr)
+    {
+        printf("*** Unable to open palette \"%s\" ", filename);
+        perror("error");
+        return false;
+    }
+
+    uint8_t pal_bytes[256 * 2];
+    int     n = static_cast<int>(fread(pal_bytes, 2, 256, fp));
+    fclose(fp);
+    if (n < 1)
+    {
+        printf("*** Palette \"%s\" is empty\n", filename);
+        return false;
+    }
+    for (int c = 0; c < n; c++)
+    {
+        palette[c] = ((pal_bytes[c * 2] << 8) | pal_bytes[c * 2 + 1]) & 0x0FFF;        // big-endian 0xRGB
+    }
+    num_colors = n;
+
+    return true;
+}
+
+// get image as one pixel index per byte (padded to whole tiles with index 0), returns false on failure
+static bool image_pixels(SDL_Surface * image, int pad_w, int pad_h, std::vector<uint8_t> * pixels)
+{
+    int w = image->w;
+    int h = image->h;
+    pixels->assign(pad_w * pad_h, 0);
+
+    if (bpp != 1 && image->format->BytesPerPixel == 1 && image->format->palette)
+    {
+        // indexed image, use pixel values (and image palette)
+        SDL_Palette * pal = image->format->palette;
+        num_colors        = pal->ncolors < 256 ? pal->ncolors : 256;
+        for (int c = 0; c < num_colors; c++)
+        {
+            const SDL_Color & col = pal->colors[c];
+            palette[c]            = static_cast<uint16_t>(((col.r >> 4) << 8) | ((col.g >> 4) << 4) | (col.b >> 4));
+        }
+        indexed = true;
+
+        for (int y = 0; y < h; y++)
+        {
+            const uint8_t * row = static_cast<const uint8_t *>(image->pixels) + y * image->pitch;
+            memcpy(&(*pixels)[y * pad_w], row, w);
+        }
+
+        return true;
+    }
+
+    image_rgba_t rgba;
+    if (!image_rgba_init(&rgba, image))
+    {
+        printf("*** Unable to convert \"%s\" to RGBA8888: %s\n", in_file, SDL_GetError());
+        return false;
+    }
+
+    if (bpp == 1)
+    {
+        for (int y = 0; y < h; y++)
+        {
+            image_rgba_threshold_row(image_rgba_row(&rgba, y), &(*pixels)[y * pad_w], w, invert);
+        }
+    }
+    else
+    {
+        color_lut_build(&palette_lut, palette, num_colors);
+        for (int y = 0; y < h; y++)
+        {
+            const rgba_t * row = image_rgba_row(&rgba, y);
+            for (int x = 0; x < w; x++)
+            {
+                (*pixels)[y * pad_w + x] = color_lut_match(&palette_lut, row[x].r >> 4, row[x].g >> 4, row[x].b >> 4);
+            }
+        }
+    }
+    image_rgba_free(&rgba);
+
+    return true;
+}
+
+static tile_t flip_tile(const tile_t & tile, bool hrev, bool vrev)
+{
+    tile_t out(tile.size());
+    for (int y = 0; y < tile_h; y++)
+    {
+        for (int x = 0; x < TILE_W; x++)
+        {
+            out[y * TILE_W + x] = tile[(vrev ? tile_h - 1 - y : y) * TILE_W + (hrev ? TILE_W - 1 - x : x)];
+        }
+    }
+
+    return out;
+}
+
+static tile_t invert_tile(const tile_t & tile)
+{
+    tile_t out(tile.size());
+    for (size_t i = 0; i < tile.size(); i++)
+    {
+        out[i] = tile[i] ^ 1;
+    }
+
+    return out;
+}
+
+// append tile definition words (big-endian) in Xosera tile memory layout
+static void put_tile(std::vector<uint8_t> * out, const tile_t & tile)
+{
+    for (int y = 0; y < tile_h; y++)
+    {
+        const uint8_t * p = &tile[y * TILE_W];
+        switch (bpp)
+        {
+            case 1: {
+                uint8_t byte = 0;
+                for (int x = 0; x < TILE_W; x++)
+                {
+                    byte |= (p[x] & 1) << (7 - x);
+                }
+                out->push_back(byte);        // even line high byte, odd line low byte
+                break;
+            }
+            case 4:
+                for (int x = 0; x < TILE_W; x += 2)
+                {
+                    out->push_back(((p[x] & 0xf) << 4) | (p[x + 1] & 0xf));
+                }
+                break;
+            default:
+                out->insert(out->end(), p, p + TILE_W);
+                break;
+        }
+    }
+}
+
+static bool write_file(const std::string & name, const std::vector<uint8_t> & data)
+{
+    FILE * fp = fopen(name.c_str(), "wb");
+    if (fp == nullptr)
+    {
+        printf("*** Unable to open \"%s\" ", name.c_str());
+        perror("error");
+        return false;
+    }
+    bool good = data.empty() || fwrite(data.data(), data.size(), 1, fp) == 1;
+    good      = (fclose(fp) == 0) && good;
+    if (!good)
+    {
+        printf("*** Failed writing \"%s\"\n", name.c_str());
+    }
+
+    return good;
+}
+
+int main(int argc, char ** argv)
+{
+    printf("Xosera image to tile set and tilemap utility - Xark\n\n");
+
+    for (int a = 1; a < argc; a++)
+    {
+        if (argv[a][0] == '-')
+        {
+            if (strcmp("-1", argv[a]) == 0)
+            {
+                bpp = 1;
+            }
+            else if (strcmp("-4", argv[a]) == 0)
+            {
+                bpp = 4;
+            }
+            else if (strcmp("-8", argv[a]) == 0)
+            {
+                bpp = 8;
+            }
+            else if (strcmp("-16", argv[a]) == 0)
+            {
+                tile_h = 16;
+            }
+            else if (strcmp("-n", argv[a]) == 0)
+            {
+                mirror = false;
+            }
+            else if (strcmp("-i", argv[a]) == 0)
+            {
+                invert = true;
+            }
+            else if (strcmp("-a", argv[a]) == 0 && a + 1 < argc)
+            {
+                attr_1bpp = static_cast<uint8_t>(strtoul(argv[++a], nullptr, 0));
+            }
+            else if (strcmp("-f", argv[a]) == 0 && a + 1 < argc)
+            {
+                first_tile = static_cast<int>(strtoul(argv[++a], nullptr, 0));
+            }
+            else if (strcmp("-p", argv[a]) == 0 && a + 1 < argc)
+            {
+                pal_file = argv[++a];
+            }
+            else
+            {
+                printf("Unexpected option: '%s'\n", argv[a]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else
+        {
+            if (!in_file)
+            {
+                in_file = argv[a];
+            }
+            else if (!out_file)
+            {
+                out_file = argv[a];
+            }
+            else
+            {
+                printf("Unexpected extra argument: '%s'\n", argv[a]);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    if (!in_file || !out_file)
+    {
+        printf("image_to_tiles: Convert image to unique tile set and tilemap.\n");
+        printf("Usage:  image_to_tiles <input image> <output basename> [options]\n");
+        printf("        (will create \"<basename>_tiles.raw\", \"<basename>_map.raw\" and for indexed images\n");
+        printf("         \"<basename>_pal.raw\")\n");
+        printf("   -1   1-bpp tiles (fore/back color attribute)\n");
+        printf("   -4   4-bpp tiles (default)\n");
+        printf("   -8   8-bpp tiles\n");
+        printf("   -16  8x16 tiles (1-bpp only, default 8x8)\n");
+        printf("   -n   No mirrored (or 1-bpp inverted) tile matching\n");
+        printf("   -i   Invert pixels (1-bpp)\n");
+        printf("   -a <attr>  1-bpp attribute byte, backcolor << 4 | forecolor (default 0x0F)\n");
+        printf("   -f <index> First tile index (default 0)\n");
+        printf("   -p <file_pal.raw>  Palette to match non-indexed images (default 16 color palette)\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (tile_h == 16 && bpp != 1)
+    {
+        printf("*** 8x16 tiles are only supported in 1-bpp mode.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (pal_file && !load_palette(pal_file))
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    const int max_index  = (bpp == 1) ? 256 : 1024;
+    const int tile_words = (bpp == 1) ? tile_h / 2 : (bpp == 4) ? 16 : 32;
+
+    IMG_Init(IMG_INIT_PNG);
+
+    SDL_Surface * image = IMG_Load(in_file);
+    if (!image)
+    {
+        printf("*** Unable to load \"%s\": %s\n", in_file, SDL_GetError());
+        IMG_Quit();
+        exit(EXIT_FAILURE);
+    }
+
+    int                  map_w = (image->w + TILE_W - 1) / TILE_W;
+    int                  map_h = (image->h + tile_h - 1) / tile_h;
+    std::vector<uint8_t> pixels;
+    bool                 ok = image_pixels(image, map_w * TILE_W, map_h * tile_h, &pixels);
+    int                  img_w = image->w;
+    int                  img_h = image->h;
+    SDL_FreeSurface(image);
+    IMG_Quit();
+    if (!ok)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    printf("Input image          : \"%s\" %dx%d, %s\n",
+           in_file,
+           img_w,
+           img_h,
+           bpp == 1 ? "1-bpp" : (indexed ? "indexed color" : "matched to palette"));
+    printf("Tiles                : 8x%d %d-bpp, %dx%d tilemap\n", tile_h, bpp, map_w, map_h);
+
+    std::map<tile_t, int> unique;        // tile pixels to tile index
+    std::vector<uint8_t>  tile_data;
+    std::vector<uint8_t>  map_data;
+    int                   num_unique = 0;
+    int                   num_mirror = 0;
+    int                   num_banks  = 0;
+
+    for (int ty = 0; ty < map_h; ty++)
+    {
+        for (int tx = 0; tx < map_w; tx++)
+        {
+            tile_t tile(TILE_W * tile_h);
+            for (int y = 0; y < tile_h; y++)
+            {
+                memcpy(&tile[y * TILE_W], &pixels[(ty * tile_h + y) * map_w * TILE_W + tx * TILE_W], TILE_W);
+            }
+
+            uint16_t attr = 0;
+            if (bpp == 4)
+            {
+                // upper 4 bits of color index come from tilemap attribute
+                uint8_t bank = tile[0] & 0xf0;
+                for (auto & p : tile)
+                {
+                    if ((p & 0xf0) != bank)
+                    {
+                        printf("*** Tile at %d, %d uses colors from more than one 16 color bank\n",
+                               tx * TILE_W,
+                               ty * tile_h);
+                        exit(EXIT_FAILURE);
+                    }
+                    p &= 0x0f;
+                }
+                attr = bank << 8;
+                if (bank)
+                {
+                    num_banks++;
+                }
+            }
+            else if (bpp == 1)
+            {
+                attr = attr_1bpp << 8;
+            }
+
+            // look for identical (or mirrored/inverted) tile already in set
+            int index = -1;
+            if (unique.count(tile))
+            {
+                index = unique[tile];
+            }
+            else if (mirror && bpp != 1)
+            {
+                static const uint16_t flip_attr[3] = {ATTR_HREV, ATTR_VREV, ATTR_HREV | ATTR_VREV};
+                for (int f = 0; f < 3 && index < 0; f++)
+                {
+                    auto it = unique.find(flip_tile(tile, flip_attr[f] & ATTR_HREV, flip_attr[f] & ATTR_VREV));
+                    if (it != unique.end())
+                    {
+                        index = it->second;
+                        attr |= flip_attr[f];
+                        num_mirror++;
+                    }
+                }
+            }
+            else if (mirror && bpp == 1)
+            {
+                auto it = unique.find(invert_tile(tile));
+                if (it != unique.end())
+                {
+                    index = it->second;
+                    attr  = static_cast<uint16_t>(((attr_1bpp & 0x0f) << 12) | ((attr_1bpp & 0xf0) << 4));
+                    num_mirror++;
+                }
+            }
+
+            if (index < 0)
+            {
+                index        = first_tile + num_unique++;
+                unique[tile] = index;
+                put_tile(&tile_data, tile);
+            }
+
+            uint16_t word = attr | (index & (max_index - 1));
+            map_data.push_back(word >> 8);
+            map_data.push_back(word & 0xff);
+        }
+    }
+
+    int bitmap_words = map_w * TILE_W * map_h * tile_h * (bpp == 1 ? 2 : bpp) / 16;
+    int set_words    = num_unique * tile_words;
+    int map_words    = map_w * map_h;
+    int set_addr     = first_tile * tile_words;
+
+    printf("Unique tiles         : %d of %d (%d matched %s)\n",
+           num_unique,
+           map_w * map_h,
+           num_mirror,
+           bpp == 1 ? "inverted" : "mirrored");
+    if (bpp == 4 && num_banks)
+    {
+        printf("Color bank attribute : %d tiles use colors above 15\n", num_banks);
+    }
+    printf("Tile set             : %d words (%d bytes)\n", set_words, set_words * 2);
+    printf("Tilemap              : %d words (%d bytes)\n", map_words, map_words * 2);
+    printf("Bitmap equivalent    : %d words (%d bytes)\n", bitmap_words, bitmap_words * 2);
+    printf("Memory/upload saving : %d words (%.1f%%)\n",
+           bitmap_words - (set_words + map_words),
+           bitmap_words ? 100.0 * (bitmap_words - (set_words + map_words)) / bitmap_words : 0.0);
+    printf("Tile memory          : %d of %d words used (%s)\n",
+           set_addr + set_words,
+           TILE_MEM_WORDS,
+           (set_addr + set_words <= TILE_MEM_WORDS) ? "fits in XR tile memory" : "too big for XR tile memory, use VRAM");
+    printf("Tile set address     : tile base + 0x%04x, Px_TILE_CTRL tile height 0x%x\n", set_addr, tile_h - 1);
+
+    if (first_tile + num_unique > max_index)
+    {
+        printf("*** %d tiles exceeds %d-bpp tile index limit of %d.\n", first_tile + num_unique, bpp, max_index);
+        exit(EXIT_FAILURE);
+    }
+
+    std::string base(out_file);
+    if (!write_file(base + "_tiles.raw", tile_data) || !write_file(base + "_map.raw", map_data))
+    {
+        exit(EXIT_FAILURE);
+    }
+    if (indexed)
+    {
+        std::vector<uint8_t> pal_data;
+        for (int c = 0; c < num_colors; c++)
+        {
+            pal_data.push_back(palette[c] >> 8);        // big-endian
+            pal_data.push_back(palette[c] & 0xff);
+        }
+        if (!write_file(base + "_pal.raw", pal_data))
+        {
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    printf("Wrote \"%s_tiles.raw\", \"%s_map.raw\"%s\n", out_file, out_file, indexed ? " and palette." : ".");
+
+    return EXIT_SUCCESS;
+}
@@ -1,19 +1,107 @@
 // Quick & Dirty PNG to Verilog memb file converter
 // Xark - 2021
 // See top-level LICENSE file for license information. (Hint: MIT)
+#include <ctype.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <string>
+#include <vector>
+
+#include "batch_convert.h"
+
 char * in_file  = nullptr;
 char * out_file = nullptr;
+char * batch    = nullptr;        // manifest file or glob pattern for batch mode
+char * out_dir  = nullptr;        // batch output directory
+int    threads  = 0;              // batch worker threads (0 = one per CPU)
 
+bool round_up = false;
+bool verbose  = true;        // print each color (not in batch mode)
 
-char    line[4096];
-uint8_t out_buffer[128 * 1024];
+static int to_4bit(int v)
+{
+    return round_up ? (v * 15 + 127) / 255 : (v >> 4) & 0xf;
+}
 
-bool round_up = false;
+// convert Gimp palette in_name to big-endian 0x0RGB words in out_name a line at a time, returns false and sets
+// error on failure (and sets num_colors to colors written)
+static bool convert_stream(const char * in_name, const char * out_name, std::string * error, int * num_colors)
+{
+    FILE * fp = fopen(in_name, "r");
+    if (fp == nullptr)
+    {
+        *error = std::string("Unable to open input file \"") + in_name + "\"";
+        return false;
+    }
+    FILE * out_fp = fopen(out_name, "wb");
+    if (out_fp == nullptr)
+    {
+        fclose(fp);
+        *error = std::string("Unable to open output file \"") + out_name + "\"";
+        return false;
+    }
+
+    bool good = true;
+    int  i    = 0;
+    char line[4096];
+    while (good && fgets(line, sizeof(line) - 1, fp) != nullptr)
+    {
+        // skip "GIMP Palette", "Name:", "Columns:" and '#' comment header lines
+        const char * p = line;
+        while (isspace(static_cast<unsigned char>(*p)))
+        {
+            p++;
+        }
+        if (!isdigit(static_cast<unsigned char>(*p)))
+        {
+            continue;
+        }
+
+        int r = 0, g = 0, b = 0;
+        if (sscanf(p, "%d %d %d", &r, &g, &b) != 3 || r > 255 || g > 255 || b > 255)
+        {
+            *error = std::string("Error parsing: ") + line;
+            good   = false;
+            break;
+        }
+
+        if (verbose)
+        {
+            printf("[%02x] R=0x%02x, G=0x%02x, B=0x%02x\n", i, r, g, b);
+        }
+
+        uint8_t word[2] = {static_cast<uint8_t>(to_4bit(r)),        // big-endian 0x0RGB
+                           static_cast<uint8_t>((to_4bit(g) << 4) | to_4bit(b))};
+        good            = fwrite(word, sizeof(word), 1, out_fp) == 1;
+        i++;
+    }
+    fclose(fp);
+    good        = (fclose(out_fp) == 0) && good;
+    *num_colors = i;
+
+    if (good && i == 0)
+    {
+        *error = std::string("No colors in \"") + in_name + "\"";
+        good   = false;
+    }
+    else if (!good && error->empty())
+    {
+        *error = std::string("Failed writing \"") + out_name + "\"";
+    }
+
+    return good;
+}
+
+// batch mode conversion of one file
+bool convert_file(const char * in_name, const char * out_name, std::string * error)
+{
+    int num_colors = 0;
+
+    return convert_stream(in_name, out_name, error, &num_colors);
+}
 
 int main(int argc, char ** argv)
 {
@@ -27,6 +115,18 @@ int main(int argc, char ** argv)
             {
                 round_up = true;
             }
+            else if (strcmp("-B", argv[a]) == 0 && a + 1 < argc)
+            {
+                batch = argv[++a];
+            }
+            else if (strcmp("-o", argv[a]) == 0 && a + 1 < argc)
+            {
+                out_dir = argv[++a];
+            }
+            else if (strcmp("-j", argv[a]) == 0 && a + 1 < argc)
+            {
+                threads = atoi(argv[++a]);
+            }
             else
             {
                 printf("Unexpected option: '%s'\n", argv[a]);
@@ -51,95 +151,53 @@ int main(int argc, char ** argv)
         }
     }
 
-    if (!in_file || !out_file)
+    if (!batch && (!in_file || !out_file))
     {
-        printf("pal_to_raw: Extract low nibble from file\n");
+        printf("pal_to_raw: Convert Gimp palette to Xosera big-endian 0x0RGB words\n");
         printf("Usage:  pal_to_raw <input file> <output file>\n");
+        printf("        pal_to_raw -B <manifest | \"glob\"> [-o <dir>] [-j <threads>]\n");
         printf(" -r   round colors to 4-bit (vs truncate)\n");
+        printf(" -B   Batch convert files in manifest (\"<input> [output]\" lines) or glob\n");
+        printf("      (default output is input name ending \"_pal.raw\")\n");
+        printf(" -o   Batch output directory (default is beside input)\n");
+        printf(" -j   Batch worker threads (default one per CPU)\n");
         exit(EXIT_FAILURE);
     }
 
-    printf("Input gpl file     : \"%s\"\n", in_file);
-    printf("Output raw pal file : \"%s\"\n", out_file);
     if (round_up)
     {
         printf("[Rounding color values to 4-bit]\n");
     }
 
-    size_t in_length = 0;
+    if (batch)
     {
-        FILE * fp = fopen(in_file, "r");
-        if (fp != nullptr)
-        {
-            while (fgets(line, sizeof(line) - 1, fp) != nullptr)
-            {
-                if (line[0] == '#')
-                {
-                    break;
-                }
-            }
-            int i = 0;
-            while (i < 256 && fgets(line, sizeof(line) - 1, fp) != nullptr)
-            {
-                int r = 0, g = 0, b = 0;
-
-                if (sscanf(line, "%u %u %u", &r, &g, &b) != 3)
-                {
-                    printf("error parsing: %s\n", line);
-                    exit(EXIT_FAILURE);
-                }
-
-                printf("[%02x] R=0x%02x, G=0x%02x, B=0x%02x\n", i, r, g, b);
+        std::vector<batch_item_t> items;
+        int                       failed = -1;
 
-                //   *out = (r >> 4) & 0xf;
-
-                i++;
-            }
-            fclose(fp);
-            printf("Success, %zd bytes.\n", in_length);
-        }
-        else
+        verbose = false;
+        if (batch_add_items(&items, batch, out_dir, "_pal.raw"))
         {
-            printf("*** Unable to open input file\n");
-            exit(EXIT_FAILURE);
+            failed = batch_convert(&items, convert_file, threads);
         }
-    }
-#if 0
-    uint8_t * ptr        = out_buffer;
-    size_t    out_length = 0;
-    if (!pal)
-    {
-        for (size_t i = 0; i < in_length; i += 2)
-        {
-            *ptr++ = ((in_buffer[i + 0] & 0xf) << 4) | (in_buffer[i + 1] & 0xf);
-            out_length++;
-        }
-    }
-    else
-    {
-        for (size_t i = 0; i < in_length; i += 3)
-        {
-            *ptr++ = (in_buffer[i + 0] & 0xf);
-            *ptr++ = ((in_buffer[i + 1] & 0xf) << 4) | (in_buffer[i + 2] & 0xf);
-            out_length += 2;
-        }
-    }
 
-    FILE * fp = fopen(out_file, "w");
-    if (fp != nullptr)
-    {
-        printf("Writing output...\n");
-        size_t wrote_length = fwrite(out_buffer, 1, out_length, fp);
+        return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
+    printf("Input gpl file     : \"%s\"\n", in_file);
+    printf("Output raw pal file : \"%s\"\n", out_file);
 
-        fclose(fp);
-        printf("Wrote %zd bytes, %s\n", wrote_length, (wrote_length == out_length) ? "Success" : "Fail");
-    }
-    else
+    std::string error;
+    int         num_colors = 0;
+    if (!convert_stream(in_file, out_file, &error, &num_colors))
     {
-        printf("*** Unable to open to output file\n");
+        printf("*** %s\n", error.c_str());
         exit(EXIT_FAILURE);
     }
-#endif
+    printf("Success, %d colors (%d bytes).\n", num_colors, num_colors * 2);
+    if (num_colors > 256)
+    {
+        printf("NOTE: More than 256 colors (one Xosera color table).\n");
+    }
+
     return EXIT_SUCCESS;
 }
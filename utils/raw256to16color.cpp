@@ -6,14 +6,144 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "batch_convert.h"
+
+// input is read and converted in pieces of this size (multiple of 2 and 3, so pixel pairs and RGB triples never split)
+#define CHUNK_SIZE (3 * 64 * 1024)
+
 char * in_file  = nullptr;
 char * out_file = nullptr;
+char * batch    = nullptr;        // manifest file or glob pattern for batch mode
+char * out_dir  = nullptr;        // batch output directory
+int    threads  = 0;              // batch worker threads (0 = one per CPU)
+
+bool pal = false;
+
+// pack low nibble of each byte pair into one byte (first byte in high nibble), num_out output bytes
+static void pack_nibbles(const uint8_t * in, uint8_t * out, size_t num_out)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i lo_nibbles = _mm_set1_epi16(0x0f0f);
+    const __m128i lo_byte    = _mm_set1_epi16(0x00ff);
+    for (; i + 16 <= num_out; i += 16)
+    {
+        // 16-bit lanes hold in[2n] | in[2n+1] << 8, want (in[2n] & 0xf) << 4 | (in[2n+1] & 0xf) in low byte
+        __m128i a = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i * 2)), lo_nibbles);
+        __m128i b = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i * 2 + 16)), lo_nibbles);
+        a         = _mm_and_si128(_mm_or_si128(_mm_slli_epi16(a, 4), _mm_srli_epi16(a, 8)), lo_byte);
+        b         = _mm_and_si128(_mm_or_si128(_mm_slli_epi16(b, 4), _mm_srli_epi16(b, 8)), lo_byte);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(a, b));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t lo_nibbles = vdupq_n_u8(0x0f);
+    for (; i + 16 <= num_out; i += 16)
+    {
+        uint8x16x2_t v = vld2q_u8(in + i * 2);        // de-interleave even and odd bytes
+        vst1q_u8(out + i, vorrq_u8(vshlq_n_u8(v.val[0], 4), vandq_u8(v.val[1], lo_nibbles)));
+    }
+#endif
+    for (; i < num_out; i++)
+    {
+        out[i] = ((in[i * 2 + 0] & 0xf) << 4) | (in[i * 2 + 1] & 0xf);
+    }
+}
 
+// convert RGB888 triples to big-endian 0x0RGB palette words
+static size_t pack_palette(const uint8_t * in, uint8_t * out, size_t in_length)
+{
+    uint8_t * ptr = out;
+    for (size_t i = 0; i < in_length; i += 3)
+    {
+        *ptr++ = ((in[i + 0] >> 4) & 0xf);
+        *ptr++ = (((in[i + 1] >> 4) & 0xf) << 4) | ((in[i + 2] >> 4) & 0xf);
+    }
 
-uint8_t out_buffer[128 * 1024];
-uint8_t in_buffer[128 * 1024];
+    return ptr - out;
+}
 
-bool pal = false;
+// stream in_name to out_name converting CHUNK_SIZE pieces, returns false and sets error on failure
+static bool convert_stream(const char *  in_name,
+                           const char *  out_name,
+                           std::string * error,
+                           size_t *      in_total,
+                           size_t *      out_total)
+{
+    if (strcmp(in_name, out_name) == 0)
+    {
+        *error = std::string("Output would overwrite input \"") + in_name + "\"";
+        return false;
+    }
+
+    FILE * in_fp = fopen(in_name, "rb");
+    if (in_fp == nullptr)
+    {
+        *error = std::string("Unable to open input file \"") + in_name + "\"";
+        return false;
+    }
+    FILE * out_fp = fopen(out_name, "wb");
+    if (out_fp == nullptr)
+    {
+        fclose(in_fp);
+        *error = std::string("Unable to open output file \"") + out_name + "\"";
+        return false;
+    }
+
+    std::vector<uint8_t> in_buffer(CHUNK_SIZE + 2, 0);        // + 2 zero pad for partial pair or triple at end
+    std::vector<uint8_t> out_buffer(CHUNK_SIZE, 0);
+    bool                 good = true;
+    size_t               in_length;
+    while (good && (in_length = fread(in_buffer.data(), 1, CHUNK_SIZE, in_fp)) > 0)
+    {
+        memset(in_buffer.data() + in_length, 0, 2);
+        size_t out_length;
+        if (!pal)
+        {
+            out_length = (in_length + 1) / 2;
+            pack_nibbles(in_buffer.data(), out_buffer.data(), out_length);
+        }
+        else
+        {
+            out_length = pack_palette(in_buffer.data(), out_buffer.data(), in_length);
+        }
+        good = fwrite(out_buffer.data(), 1, out_length, out_fp) == out_length;
+        *in_total += in_length;
+        *out_total += out_length;
+    }
+    good = !ferror(in_fp) && good;
+    fclose(in_fp);
+    good = (fclose(out_fp) == 0) && good;
+
+    if (!good)
+    {
+        *error = std::string("Failed converting \"") + in_name + "\" to \"" + out_name + "\"";
+    }
+    else if (*in_total == 0)
+    {
+        *error = std::string("Input file \"") + in_name + "\" is empty";
+        good   = false;
+    }
+
+    return good;
+}
+
+// batch mode conversion of one file
+bool convert_file(const char * in_name, const char * out_name, std::string * error)
+{
+    size_t in_total  = 0;
+    size_t out_total = 0;
+
+    return convert_stream(in_name, out_name, error, &in_total, &out_total);
+}
 
 int main(int argc, char ** argv)
 {
@@ -27,6 +157,18 @@ int main(int argc, char ** argv)
             {
                 pal = true;
             }
+            else if (strcmp("-B", argv[a]) == 0 && a + 1 < argc)
+            {
+                batch = argv[++a];
+            }
+            else if (strcmp("-o", argv[a]) == 0 && a + 1 < argc)
+            {
+                out_dir = argv[++a];
+            }
+            else if (strcmp("-j", argv[a]) == 0 && a + 1 < argc)
+            {
+                threads = atoi(argv[++a]);
+            }
             else
             {
                 printf("Unexpected option: '%s'\n", argv[a]);
@@ -51,75 +193,47 @@ int main(int argc, char ** argv)
         }
     }
 
-    if (!in_file || !out_file)
+    if (!batch && (!in_file || !out_file))
     {
         printf("raw256to16color: Extract low nibble from file\n");
         printf("Usage:  raw256to16color <input file> <output file>\n");
+        printf("        raw256to16color -B <manifest | \"glob\"> [-o <dir>] [-j <threads>]\n");
         printf(" -p   treat 3 bytes as 16-bit palette entry\n");
+        printf(" -B   Batch convert files in manifest (\"<input> [output]\" lines) or glob\n");
+        printf("      (default output is input name ending \"_4bpp.raw\", or \"_pal.raw\" with -p)\n");
+        printf(" -o   Batch output directory (default is beside input)\n");
+        printf(" -j   Batch worker threads (default one per CPU)\n");
         exit(EXIT_FAILURE);
     }
 
-    printf("Input image file     : \"%s\"\n", in_file);
-    printf("Output mem font file : \"%s\"\n", out_file);
-    if (pal)
-    {
-        printf("Padding for 16-bit palette\n");
-    }
-
-    size_t in_length = 0;
+    if (batch)
     {
-        FILE * fp = fopen(in_file, "rb");
-        if (fp != nullptr)
+        std::vector<batch_item_t> items;
+        int                       failed = -1;
+        if (batch_add_items(&items, batch, out_dir, pal ? "_pal.raw" : "_4bpp.raw"))
         {
-            printf("Reading input...\n");
-
-            in_length = fread(in_buffer, 1, 128 * 1024, fp);
-
-            fclose(fp);
-            printf("Success, %zd bytes.\n", in_length);
-        }
-        else
-        {
-            printf("*** Unable to open input file\n");
-            exit(EXIT_FAILURE);
+            failed = batch_convert(&items, convert_file, threads);
         }
-    }
 
-    uint8_t * ptr        = out_buffer;
-    size_t    out_length = 0;
-    if (!pal)
-    {
-        for (size_t i = 0; i < in_length; i += 2)
-        {
-            *ptr++ = ((in_buffer[i + 0] & 0xf) << 4) | (in_buffer[i + 1] & 0xf);
-            out_length++;
-        }
-    }
-    else
-    {
-        for (size_t i = 0; i < in_length; i += 3)
-        {
-            *ptr++ = ((in_buffer[i + 0] >> 4) & 0xf);
-            *ptr++ = (((in_buffer[i + 1] >> 4) & 0xf) << 4) | ((in_buffer[i + 2] >> 4) & 0xf);
-            out_length += 2;
-        }
+        return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
     }
 
-    FILE * fp = fopen(out_file, "w");
-    if (fp != nullptr)
+    printf("Input image file     : \"%s\"\n", in_file);
+    printf("Output mem font file : \"%s\"\n", out_file);
+    if (pal)
     {
-        printf("Writing output...\n");
-        size_t wrote_length = fwrite(out_buffer, 1, out_length, fp);
-
-
-        fclose(fp);
-        printf("Wrote %zd bytes, %s\n", wrote_length, (wrote_length == out_length) ? "Success" : "Fail");
+        printf("Padding for 16-bit palette\n");
     }
-    else
+
+    std::string error;
+    size_t      in_length  = 0;
+    size_t      out_length = 0;
+    if (!convert_stream(in_file, out_file, &error, &in_length, &out_length))
     {
-        printf("*** Unable to open to output file\n");
+        printf("*** %s\n", error.c_str());
         exit(EXIT_FAILURE);
     }
+    printf("Success, read %zd bytes, wrote %zd bytes.\n", in_length, out_length);
 
     return EXIT_SUCCESS;
 }
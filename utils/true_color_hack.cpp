@@ -3,23 +3,34 @@
 // See top-level LICENSE file for license information. (Hint: MIT)
 #include <SDL.h>
 #include <SDL_image.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
-
-bool   noise_mode      = false;
-bool   create_pal      = false;
-bool   batch_mode      = false;
-bool   interleave_mode = false;
-char * in_file         = nullptr;
-char * out_file        = nullptr;
-char   out_file8[4096];
-char   out_file4[4096];
-
-#define NOISE_MOD 13        // r = rand % NOISE_MOD
+#include <string.h>
+
+#include "batch_convert.h"
+#include "dither.h"
+#include "image_rgba.h"
+
+bool     noise_mode      = false;
+bool     dither_mode     = false;
+uint32_t noise_seed      = 1;        // noise generator seed (same seed gives same output)
+bool     create_pal      = false;
+bool     batch_mode      = false;
+bool     interleave_mode = false;
+char *   in_file         = nullptr;
+char *   out_file        = nullptr;
+char *   batch           = nullptr;        // manifest file or glob pattern for multi-file batch mode
+char *   out_dir         = nullptr;        // batch output directory
+int      threads         = 0;              // batch worker threads (0 = one per CPU)
+char     out_file8[4096];
+char     out_file4[4096];
+
+#define NOISE_MOD 13        // r = noise % NOISE_MOD
 #define NOISE_SUB 6         // n = r - NOISE_SUB
 
-Uint32 getpixel(SDL_Surface * surface, int x, int y);
+bool write_true_color(const image_rgba_t * rgba, const char * out_base, bool verbose, std::string * error);
+bool convert_file(const char * in_name, const char * out_name, std::string * error);
 
 int main(int argc, char ** argv)
 {
@@ -33,6 +44,14 @@ int main(int argc, char ** argv)
             {
                 noise_mode = true;
             }
+            else if (strcmp("-d", argv[a]) == 0)
+            {
+                dither_mode = true;
+            }
+            else if (strcmp("-s", argv[a]) == 0 && a + 1 < argc)
+            {
+                noise_seed = static_cast<uint32_t>(strtoul(argv[++a], nullptr, 0));
+            }
             else if (strcmp("-b", argv[a]) == 0)
             {
                 batch_mode = true;
@@ -45,6 +64,18 @@ int main(int argc, char ** argv)
             {
                 interleave_mode = true;
             }
+            else if (strcmp("-B", argv[a]) == 0 && a + 1 < argc)
+            {
+                batch = argv[++a];
+            }
+            else if (strcmp("-o", argv[a]) == 0 && a + 1 < argc)
+            {
+                out_dir = argv[++a];
+            }
+            else if (strcmp("-j", argv[a]) == 0 && a + 1 < argc)
+            {
+                threads = atoi(argv[++a]);
+            }
             else
             {
                 printf("Unexpected option: '%s'\n", argv[a]);
@@ -69,7 +100,7 @@ int main(int argc, char ** argv)
         }
     }
 
-    if (!in_file || !out_file)
+    if (!batch && (!in_file || !out_file))
     {
         printf("true_color_hack: PNG to Xosera raw 12-bit (8-bit RG + 4-bit B) by Xark\n\n");
         printf("Usage:  true_color_hack <input PNG filepath> <output file basename> [-i]\n");
@@ -78,19 +109,33 @@ int main(int argc, char ** argv)
 
         printf("   -b   Batch mode, don't draw image\n");
         printf("   -n   Add some random noise to output to reduce 12-bit banding\n");
+        printf("   -s <seed>  Noise seed (default 1, same seed gives identical output)\n");
+        printf("   -d   Ordered 8x8 Bayer dither to reduce 12-bit banding (fast, no noise)\n");
         printf("   -i   Interlave RG and B lines (each line has RG bytes, followed by B)\n");
         printf("   -p   Write raw COLORMEM data 256 RG + 16 B words (with ADD set in alpha)\n");
+        printf("   -B <manifest | \"glob\">  Batch convert images (manifest has \"<input> [basename]\" lines)\n");
+        printf("   -o <dir>      Batch output directory (default is beside input)\n");
+        printf("   -j <threads>  Batch worker threads (default one per CPU)\n");
 
         exit(EXIT_FAILURE);
     }
 
+    if (noise_mode && dither_mode)
+    {
+        printf("Only one of noise or ordered dither can be used\n");
+        exit(EXIT_FAILURE);
+    }
     if (noise_mode)
     {
-        printf("Noise will be added to reduce banding\n");
+        printf("Noise will be added to reduce banding (seed %u)\n", noise_seed);
+    }
+    if (dither_mode)
+    {
+        printf("Ordered dither will be used to reduce banding\n");
     }
     if (interleave_mode)
     {
-        printf("Noise will be added to reduce banding\n");
+        printf("RG and B scanlines will be interleaved\n");
     }
     if (create_pal)
     {
@@ -101,6 +146,23 @@ int main(int argc, char ** argv)
         printf("Batch mode, image will not be shown\n");
     }
 
+    if (batch)
+    {
+        std::vector<batch_item_t> items;
+        IMG_Init(IMG_INIT_PNG);
+
+        int failed = -1;
+        if (batch_add_items(&items, batch, out_dir, ""))
+        {
+            failed = batch_convert(&items, convert_file, threads);
+        }
+
+        IMG_Quit();
+        SDL_Quit();
+
+        return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     printf("Input image file     : \"%s\"\n", in_file);
 
     if (!interleave_mode)
@@ -124,6 +186,7 @@ int main(int argc, char ** argv)
 
 
     SDL_Surface * image = IMG_Load(in_file);
+    image_rgba_t  rgba  = {};
 
     int w = 0;
     int h = 0;
@@ -133,6 +196,11 @@ int main(int argc, char ** argv)
         printf("*** Unable to load \"%s\"\n", in_file);
         quit = true;
     }
+    else if (!image_rgba_init(&rgba, image))
+    {
+        printf("*** Unable to convert \"%s\" to RGBA8888: %s\n", in_file, SDL_GetError());
+        quit = true;
+    }
     else
     {
         w = image->w;
@@ -221,207 +289,217 @@ int main(int argc, char ** argv)
 
             SDL_DestroyWindow(window);
         }
+    }
 
-        srand(time(nullptr));
-
+    if (rgba.surface)
+    {
+        std::string error;
+        if (!write_true_color(&rgba, out_file, true, &error))
         {
-            FILE * fp8 = fopen(out_file8, "w");
-            if (fp8 != nullptr)
-            {
-                printf("Writing output file: \"%s\"...", out_file8);
-                fflush(stdout);
+            printf("*** %s\n", error.c_str());
+        }
+    }
 
-                for (int y = 0; y < h; y++)
-                {
-                    for (int x = 0; x < w; x++)
-                    {
-                        SDL_Color rgb;
-                        Uint32    data = getpixel(image, x, y);
-                        SDL_GetRGB(data, image->format, &rgb.r, &rgb.g, &rgb.b);
-
-                        int tr = 8, tg = 8;
-                        if (noise_mode)
-                        {
-                            tr = (rand() % NOISE_MOD) - NOISE_SUB;
-                            tg = (rand() % NOISE_MOD) - NOISE_SUB;
-                        }
-
-                        int red   = ((rgb.r + tr) / 16);
-                        int green = ((rgb.g + tg) / 16);
-                        if (red < 0)
-                            red = 0;
-                        else if (red > 15)
-                            red = 15;
-                        if (green < 0)
-                            green = 0;
-                        else if (green > 15)
-                            green = 15;
-
-                        fputc(red << 4 | green, fp8);
-                    }
-                    if (interleave_mode)
-                    {
-                        int lastblue = 0;
-                        for (int x = 0; x < w; x++)
-                        {
-                            SDL_Color rgb;
-                            Uint32    data = getpixel(image, x, y);
-                            SDL_GetRGB(data, image->format, &rgb.r, &rgb.g, &rgb.b);
-
-                            int tb = 8;
-                            if (noise_mode)
-                            {
-                                tb = (rand() % NOISE_MOD) - NOISE_SUB;
-                            }
-
-                            int blue = ((rgb.b + tb) / 16);
-                            if (blue < 0)
-                                blue = 0;
-                            if (blue > 15)
-                                blue = 15;
-
-                            if (x & 1)
-                            {
-                                fputc(lastblue << 4 | blue, fp8);
-                            }
-                            else
-                            {
-                                lastblue = blue;
-                            }
-                        }
-                    }
-                }
-                printf("success\n");
-            }
-            else
-            {
-                printf("*** Unable to open \"%s\" ", out_file8);
-                perror("error");
-            }
+    image_rgba_free(&rgba);
+    if (image)
+    {
+        SDL_FreeSurface(image);
+    }
+
+    IMG_Quit();
+    SDL_Quit();
+
+    return 0;
+}
+
+// 4-bit value of 8-bit channel v for pixel x, y (rounded, or with noise or ordered dither added)
+static inline int true_color_4bit(int v, int x, int y, uint32_t * noise)
+{
+    int t = 8;
+    if (noise_mode)
+    {
+        t = static_cast<int>(noise_next(noise) % NOISE_MOD) - NOISE_SUB;
+    }
+    else if (dither_mode)
+    {
+        t = bayer8[y & 7][x & 7] >> 2;        // 0 to 15
+    }
+
+    int c = (v + t) / 16;
+
+    return c < 0 ? 0 : (c > 15 ? 15 : c);
+}
+
+// write one buffer to file, setting error on failure
+static bool write_buffer(FILE * fp, const char * name, const uint8_t * buf, size_t len, std::string * error)
+{
+    if (fwrite(buf, 1, len, fp) != len)
+    {
+        *error = std::string("Failed to write \"") + name + "\"";
+        return false;
+    }
+
+    return true;
+}
+
+// write RG8 and B4 (or interleaved RG8B4) raw files and optional palette for out_base, returns false and sets error
+// on failure.  Each scanline is converted in one pass over pixels into memory, then written with one call.
+bool write_true_color(const image_rgba_t * rgba, const char * out_base, bool verbose, std::string * error)
+{
+    char     name8[4096];
+    char     name4[4096];
+    bool     good  = true;
+    int      w     = rgba->w;
+    int      h     = rgba->h;
+    uint32_t noise = noise_seed;
+
+    snprintf(name8, sizeof(name8), interleave_mode ? "%s_RG8B4.raw" : "%s_RG8.raw", out_base);
+    snprintf(name4, sizeof(name4), "%s_B4.raw", out_base);
+
+    FILE * fp8 = fopen(name8, "wb");
+    FILE * fp4 = interleave_mode ? nullptr : fopen(name4, "wb");
+    if (fp8 == nullptr || (!interleave_mode && fp4 == nullptr))
+    {
+        *error = std::string("Unable to open \"") + (fp8 ? name4 : name8) + "\": " + strerror(errno);
+        if (fp8)
+        {
             fclose(fp8);
         }
+        return false;
+    }
 
-        if (!interleave_mode)
+    if (verbose)
+    {
+        if (interleave_mode)
         {
-            FILE * fp4 = fopen(out_file4, "w");
-            if (fp4 != nullptr)
-            {
-                printf("Writing output file: \"%s\"...", out_file4);
-                fflush(stdout);
+            printf("Writing output file: \"%s\"...", name8);
+        }
+        else
+        {
+            printf("Writing output files: \"%s\" and \"%s\"...", name8, name4);
+        }
+        fflush(stdout);
+    }
 
-                for (int y = 0; y < h; y++)
-                {
-                    int lastblue = 0;
-                    for (int x = 0; x < w; x++)
-                    {
-                        SDL_Color rgb;
-                        Uint32    data = getpixel(image, x, y);
-                        SDL_GetRGB(data, image->format, &rgb.r, &rgb.g, &rgb.b);
-
-                        int tb = 8;
-                        if (noise_mode)
-                        {
-                            tb = (rand() % NOISE_MOD) - NOISE_SUB;
-                        }
-
-                        int blue = ((rgb.b + tb) / 16);
-                        if (blue < 0)
-                            blue = 0;
-                        if (blue > 15)
-                            blue = 15;
-
-                        if (x & 1)
-                        {
-                            fputc(lastblue << 4 | blue, fp4);
-                        }
-                        else
-                        {
-                            lastblue = blue;
-                        }
-                    }
-                }
-                printf("success\n");
+    // RG bytes followed by B bytes (2 pixels per byte) for one scanline
+    std::vector<uint8_t> line(w + (w + 1) / 2);
+    uint8_t *            rg_line = line.data();
+    uint8_t *            b_line  = line.data() + w;
+
+    for (int y = 0; y < h && good; y++)
+    {
+        const rgba_t * row = image_rgba_row(rgba, y);
+        for (int x = 0; x < w; x++)
+        {
+            int red   = true_color_4bit(row[x].r, x, y, &noise);
+            int green = true_color_4bit(row[x].g, x, y, &noise);
+            int blue  = true_color_4bit(row[x].b, x, y, &noise);
+
+            rg_line[x] = static_cast<uint8_t>(red << 4 | green);
+            if (x & 1)
+            {
+                b_line[x >> 1] = static_cast<uint8_t>(b_line[x >> 1] | blue);
             }
             else
             {
-                printf("*** Unable to open \"%s\" ", out_file4);
-                perror("error");
+                b_line[x >> 1] = static_cast<uint8_t>(blue << 4);
             }
-            fclose(fp4);
         }
 
-        if (create_pal)
+        if (interleave_mode)
+        {
+            good = write_buffer(fp8, name8, line.data(), w + w / 2, error);
+        }
+        else
+        {
+            good = write_buffer(fp8, name8, rg_line, w, error) && write_buffer(fp4, name4, b_line, w / 2, error);
+        }
+    }
+
+    if (fclose(fp8) != 0 && good)
+    {
+        *error = std::string("Failed to write \"") + name8 + "\"";
+        good   = false;
+    }
+    if (fp4 && fclose(fp4) != 0 && good)
+    {
+        *error = std::string("Failed to write \"") + name4 + "\"";
+        good   = false;
+    }
+    if (verbose && good)
+    {
+        printf("success\n");
+    }
+
+    if (create_pal && good)
+    {
+        snprintf(name8, sizeof(name8), "%s_pal.raw", out_base);
+
+        // 256 0x8RG0 words then 16 0x000B words (big-endian)
+        uint8_t pal[(256 + 16) * 2];
+        for (int i = 0; i < 256; i++)
+        {
+            pal[i * 2 + 0] = static_cast<uint8_t>(0x80 | ((i >> 4) & 0xf));
+            pal[i * 2 + 1] = static_cast<uint8_t>(0x00 | ((i << 4) & 0xf0));
+        }
+        for (int i = 0; i < 16; i++)
         {
-            sprintf(out_file8, "%s_pal.raw", out_file);
+            pal[512 + i * 2 + 0] = 0x00;
+            pal[512 + i * 2 + 1] = static_cast<uint8_t>(i);
+        }
 
-            FILE * fpc = fopen(out_file8, "w");
-            if (fpc != nullptr)
+        FILE * fpc = fopen(name8, "wb");
+        if (fpc != nullptr)
+        {
+            if (verbose)
             {
-                printf("Writing output file: \"%s\"...", out_file8);
+                printf("Writing output file: \"%s\"...", name8);
                 fflush(stdout);
-
-                for (int i = 0; i < 256; i++)
-                {
-                    // 0x8RG0
-                    fputc(0x80 | ((i >> 4) & 0xf), fpc);
-                    fputc(0x00 | ((i << 4) & 0xf0), fpc);
-                }
-                for (int i = 0; i < 16; i++)
-                {
-                    // 0x00B
-                    fputc(0x00, fpc);
-                    fputc(i, fpc);
-                }
-                printf("success\n");
             }
-            else
+            good = write_buffer(fpc, name8, pal, sizeof(pal), error);
+            if (fclose(fpc) != 0 && good)
             {
-                printf("*** Unable to open \"%s\" ", out_file8);
-                perror("error");
+                *error = std::string("Failed to write \"") + name8 + "\"";
+                good   = false;
+            }
+            if (verbose && good)
+            {
+                printf("success\n");
             }
-            fclose(fpc);
+        }
+        else
+        {
+            *error = std::string("Unable to open \"") + name8 + "\": " + strerror(errno);
+            good   = false;
         }
     }
 
-    if (image)
-    {
-        SDL_FreeSurface(image);
-    }
-
-    IMG_Quit();
-    SDL_Quit();
-
-    return 0;
+    return good;
 }
 
-Uint32 getpixel(SDL_Surface * surface, int x, int y)
+// batch mode conversion of one image file to out_name basename (no window)
+bool convert_file(const char * in_name, const char * out_name, std::string * error)
 {
-    int bpp = surface->format->BytesPerPixel;
-    /* Here p is the address to the pixel we want to retrieve */
-    Uint8 * p = (Uint8 *)surface->pixels + y * surface->pitch + x * bpp;
-
-    switch (bpp)
+    SDL_Surface * image = IMG_Load(in_name);
+    if (!image)
     {
-        case 1:
-            return *p;
-            break;
-
-        case 2:
-            return *(Uint16 *)p;
-            break;
+        *error = std::string("Unable to load: ") + SDL_GetError();
+        return false;
+    }
 
-        case 3:
-            if (SDL_BYTEORDER == SDL_BIG_ENDIAN)
-                return p[0] << 16 | p[1] << 8 | p[2];
-            else
-                return p[0] | p[1] << 8 | p[2] << 16;
-            break;
+    image_rgba_t rgba = {};
+    bool         good = false;
+    if (!image_rgba_init(&rgba, image))
+    {
+        *error = std::string("Unable to convert to RGBA8888: ") + SDL_GetError();
+    }
+    else
+    {
+        good = write_true_color(&rgba, out_name, false, error);
+    }
 
-        case 4:
-            return *(Uint32 *)p;
-            break;
+    image_rgba_free(&rgba);
+    SDL_FreeSurface(image);
 
-        default:
-            return 0; /* shouldn't happen, but avoids warnings */
-    }
+    return good;
 }
@@ -0,0 +1,428 @@
+// Quick & Dirty Xosera asset container writer (see xosera_asset.h)
+// Xark - 2021
+// See top-level LICENSE file for license information. (Hint: MIT)
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "xosera_asset.h"
+
+struct asset_chunk_t
+{
+    xa_chunk_t           chunk;        // table entry (big-endian, offset set when written)
+    std::vector<uint8_t> data;         // chunk data
+};
+
+struct type_info_t
+{
+    const char * option;            // command line option
+    const char * name;              // name when listing
+    uint16_t     type;              // xa_type_t
+    uint16_t     target;            // default xa_target_t
+    uint32_t     address;           // default address
+};
+
+static const type_info_t type_info[] = {{"-bitmap", "bitmap", XA_TYPE_BITMAP, XA_TARGET_VRAM, 0x0000},
+                                        {"-pal_a", "palette_a", XA_TYPE_PALETTE_A, XA_TARGET_XR, 0x8000},
+                                        {"-pal_b", "palette_b", XA_TYPE_PALETTE_B, XA_TARGET_XR, 0x8100},
+                                        {"-tiles", "tiles", XA_TYPE_TILES, XA_TARGET_XR, 0xA000},
+                                        {"-tilemap", "tilemap", XA_TYPE_TILEMAP, XA_TARGET_VRAM, 0x0000},
+                                        {"-copper", "copper", XA_TYPE_COPPER, XA_TARGET_XR, 0xC000},
+                                        {"-audio", "audio", XA_TYPE_AUDIO, XA_TARGET_VRAM, 0x0000}};
+
+static const int num_types = sizeof(type_info) / sizeof(type_info[0]);
+
+// attributes given before a chunk option (reset after each chunk)
+struct chunk_attr_t
+{
+    long        address;          // -1 for type default
+    int         target;           // -1 for type default
+    long        gfx_ctrl;
+    long        tile_ctrl;
+    long        line_len;         // -1 to calculate for bitmap
+    long        width;
+    long        height;
+    std::string name;
+};
+
+static const type_info_t * find_type_option(const char * option)
+{
+    for (int t = 0; t < num_types; t++)
+    {
+        if (strcmp(type_info[t].option, option) == 0)
+        {
+            return &type_info[t];
+        }
+    }
+
+    return nullptr;
+}
+
+static const char * type_name(uint16_t type)
+{
+    for (int t = 0; t < num_types; t++)
+    {
+        if (type_info[t].type == type)
+        {
+            return type_info[t].name;
+        }
+    }
+
+    return "unknown";
+}
+
+static void reset_attr(chunk_attr_t * attr)
+{
+    attr->address   = -1;
+    attr->target    = -1;
+    attr->gfx_ctrl  = 0;
+    attr->tile_ctrl = 0;
+    attr->line_len  = -1;
+    attr->width     = 0;
+    attr->height    = 0;
+    attr->name.clear();
+}
+
+static bool read_file(const char * filename, std::vector<uint8_t> * data)
+{
+    FILE * fp = fopen(filename, "rb");
+    if (fp == nullptr)
+    {
+        printf("*** Unable to open \"%s\" ", filename);
+        perror("error");
+        return false;
+    }
+
+    uint8_t buffer[64 * 1024];
+    size_t  n;
+    while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+    {
+        data->insert(data->end(), buffer, buffer + n);
+    }
+    bool ok = !ferror(fp);
+    fclose(fp);
+
+    if (!ok)
+    {
+        printf("*** Error reading \"%s\"\n", filename);
+    }
+
+    return ok;
+}
+
+static bool parse_number(const char * str, long max, long * value)
+{
+    char * end = nullptr;
+    long   v   = strtol(str, &end, 0);
+    if (end == str || *end != '\0' || v < 0 || v > max)
+    {
+        printf("*** Bad value '%s' (expected 0 to 0x%lx)\n", str, max);
+        return false;
+    }
+    *value = v;
+
+    return true;
+}
+
+static bool add_chunk(std::vector<asset_chunk_t> * chunks,
+                      const type_info_t *          info,
+                      const chunk_attr_t &         attr,
+                      const char *                 filename)
+{
+    asset_chunk_t ac = {};
+    if (!read_file(filename, &ac.data))
+    {
+        return false;
+    }
+    if (ac.data.size() & 1)
+    {
+        printf("*** \"%s\" is an odd size (%zu bytes), Xosera data must be 16-bit words\n", filename, ac.data.size());
+        return false;
+    }
+
+    uint16_t target  = attr.target >= 0 ? attr.target : info->target;
+    uint32_t address = attr.address >= 0 ? attr.address : info->address;
+    if (address + ac.data.size() / 2 > 0x10000)
+    {
+        printf("*** \"%s\" (%zu words) does not fit at %s address 0x%04x\n",
+               filename,
+               ac.data.size() / 2,
+               target == XA_TARGET_XR ? "XR" : "VRAM",
+               address);
+        return false;
+    }
+
+    long line_len = attr.line_len;
+    if (line_len < 0)
+    {
+        line_len = 0;
+        if (info->type == XA_TYPE_BITMAP && attr.width)
+        {
+            static const int pixels_per_word[4] = {8, 4, 2, 0};        // 1-bpp, 4-bpp, 8-bpp, X
+            int              ppw                = pixels_per_word[(attr.gfx_ctrl >> 4) & 3];
+            line_len                            = ppw ? (attr.width + ppw - 1) / ppw : 0;
+        }
+        else if (info->type == XA_TYPE_TILEMAP)
+        {
+            line_len = attr.width;
+        }
+    }
+
+    std::string name = attr.name;
+    if (name.empty())
+    {
+        name            = filename;
+        size_t slash    = name.find_last_of('/');
+        size_t dot      = name.find_last_of('.');
+        size_t name_end = (dot != std::string::npos && (slash == std::string::npos || dot > slash)) ? dot : name.size();
+        size_t name_beg = slash != std::string::npos ? slash + 1 : 0;
+        name            = name.substr(name_beg, name_end - name_beg);
+    }
+
+    xa_put16(&ac.chunk.type, info->type);
+    xa_put16(&ac.chunk.target, target);
+    xa_put32(&ac.chunk.address, address);
+    xa_put32(&ac.chunk.size, static_cast<uint32_t>(ac.data.size()));
+    xa_put16(&ac.chunk.gfx_ctrl, static_cast<uint16_t>(attr.gfx_ctrl));
+    xa_put16(&ac.chunk.tile_ctrl, static_cast<uint16_t>(attr.tile_ctrl));
+    xa_put16(&ac.chunk.line_len, static_cast<uint16_t>(line_len));
+    xa_put16(&ac.chunk.width, static_cast<uint16_t>(attr.width));
+    xa_put16(&ac.chunk.height, static_cast<uint16_t>(attr.height));
+    strncpy(ac.chunk.name, name.c_str(), sizeof(ac.chunk.name));
+
+    chunks->push_back(ac);
+
+    return true;
+}
+
+static bool write_container(const char * out_file, std::vector<asset_chunk_t> * chunks)
+{
+    xa_header_t hdr    = {};
+    uint32_t    table  = xa_align(sizeof(xa_header_t));
+    uint32_t    offset = xa_align(table + static_cast<uint32_t>(chunks->size() * sizeof(xa_chunk_t)));
+    for (auto & ac : *chunks)
+    {
+        xa_put32(&ac.chunk.offset, offset);
+        offset = xa_align(offset + static_cast<uint32_t>(ac.data.size()));
+    }
+
+    memcpy(hdr.magic, XA_MAGIC, sizeof(hdr.magic));
+    xa_put16(&hdr.version, XA_VERSION);
+    xa_put16(&hdr.chunk_size, sizeof(xa_chunk_t));
+    xa_put32(&hdr.num_chunks, static_cast<uint32_t>(chunks->size()));
+    xa_put32(&hdr.table_offset, table);
+    xa_put32(&hdr.file_size, offset);
+
+    // build whole file in memory (so it is only written once)
+    std::vector<uint8_t> file(offset, 0);
+    memcpy(&file[0], &hdr, sizeof(hdr));
+    for (size_t i = 0; i < chunks->size(); i++)
+    {
+        const asset_chunk_t & ac = (*chunks)[i];
+        memcpy(&file[table + i * sizeof(xa_chunk_t)], &ac.chunk, sizeof(xa_chunk_t));
+        if (ac.data.size())
+        {
+            memcpy(&file[xa_get32(&ac.chunk.offset)], &ac.data[0], ac.data.size());
+        }
+    }
+
+    FILE * fp = fopen(out_file, "wb");
+    if (fp == nullptr)
+    {
+        printf("*** Unable to open \"%s\" ", out_file);
+        perror("error");
+        return false;
+    }
+    bool ok = fwrite(&file[0], file.size(), 1, fp) == 1;
+    if (fclose(fp) != 0)
+    {
+        ok = false;
+    }
+    if (!ok)
+    {
+        printf("*** Error writing \"%s\"\n", out_file);
+        return false;
+    }
+
+    printf("Wrote \"%s\" with %zu chunks (%u bytes).\n", out_file, chunks->size(), offset);
+
+    return true;
+}
+
+static bool list_container(const char * in_file)
+{
+    std::vector<uint8_t> file;
+    if (!read_file(in_file, &file))
+    {
+        return false;
+    }
+
+    const xa_chunk_t * chunks =
+        file.size() ? xa_chunks(&file[0], static_cast<uint32_t>(file.size())) : nullptr;
+    if (chunks == nullptr)
+    {
+        printf("*** \"%s\" is not a valid Xosera asset container (version %d)\n", in_file, XA_VERSION);
+        return false;
+    }
+
+    uint32_t num = xa_num_chunks(&file[0]);
+    printf("\"%s\": %u chunks, %zu bytes\n", in_file, num, file.size());
+    printf("  # %-16s %-9s %-4s addr   offset   bytes    gfx    tile   len    w     h\n", "name", "type", "dest");
+    for (uint32_t i = 0; i < num; i++)
+    {
+        const xa_chunk_t * c = &chunks[i];
+        char               name[sizeof(c->name) + 1];
+        memcpy(name, c->name, sizeof(c->name));
+        name[sizeof(c->name)] = '\0';
+
+        printf("%3u %-16s %-9s %-4s 0x%04x 0x%06x %-8u 0x%04x 0x%04x %-6u %-5u %-5u\n",
+               i,
+               name,
+               type_name(xa_get16(&c->type)),
+               xa_get16(&c->target) == XA_TARGET_XR ? "XR" : "VRAM",
+               xa_get32(&c->address),
+               xa_get32(&c->offset),
+               xa_get32(&c->size),
+               xa_get16(&c->gfx_ctrl),
+               xa_get16(&c->tile_ctrl),
+               xa_get16(&c->line_len),
+               xa_get16(&c->width),
+               xa_get16(&c->height));
+    }
+
+    return true;
+}
+
+static void usage()
+{
+    printf("Usage:  xosera_asset [attributes] -<type> <file> ... -o <output.xosa>\n");
+    printf("        xosera_asset -l <file.xosa>\n");
+    printf("Chunk types (default destination):\n");
+    for (int t = 0; t < num_types; t++)
+    {
+        printf("  %-9s <file> %-9s (%s 0x%04x)\n",
+               type_info[t].option,
+               type_info[t].name,
+               type_info[t].target == XA_TARGET_XR ? "XR" : "VRAM",
+               type_info[t].address);
+    }
+    printf("Attributes (apply to next chunk only):\n");
+    printf("  -addr <n>     load word address\n");
+    printf("  -vram / -xr   load to VRAM or XR memory\n");
+    printf("  -gfx <n>      Px_GFX_CTRL value\n");
+    printf("  -tile <n>     Px_TILE_CTRL value\n");
+    printf("  -len <n>      Px_LINE_LEN (or audio period) value (default from width for bitmap/tilemap)\n");
+    printf("  -size <w>x<h> width and height in pixels (bitmap) or tiles (tilemap)\n");
+    printf("  -name <name>  chunk name (default file name, max 16 chars)\n");
+    printf("Chunk data files are raw big-endian 16-bit words (e.g., .raw and _pal.raw from image utilities).\n");
+}
+
+int main(int argc, char ** argv)
+{
+    printf("Xosera asset container writer - Xark\n\n");
+
+    std::vector<asset_chunk_t> chunks;
+    chunk_attr_t               attr;
+    const char *               out_file  = nullptr;
+    const char *               list_file = nullptr;
+    reset_attr(&attr);
+
+    for (int a = 1; a < argc; a++)
+    {
+        const type_info_t * info = find_type_option(argv[a]);
+        bool                arg  = (a + 1 < argc);
+        if (info && arg)
+        {
+            if (!add_chunk(&chunks, info, attr, argv[++a]))
+            {
+                exit(EXIT_FAILURE);
+            }
+            reset_attr(&attr);
+        }
+        else if (strcmp("-o", argv[a]) == 0 && arg)
+        {
+            out_file = argv[++a];
+        }
+        else if (strcmp("-l", argv[a]) == 0 && arg)
+        {
+            list_file = argv[++a];
+        }
+        else if (strcmp("-addr", argv[a]) == 0 && arg)
+        {
+            if (!parse_number(argv[++a], 0xffff, &attr.address))
+            {
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp("-vram", argv[a]) == 0)
+        {
+            attr.target = XA_TARGET_VRAM;
+        }
+        else if (strcmp("-xr", argv[a]) == 0)
+        {
+            attr.target = XA_TARGET_XR;
+        }
+        else if (strcmp("-gfx", argv[a]) == 0 && arg)
+        {
+            if (!parse_number(argv[++a], 0xffff, &attr.gfx_ctrl))
+            {
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp("-tile", argv[a]) == 0 && arg)
+        {
+            if (!parse_number(argv[++a], 0xffff, &attr.tile_ctrl))
+            {
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp("-len", argv[a]) == 0 && arg)
+        {
+            if (!parse_number(argv[++a], 0xffff, &attr.line_len))
+            {
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp("-size", argv[a]) == 0 && arg)
+        {
+            if (sscanf(argv[++a], "%ldx%ld", &attr.width, &attr.height) != 2 || attr.width < 0 ||
+                attr.width > 0xffff || attr.height < 0 || attr.height > 0xffff)
+            {
+                printf("*** Bad size '%s' (expected <width>x<height>)\n", argv[a]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp("-name", argv[a]) == 0 && arg)
+        {
+            attr.name = argv[++a];
+        }
+        else
+        {
+            printf("Unexpected argument: '%s'\n\n", argv[a]);
+            usage();
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (list_file)
+    {
+        return list_container(list_file) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (!out_file || chunks.empty())
+    {
+        usage();
+        exit(EXIT_FAILURE);
+    }
+
+    if (!write_container(out_file, &chunks) || !list_container(out_file))
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    return EXIT_SUCCESS;
+}
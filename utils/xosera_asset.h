@@ -0,0 +1,154 @@
+// xosera_asset.h - single-file Xosera asset container format (".xosa")
+// Xark - 2021
+// See top-level LICENSE file for license information. (Hint: MIT)
+//
+// A container holds any number of chunks (bitmaps, A/B palettes, tile definitions, tilemaps, copper lists and audio
+// samples), each tagged with the VRAM or XR word address it loads to (and graphics mode settings where they apply).
+// Loaders (host, simulator or m68k) can map/read the whole file and write each chunk's data straight to XM_DATA or
+// XM_XR_DATA, there is nothing to parse or convert:
+//
+//   offset 0:              xa_header_t (32 bytes)
+//   header.table_offset:   xa_chunk_t[header.num_chunks] (48 bytes each)
+//   chunk.offset:          chunk data, XA_ALIGN byte aligned (zero padded)
+//
+// All header and table fields are big-endian (native for m68k, use xa_get16/xa_get32 elsewhere).  Chunk data is a
+// stream of big-endian 16-bit words in the order written to Xosera (same as existing .raw and _pal.raw files).
+//
+// This header is C and C++ compatible so it can be shared with m68k loaders.
+#if !defined(XOSERA_ASSET_H)
+#define XOSERA_ASSET_H
+
+#include <stdint.h>
+
+#define XA_MAGIC   "XOSA"        // header.magic
+#define XA_VERSION 1             // header.version
+#define XA_ALIGN   16            // alignment of chunk table and chunk data in file (bytes)
+
+// chunk types
+enum xa_type_t
+{
+    XA_TYPE_BITMAP    = 1,        // bitmap words to VRAM
+    XA_TYPE_PALETTE_A = 2,        // 0xARGB words to XR_COLOR_A_ADDR
+    XA_TYPE_PALETTE_B = 3,        // 0xARGB words to XR_COLOR_B_ADDR
+    XA_TYPE_TILES     = 4,        // tile definitions to tile memory or VRAM
+    XA_TYPE_TILEMAP   = 5,        // tilemap words to VRAM or tile memory
+    XA_TYPE_COPPER    = 6,        // copper program to XR_COPPER_ADDR
+    XA_TYPE_AUDIO     = 7,        // audio sample words to VRAM
+    XA_TYPE_MAX
+};
+
+// chunk targets
+enum xa_target_t
+{
+    XA_TARGET_VRAM = 0,        // write address with XM_WR_ADDR, data with XM_DATA
+    XA_TARGET_XR   = 1         // write address with XM_XR_ADDR, data with XM_XR_DATA
+};
+
+typedef struct xa_header
+{
+    char     magic[4];            // XA_MAGIC (not NUL terminated)
+    uint16_t version;             // XA_VERSION
+    uint16_t chunk_size;          // sizeof(xa_chunk_t) (table entry size)
+    uint32_t num_chunks;          // number of entries in chunk table
+    uint32_t table_offset;        // file offset of chunk table
+    uint32_t file_size;           // total file size in bytes
+    uint32_t reserved[3];         // zero
+} xa_header_t;
+
+typedef struct xa_chunk
+{
+    uint16_t type;                // xa_type_t
+    uint16_t target;              // xa_target_t
+    uint32_t address;             // VRAM or XR word address to load data
+    uint32_t offset;              // file offset of data (XA_ALIGN aligned)
+    uint32_t size;                // data size in bytes (even)
+    uint16_t gfx_ctrl;            // Px_GFX_CTRL value (bitmap, tilemap) or 0
+    uint16_t tile_ctrl;           // Px_TILE_CTRL value (tilemap, tiles) or 0
+    uint16_t line_len;            // Px_LINE_LEN value in words (bitmap, tilemap) or AUDn_PERIOD (audio) or 0
+    uint16_t width;               // width in pixels (bitmap) or tiles (tilemap) or 0
+    uint16_t height;              // height in pixels (bitmap) or tiles (tilemap) or 0
+    uint16_t flags;               // zero (reserved)
+    uint32_t reserved;            // zero
+    char     name[16];            // chunk name (NUL padded, not terminated if 16 chars)
+} xa_chunk_t;
+
+#if defined(__cplusplus)
+static_assert(sizeof(xa_header_t) == 32, "xa_header_t size");
+static_assert(sizeof(xa_chunk_t) == 48, "xa_chunk_t size");
+#endif
+
+static inline uint16_t xa_get16(const uint16_t * p)
+{
+    const uint8_t * b = (const uint8_t *)p;
+    return (uint16_t)((b[0] << 8) | b[1]);
+}
+
+static inline uint32_t xa_get32(const uint32_t * p)
+{
+    const uint8_t * b = (const uint8_t *)p;
+    return ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | (uint32_t)b[3];
+}
+
+static inline void xa_put16(uint16_t * p, uint16_t v)
+{
+    uint8_t * b = (uint8_t *)p;
+    b[0]        = (uint8_t)(v >> 8);
+    b[1]        = (uint8_t)v;
+}
+
+static inline void xa_put32(uint32_t * p, uint32_t v)
+{
+    uint8_t * b = (uint8_t *)p;
+    b[0]        = (uint8_t)(v >> 24);
+    b[1]        = (uint8_t)(v >> 16);
+    b[2]        = (uint8_t)(v >> 8);
+    b[3]        = (uint8_t)v;
+}
+
+static inline uint32_t xa_align(uint32_t offset)
+{
+    return (offset + (XA_ALIGN - 1)) & ~(uint32_t)(XA_ALIGN - 1);
+}
+
+// check header of file data (size bytes), returns chunk table or NULL if not a valid container
+static inline const xa_chunk_t * xa_chunks(const void * data, uint32_t size)
+{
+    const xa_header_t * hdr = (const xa_header_t *)data;
+    if (size < sizeof(xa_header_t) || hdr->magic[0] != 'X' || hdr->magic[1] != 'O' || hdr->magic[2] != 'S' ||
+        hdr->magic[3] != 'A' || xa_get16(&hdr->version) != XA_VERSION ||
+        xa_get16(&hdr->chunk_size) != sizeof(xa_chunk_t))
+    {
+        return 0;
+    }
+    uint32_t num   = xa_get32(&hdr->num_chunks);
+    uint32_t table = xa_get32(&hdr->table_offset);
+    if (table > size || num > (size - table) / sizeof(xa_chunk_t))
+    {
+        return 0;
+    }
+    const xa_chunk_t * chunks = (const xa_chunk_t *)((const uint8_t *)data + table);
+    for (uint32_t i = 0; i < num; i++)
+    {
+        uint32_t offset = xa_get32(&chunks[i].offset);
+        uint32_t bytes  = xa_get32(&chunks[i].size);
+        if (offset > size || bytes > size - offset)
+        {
+            return 0;
+        }
+    }
+
+    return chunks;
+}
+
+static inline uint32_t xa_num_chunks(const void * data)
+{
+    return xa_get32(&((const xa_header_t *)data)->num_chunks);
+}
+
+// pointer to data of chunk (big-endian words)
+static inline const uint8_t * xa_chunk_data(const void * data, const xa_chunk_t * chunk)
+{
+    return (const uint8_t *)data + xa_get32(&chunk->offset);
+}
+
+#endif        // XOSERA_ASSET_H
@@ -0,0 +1,265 @@
+// xosera_rle.h - word run-length compression for Xosera data (".xrle")
+// Xark - 2021
+// See top-level LICENSE file for license information. (Hint: MIT)
+//
+// Xosera data is uploaded as 16-bit words (to XM_DATA or XM_XR_DATA), so this codec works on whole big-endian words
+// (e.g., a run of 8-bpp pixel pairs or 4-bpp nibble quads) and the decoder hands out either literal words exactly as
+// they are in the compressed input, or one word and a repeat count.  A loader can send those straight to Xosera with
+// no intermediate buffer (the literal words can be written directly from the input buffer).
+//
+// Format (all big-endian):
+//   "XRLE"                 4 byte magic
+//   uint32_t size          decoded size in bytes (even)
+//   tokens until size bytes decoded:
+//     0x0000-0x7FFF        literal: (token + 1) words follow
+//     0x8000-0xFFFF        repeat:  next word repeated ((token & 0x7FFF) + 1) times
+//
+// The decoder is resumable, input can be passed in any size pieces (e.g., 512 byte SD card blocks).
+//
+// This header is C and C++ compatible so it can be shared with m68k loaders.
+#if !defined(XOSERA_RLE_H)
+#define XOSERA_RLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define XRLE_MAGIC      "XRLE"        // header magic
+#define XRLE_HEADER     8             // header size in bytes
+#define XRLE_MAX_RUN    0x8000        // maximum words per token
+#define XRLE_MIN_REPEAT 3             // shortest run encoded as a repeat (shorter runs are cheaper as literals)
+
+// maximum encoded size in bytes of num_words words (no runs, one token per XRLE_MAX_RUN words)
+#define XRLE_MAX_BYTES(num_words) (XRLE_HEADER + 2 * ((num_words) + ((num_words) + XRLE_MAX_RUN - 1) / XRLE_MAX_RUN))
+
+// true if data (at least 4 bytes) starts with XRLE_MAGIC
+static inline int xrle_check(const uint8_t * data)
+{
+    return data[0] == 'X' && data[1] == 'R' && data[2] == 'L' && data[3] == 'E';
+}
+
+static inline uint8_t * xrle_put_word(uint8_t * out, uint16_t word)
+{
+    out[0] = (uint8_t)(word >> 8);
+    out[1] = (uint8_t)word;
+    return out + 2;
+}
+
+static inline uint16_t xrle_get_word(const uint8_t * in)
+{
+    return (uint16_t)((in[0] << 8) | in[1]);
+}
+
+// encode num_bytes (even) of big-endian words from in to out (at least XRLE_MAX_BYTES(num_bytes/2) bytes), returns
+// encoded size in bytes
+static inline size_t xrle_encode(const uint8_t * in, size_t num_bytes, uint8_t * out)
+{
+    size_t    num_words = num_bytes / 2;
+    uint8_t * o         = out;
+    o[0]                = 'X';
+    o[1]                = 'R';
+    o[2]                = 'L';
+    o[3]                = 'E';
+    o                   = xrle_put_word(o + 4, (uint16_t)((num_words * 2) >> 16));
+    o                   = xrle_put_word(o, (uint16_t)(num_words * 2));
+
+    size_t lit_start = 0;        // first word of pending literal run
+    size_t i         = 0;
+    while (i <= num_words)
+    {
+        size_t run = 0;
+        if (i < num_words)
+        {
+            uint16_t word = xrle_get_word(in + i * 2);
+            run           = 1;
+            while (i + run < num_words && run < XRLE_MAX_RUN && xrle_get_word(in + (i + run) * 2) == word)
+            {
+                run++;
+            }
+        }
+
+        // flush pending literals at end, before a repeat or when full
+        size_t lit_len = i - lit_start;
+        if (lit_len && (i == num_words || run >= XRLE_MIN_REPEAT || lit_len == XRLE_MAX_RUN))
+        {
+            o = xrle_put_word(o, (uint16_t)(lit_len - 1));
+            for (size_t l = lit_start; l < i; l++)
+            {
+                o = xrle_put_word(o, xrle_get_word(in + l * 2));
+            }
+            lit_start = i;
+        }
+
+        if (i == num_words)
+        {
+            break;
+        }
+
+        if (run >= XRLE_MIN_REPEAT)
+        {
+            o = xrle_put_word(o, (uint16_t)(0x8000 | (run - 1)));
+            o = xrle_put_word(o, xrle_get_word(in + i * 2));
+            i += run;
+            lit_start = i;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    return (size_t)(o - out);
+}
+
+// decoder output functions, words are big-endian byte pairs (word aligned if input buffers are word aligned)
+typedef void (*xrle_literal_fn)(void * ctx, const uint8_t * words, uint32_t num_words);
+typedef void (*xrle_repeat_fn)(void * ctx, uint16_t word, uint32_t num_words);
+
+enum xrle_state_t
+{
+    XRLE_STATE_HEADER,         // reading header
+    XRLE_STATE_TOKEN,          // reading token
+    XRLE_STATE_LITERAL,        // passing literal words
+    XRLE_STATE_REPEAT,         // reading repeat word
+    XRLE_STATE_DONE,           // all words decoded
+    XRLE_STATE_ERROR           // bad header or token
+};
+
+enum xrle_result_t
+{
+    XRLE_ERROR = -1,        // not XRLE data or corrupt
+    XRLE_MORE  = 0,         // all input used, more expected
+    XRLE_DONE  = 1          // all words decoded (any remaining input ignored)
+};
+
+typedef struct xrle_decoder
+{
+    uint32_t        remain;            // words left to decode
+    uint32_t        count;             // words left in current token
+    uint8_t         partial[8];        // partial header, token or word split between input pieces
+    uint8_t         nbytes;            // bytes in partial
+    uint8_t         state;             // xrle_state_t
+    xrle_literal_fn literal;           // output literal words
+    xrle_repeat_fn  repeat;            // output repeated word
+    void *          ctx;               // passed to output functions
+} xrle_decoder_t;
+
+static inline void xrle_decode_init(xrle_decoder_t * dec, xrle_literal_fn literal, xrle_repeat_fn repeat, void * ctx)
+{
+    dec->remain  = 0;
+    dec->count   = 0;
+    dec->nbytes  = 0;
+    dec->state   = XRLE_STATE_HEADER;
+    dec->literal = literal;
+    dec->repeat  = repeat;
+    dec->ctx     = ctx;
+}
+
+// gather want bytes in dec->partial, returns 1 when complete
+static inline int xrle_gather(xrle_decoder_t * dec, const uint8_t ** in, size_t * len, uint8_t want)
+{
+    while (dec->nbytes < want && *len)
+    {
+        dec->partial[dec->nbytes++] = *(*in)++;
+        (*len)--;
+    }
+    if (dec->nbytes < want)
+    {
+        return 0;
+    }
+    dec->nbytes = 0;
+    return 1;
+}
+
+// decode the next len bytes of input, returns xrle_result_t
+static inline int xrle_decode(xrle_decoder_t * dec, const uint8_t * in, size_t len)
+{
+    while (dec->state != XRLE_STATE_DONE && dec->state != XRLE_STATE_ERROR)
+    {
+        if (dec->state == XRLE_STATE_LITERAL)
+        {
+            if (dec->nbytes)        // finish word split between input pieces
+            {
+                if (!xrle_gather(dec, &in, &len, 2))
+                {
+                    break;
+                }
+                dec->literal(dec->ctx, dec->partial, 1);
+                dec->count--;
+            }
+            uint32_t n = (uint32_t)(len / 2);
+            if (n > dec->count)
+            {
+                n = dec->count;
+            }
+            if (n)
+            {
+                dec->literal(dec->ctx, in, n);
+                in += n * 2;
+                len -= n * 2;
+                dec->count -= n;
+            }
+            if (dec->count)
+            {
+                if (len)        // odd byte left, keep for next input
+                {
+                    dec->partial[dec->nbytes++] = *in++;
+                    len--;
+                }
+                break;
+            }
+            dec->state = dec->remain ? XRLE_STATE_TOKEN : XRLE_STATE_DONE;
+            continue;
+        }
+
+        if (dec->state == XRLE_STATE_HEADER)
+        {
+            if (!xrle_gather(dec, &in, &len, XRLE_HEADER))
+            {
+                break;
+            }
+            uint32_t size = ((uint32_t)xrle_get_word(dec->partial + 4) << 16) | xrle_get_word(dec->partial + 6);
+            if (!xrle_check(dec->partial) || (size & 1))
+            {
+                dec->state = XRLE_STATE_ERROR;
+                break;
+            }
+            dec->remain = size / 2;
+            dec->state  = dec->remain ? XRLE_STATE_TOKEN : XRLE_STATE_DONE;
+        }
+        else if (dec->state == XRLE_STATE_TOKEN)
+        {
+            if (!xrle_gather(dec, &in, &len, 2))
+            {
+                break;
+            }
+            uint16_t token = xrle_get_word(dec->partial);
+            dec->count     = (uint32_t)(token & 0x7FFF) + 1;
+            if (dec->count > dec->remain)
+            {
+                dec->state = XRLE_STATE_ERROR;
+                break;
+            }
+            dec->remain -= dec->count;
+            dec->state = (token & 0x8000) ? XRLE_STATE_REPEAT : XRLE_STATE_LITERAL;
+        }
+        else if (dec->state == XRLE_STATE_REPEAT)
+        {
+            if (!xrle_gather(dec, &in, &len, 2))
+            {
+                break;
+            }
+            dec->repeat(dec->ctx, xrle_get_word(dec->partial), dec->count);
+            dec->count = 0;
+            dec->state = dec->remain ? XRLE_STATE_TOKEN : XRLE_STATE_DONE;
+        }
+    }
+
+    if (dec->state == XRLE_STATE_ERROR)
+    {
+        return XRLE_ERROR;
+    }
+
+    return dec->state == XRLE_STATE_DONE ? XRLE_DONE : XRLE_MORE;
+}
+
+#endif        // XOSERA_RLE_H
@@ -0,0 +1,308 @@
+// Quick & Dirty Xosera word RLE compressor/decompressor and decoder benchmark (see xosera_rle.h)
+// Xark - 2021
+// See top-level LICENSE file for license information. (Hint: MIT)
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include "xosera_rle.h"
+
+#define BENCH_BLOCK 512        // input piece size for benchmark (SD card sector, like m68k loaders)
+#define BENCH_SECS  0.5        // minimum time per benchmark measurement
+
+static bool decompress = false;
+static bool benchmark  = false;
+
+static double time_secs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1000000000.0;
+}
+
+static bool read_file(const char * filename, std::vector<uint8_t> * data)
+{
+    FILE * fp = fopen(filename, "rb");
+    if (fp == nullptr)
+    {
+        printf("*** Unable to open \"%s\" ", filename);
+        perror("error");
+        return false;
+    }
+
+    uint8_t buffer[64 * 1024];
+    size_t  n;
+    while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+    {
+        data->insert(data->end(), buffer, buffer + n);
+    }
+    bool ok = !ferror(fp);
+    fclose(fp);
+
+    if (!ok)
+    {
+        printf("*** Error reading \"%s\"\n", filename);
+    }
+
+    return ok;
+}
+
+static bool write_file(const char * filename, const uint8_t * data, size_t size)
+{
+    FILE * fp = fopen(filename, "wb");
+    if (fp == nullptr)
+    {
+        printf("*** Unable to open \"%s\" ", filename);
+        perror("error");
+        return false;
+    }
+    bool ok = (size == 0 || fwrite(data, size, 1, fp) == 1);
+    if (fclose(fp) != 0)
+    {
+        ok = false;
+    }
+    if (!ok)
+    {
+        printf("*** Error writing \"%s\"\n", filename);
+    }
+
+    return ok;
+}
+
+// decode to memory buffer (to check data or write decompressed file)
+static void buffer_literal(void * ctx, const uint8_t * words, uint32_t num_words)
+{
+    std::vector<uint8_t> * out = static_cast<std::vector<uint8_t> *>(ctx);
+    out->insert(out->end(), words, words + num_words * 2);
+}
+
+static void buffer_repeat(void * ctx, uint16_t word, uint32_t num_words)
+{
+    std::vector<uint8_t> * out = static_cast<std::vector<uint8_t> *>(ctx);
+    for (uint32_t i = 0; i < num_words; i++)
+    {
+        out->push_back(static_cast<uint8_t>(word >> 8));
+        out->push_back(static_cast<uint8_t>(word));
+    }
+}
+
+static bool decode_buffer(const std::vector<uint8_t> & in, std::vector<uint8_t> * out)
+{
+    xrle_decoder_t dec;
+    xrle_decode_init(&dec, buffer_literal, buffer_repeat, out);
+
+    return in.size() && xrle_decode(&dec, in.data(), in.size()) == XRLE_DONE;
+}
+
+// decode to a single "register" word (like writing XM_DATA with WR_INCR 1)
+static volatile uint16_t data_reg;
+
+static void reg_literal(void *, const uint8_t * words, uint32_t num_words)
+{
+    for (uint32_t i = 0; i < num_words; i++)
+    {
+        data_reg = xrle_get_word(words + i * 2);
+    }
+}
+
+static void reg_repeat(void *, uint16_t word, uint32_t num_words)
+{
+    for (uint32_t i = 0; i < num_words; i++)
+    {
+        data_reg = word;
+    }
+}
+
+// decode data in BENCH_BLOCK pieces to data_reg, returns false on error
+static bool bench_decode(const std::vector<uint8_t> & xrle)
+{
+    xrle_decoder_t dec;
+    xrle_decode_init(&dec, reg_literal, reg_repeat, nullptr);
+
+    int rc = XRLE_MORE;
+    for (size_t off = 0; off < xrle.size() && rc == XRLE_MORE; off += BENCH_BLOCK)
+    {
+        size_t len = xrle.size() - off < BENCH_BLOCK ? xrle.size() - off : BENCH_BLOCK;
+        rc         = xrle_decode(&dec, xrle.data() + off, len);
+    }
+
+    return rc == XRLE_DONE;
+}
+
+// write raw data in BENCH_BLOCK pieces to data_reg (like existing uncompressed loaders)
+static void bench_raw(const std::vector<uint8_t> & raw)
+{
+    for (size_t off = 0; off < raw.size(); off += BENCH_BLOCK)
+    {
+        size_t len = raw.size() - off < BENCH_BLOCK ? raw.size() - off : BENCH_BLOCK;
+        reg_literal(nullptr, raw.data() + off, static_cast<uint32_t>(len / 2));
+    }
+}
+
+// returns seconds per call of fn (repeated for at least BENCH_SECS)
+template <typename F>
+static double bench_time(F fn)
+{
+    int    reps  = 0;
+    double start = time_secs();
+    double now;
+    do
+    {
+        fn();
+        reps++;
+        now = time_secs();
+    } while (now - start < BENCH_SECS);
+
+    return (now - start) / reps;
+}
+
+static bool run_benchmark(const char * filename)
+{
+    std::vector<uint8_t> in;
+    if (!read_file(filename, &in))
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> raw;
+    std::vector<uint8_t> xrle;
+    if (in.size() >= XRLE_HEADER && xrle_check(in.data()))
+    {
+        xrle = in;
+        if (!decode_buffer(xrle, &raw))
+        {
+            printf("*** \"%s\" is corrupt XRLE data\n", filename);
+            return false;
+        }
+    }
+    else
+    {
+        raw = in;
+        raw.resize(raw.size() & ~static_cast<size_t>(1));
+        xrle.resize(XRLE_MAX_BYTES(raw.size() / 2));
+        xrle.resize(xrle_encode(raw.data(), raw.size(), xrle.data()));
+    }
+
+    // verify round trip before timing
+    std::vector<uint8_t> check;
+    if (!decode_buffer(xrle, &check) || check != raw)
+    {
+        printf("*** \"%s\" XRLE round trip mismatch\n", filename);
+        return false;
+    }
+
+    double enc_secs = bench_time([&]() {
+        std::vector<uint8_t> tmp(XRLE_MAX_BYTES(raw.size() / 2));
+        xrle_encode(raw.data(), raw.size(), tmp.data());
+    });
+    bool   ok       = true;
+    double dec_secs = bench_time([&]() { ok = bench_decode(xrle) && ok; });
+    double raw_secs = bench_time([&]() { bench_raw(raw); });
+
+    double mb = raw.size() / (1024.0 * 1024.0);
+    printf("\"%s\":\n", filename);
+    printf("  size      : %zu bytes raw, %zu bytes XRLE (%.1f%%, %.2f:1)\n",
+           raw.size(),
+           xrle.size(),
+           raw.size() ? 100.0 * xrle.size() / raw.size() : 0.0,
+           xrle.size() ? static_cast<double>(raw.size()) / xrle.size() : 0.0);
+    printf("  encode    : %9.3f ms  %8.1f MB/s\n", enc_secs * 1000.0, mb / enc_secs);
+    printf("  decode    : %9.3f ms  %8.1f MB/s (decoded words to data register, %d byte input pieces)\n",
+           dec_secs * 1000.0,
+           mb / dec_secs,
+           BENCH_BLOCK);
+    printf("  raw copy  : %9.3f ms  %8.1f MB/s (uncompressed words to data register)\n",
+           raw_secs * 1000.0,
+           mb / raw_secs);
+
+    return ok;
+}
+
+int main(int argc, char ** argv)
+{
+    printf("Xosera word RLE compressor - Xark\n\n");
+
+    std::vector<const char *> files;
+    for (int a = 1; a < argc; a++)
+    {
+        if (argv[a][0] == '-')
+        {
+            if (strcmp("-d", argv[a]) == 0)
+            {
+                decompress = true;
+            }
+            else if (strcmp("-b", argv[a]) == 0)
+            {
+                benchmark = true;
+            }
+            else
+            {
+                printf("Unexpected option: '%s'\n", argv[a]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else
+        {
+            files.push_back(argv[a]);
+        }
+    }
+
+    if (benchmark ? files.empty() : files.size() != 2)
+    {
+        printf("Usage:  xrle [-d] <input file> <output file>\n");
+        printf("        xrle -b <file> ...\n");
+        printf(" -d   decompress (default is compress)\n");
+        printf(" -b   benchmark encode and streaming decode of raw (or XRLE) files\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (benchmark)
+    {
+        bool ok = true;
+        for (auto f : files)
+        {
+            ok = run_benchmark(f) && ok;
+        }
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    std::vector<uint8_t> in;
+    std::vector<uint8_t> out;
+    if (!read_file(files[0], &in))
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    if (decompress)
+    {
+        if (!decode_buffer(in, &out))
+        {
+            printf("*** \"%s\" is not valid XRLE data\n", files[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    else
+    {
+        if (in.size() & 1)
+        {
+            printf("*** \"%s\" is an odd size (%zu bytes), Xosera data must be 16-bit words\n", files[0], in.size());
+            exit(EXIT_FAILURE);
+        }
+        out.resize(XRLE_MAX_BYTES(in.size() / 2));
+        out.resize(xrle_encode(in.data(), in.size(), out.data()));
+    }
+
+    if (!write_file(files[1], out.data(), out.size()))
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    printf("\"%s\" (%zu bytes) -> \"%s\" (%zu bytes)\n", files[0], in.size(), files[1], out.size());
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,38 @@
+/*
+ * vim: set et ts=4 sw=4
+ *------------------------------------------------------------
+ *                                  ___ ___ _
+ *  ___ ___ ___ ___ ___       _____|  _| . | |_
+ * |  _| . |_ -|  _| . |     |     | . | . | '_|
+ * |_| |___|___|___|___|_____|_|_|_|___|___|_,_|
+ *                     |_____|
+ * ------------------------------------------------------------
+ * Copyright (c) 2021 Xark
+ * MIT License
+ *
+ * Xosera VRAM and XR memory bandwidth benchmark
+ * ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <basicio.h>
+#include <machine.h>
+
+#include <debug_stub.h>
+
+extern void xosera_bench();
+
+void kmain()
+{
+    delay(15000);              // wait a bit for terminal window/serial
+    while (checkchar())        // clear any queued input
+    {
+        readchar();
+    }
+    xosera_bench();
+}
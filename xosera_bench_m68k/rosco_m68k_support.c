@@ -0,0 +1,58 @@
+//
+// rosco_m68k support routines
+//
+#include "rosco_m68k_support.h"
+
+#if !defined(checkchar)        // newer rosco_m68k library addition, this is in case not present
+bool checkchar()
+{
+    int rc;
+    __asm__ __volatile__(
+        "move.l #6,%%d1\n"        // CHECKCHAR
+        "trap   #14\n"
+        "move.b %%d0,%[rc]\n"
+        "ext.w  %[rc]\n"
+        "ext.l  %[rc]\n"
+        : [rc] "=d"(rc)
+        :
+        : "d0", "d1");
+    return rc != 0;
+}
+#endif
+
+void dputc(char c)
+{
+#ifndef __INTELLISENSE__
+    __asm__ __volatile__(
+        "move.w %[chr],%%d0\n"
+        "move.l #2,%%d1\n"        // SENDCHAR
+        "trap   #14\n"
+        :
+        : [chr] "d"(c)
+        : "d0", "d1");
+#endif
+}
+
+static char dprint_buff[4096];
+
+void dputs(const char * str)
+{
+    register char c;
+    while ((c = *str++) != '\0')
+    {
+        if (c == '\n')
+        {
+            dputc('\r');
+        }
+        dputc(c);
+    }
+}
+
+void dprintf(const char * fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(dprint_buff, sizeof(dprint_buff), fmt, args);
+    dputs(dprint_buff);
+    va_end(args);
+}
@@ -0,0 +1,429 @@
+/*
+ * vim: set et ts=4 sw=4
+ *------------------------------------------------------------
+ *                                  ___ ___ _
+ *  ___ ___ ___ ___ ___       _____|  _| . | |_
+ * |  _| . |_ -|  _| . |     |     | . | . | '_|
+ * |_| |___|___|___|___|_____|_|_|_|___|___|_,_|
+ *                     |_____|
+ * ------------------------------------------------------------
+ * Copyright (c) 2021 Xark
+ * MIT License
+ *
+ * Xosera VRAM and XR memory bandwidth benchmark
+ * ------------------------------------------------------------
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rosco_m68k_support.h"
+#include "xosera_m68k_api.h"
+
+// Each test moves BENCH_WORDS words (VRAM tests use 0x0000-0x7FFF, XR tests the first half of copper memory, as the
+// end of copper memory holds the init info).  Time is measured with XM_TIMER (1/10th ms, so a test must finish
+// within 6.5 seconds).  Every test is run with display on and blanked, and with the blitter idle and kept busy
+// (VRAM to VRAM copy within 0xE000-0xFFFF, restarted by the blit done interrupt).
+
+#define BENCH_WORDS    0x20000UL        // words transferred per test
+#define BENCH_VRAM     0x0000           // VRAM test area
+#define BENCH_VRAM_LEN 0x8000           // VRAM test area words
+#define BENCH_XR       XR_COPPER_ADDR        // XR memory test area (copper is disabled)
+#define BENCH_XR_LEN   0x0400                // XR memory test area words
+#define BENCH_BLIT_SRC 0xE000                // VRAM for blitter busy copy
+#define BENCH_BLIT_DST 0xF000
+
+#define NUM_CONDS 4        // display on/blanked x blitter idle/busy
+
+struct xosera_initdata
+{
+    char     name_version[28];
+    uint32_t githash;
+};
+
+struct xosera_initdata initdata;
+
+volatile uint32_t bench_sink;        // read results stored here so reads are not optimized away
+static bool       bench_blit_on;
+static uint16_t   bench_buffer[BENCH_VRAM_LEN];
+
+typedef struct bench
+{
+    const char * id;          // machine readable name
+    const char * name;        // description
+    void (*fn)(void);
+} bench_t;
+
+// VRAM writes (RD/WR registers)
+
+static void bench_wr_byte(void)
+{
+    xv_prep();
+    xm_setw(WR_INCR, 1);
+    xm_setw(WR_ADDR, BENCH_VRAM);
+    for (uint32_t i = BENCH_WORDS; i != 0; --i)
+    {
+        xm_setbh(DATA, 0x1F);
+        xm_setbl(DATA, (uint8_t)i);
+    }
+}
+
+static void bench_wr_word(void)
+{
+    xv_prep();
+    xm_setw(WR_INCR, 1);
+    xm_setw(WR_ADDR, BENCH_VRAM);
+    for (uint32_t i = BENCH_WORDS; i != 0; --i)
+    {
+        xm_setw(DATA, (uint16_t)i);
+    }
+}
+
+static void bench_wr_long(void)
+{
+    xv_prep();
+    xm_setw(WR_INCR, 1);
+    xm_setw(WR_ADDR, BENCH_VRAM);
+    for (uint32_t i = BENCH_WORDS / 2; i != 0; --i)
+    {
+        xm_setl(DATA, i);
+    }
+}
+
+static void bench_wr_bulk(void)
+{
+    for (uint16_t i = 0; i < BENCH_WORDS / BENCH_VRAM_LEN; i++)
+    {
+        xv_vram_write(BENCH_VRAM, bench_buffer, BENCH_VRAM_LEN);
+    }
+}
+
+// VRAM reads (RD/WR registers)
+
+static void bench_rd_byte(void)
+{
+    xv_prep();
+    uint16_t v = 0;
+    xm_setw(RD_INCR, 1);
+    xm_setw(RD_ADDR, BENCH_VRAM);
+    for (uint32_t i = BENCH_WORDS; i != 0; --i)
+    {
+        v += xm_getbh(DATA);
+        v += xm_getbl(DATA);
+    }
+    bench_sink = v;
+}
+
+static void bench_rd_word(void)
+{
+    xv_prep();
+    uint16_t v = 0;
+    xm_setw(RD_INCR, 1);
+    xm_setw(RD_ADDR, BENCH_VRAM);
+    for (uint32_t i = BENCH_WORDS; i != 0; --i)
+    {
+        v += xm_getw(DATA);
+    }
+    bench_sink = v;
+}
+
+static void bench_rd_long(void)
+{
+    xv_prep();
+    uint32_t v = 0;
+    xm_setw(RD_INCR, 1);
+    xm_setw(RD_ADDR, BENCH_VRAM);
+    for (uint32_t i = BENCH_WORDS / 2; i != 0; --i)
+    {
+        v += xm_getl(DATA);
+    }
+    bench_sink = v;
+}
+
+static void bench_rd_bulk(void)
+{
+    for (uint16_t i = 0; i < BENCH_WORDS / BENCH_VRAM_LEN; i++)
+    {
+        xv_vram_read(BENCH_VRAM, bench_buffer, BENCH_VRAM_LEN);
+    }
+}
+
+static void bench_copy_bulk(void)
+{
+    for (uint16_t i = 0; i < BENCH_WORDS / (BENCH_VRAM_LEN / 2); i++)
+    {
+        xv_vram_copy(BENCH_VRAM + BENCH_VRAM_LEN / 2, BENCH_VRAM, BENCH_VRAM_LEN / 2);
+    }
+}
+
+// VRAM writes and reads (RW registers)
+
+static void bench_rw_wr_word(void)
+{
+    xv_prep();
+    xm_setw(RW_INCR, 1);
+    xm_setw(RW_ADDR, BENCH_VRAM);
+    for (uint32_t i = BENCH_WORDS; i != 0; --i)
+    {
+        xm_setw(RW_DATA, (uint16_t)i);
+    }
+}
+
+static void bench_rw_wr_long(void)
+{
+    xv_prep();
+    xm_setw(RW_INCR, 1);
+    xm_setw(RW_ADDR, BENCH_VRAM);
+    for (uint32_t i = BENCH_WORDS / 2; i != 0; --i)
+    {
+        xm_setl(RW_DATA, i);
+    }
+}
+
+static void bench_rw_rd_word(void)
+{
+    xv_prep();
+    uint16_t v        = 0;
+    uint8_t  sys_ctrl = xm_getbl(SYS_CTRL) & 0x1F;
+    xm_setbl(SYS_CTRL, sys_ctrl | 0x10);        // RW_DATA reads add RW_INCR
+    xm_setw(RW_INCR, 1);
+    xm_setw(RW_ADDR, BENCH_VRAM);
+    for (uint32_t i = BENCH_WORDS; i != 0; --i)
+    {
+        v += xm_getw(RW_DATA);
+    }
+    xm_setbl(SYS_CTRL, sys_ctrl);
+    bench_sink = v;
+}
+
+static void bench_rw_rd_long(void)
+{
+    xv_prep();
+    uint32_t v        = 0;
+    uint8_t  sys_ctrl = xm_getbl(SYS_CTRL) & 0x1F;
+    xm_setbl(SYS_CTRL, sys_ctrl | 0x10);
+    xm_setw(RW_INCR, 1);
+    xm_setw(RW_ADDR, BENCH_VRAM);
+    for (uint32_t i = BENCH_WORDS / 2; i != 0; --i)
+    {
+        v += xm_getl(RW_DATA);
+    }
+    xm_setbl(SYS_CTRL, sys_ctrl);
+    bench_sink = v;
+}
+
+// XR memory
+
+static void bench_xr_wr_word(void)
+{
+    xv_prep();
+    for (uint32_t j = BENCH_WORDS / BENCH_XR_LEN; j != 0; --j)
+    {
+        xm_setw(XR_ADDR, BENCH_XR);        // XR_DATA writes increment XR_ADDR
+        for (uint16_t i = BENCH_XR_LEN; i != 0; --i)
+        {
+            xm_setw(XR_DATA, i);
+        }
+    }
+}
+
+static void bench_xr_wr_long(void)
+{
+    xv_prep();
+    for (uint32_t j = BENCH_WORDS / BENCH_XR_LEN; j != 0; --j)
+    {
+        for (uint16_t i = 0; i < BENCH_XR_LEN; i++)
+        {
+            xm_setl(XR_ADDR, ((uint32_t)(BENCH_XR + i) << 16) | i);        // XR_ADDR and XR_DATA
+        }
+    }
+}
+
+static void bench_xr_rd_word(void)
+{
+    xv_prep();
+    uint16_t v = 0;
+    for (uint32_t j = BENCH_WORDS / BENCH_XR_LEN; j != 0; --j)
+    {
+        for (uint16_t i = 0; i < BENCH_XR_LEN; i++)
+        {
+            v += xmem_getw_wait(BENCH_XR + i);
+        }
+    }
+    bench_sink = v;
+}
+
+static const bench_t benches[] = {
+    {"vram_wr_byte", "VRAM write MOVE.B  (RD/WR)", bench_wr_byte},
+    {"vram_wr_word", "VRAM write MOVEP.W (RD/WR)", bench_wr_word},
+    {"vram_wr_long", "VRAM write MOVEP.L (RD/WR)", bench_wr_long},
+    {"vram_wr_bulk", "VRAM write xv_vram_write", bench_wr_bulk},
+    {"vram_rd_byte", "VRAM read  MOVE.B  (RD/WR)", bench_rd_byte},
+    {"vram_rd_word", "VRAM read  MOVEP.W (RD/WR)", bench_rd_word},
+    {"vram_rd_long", "VRAM read  MOVEP.L (RD/WR)", bench_rd_long},
+    {"vram_rd_bulk", "VRAM read  xv_vram_read", bench_rd_bulk},
+    {"vram_copy_bulk", "VRAM copy  xv_vram_copy", bench_copy_bulk},
+    {"rw_wr_word", "VRAM write MOVEP.W (RW)", bench_rw_wr_word},
+    {"rw_wr_long", "VRAM write MOVEP.L (RW)", bench_rw_wr_long},
+    {"rw_rd_word", "VRAM read  MOVEP.W (RW)", bench_rw_rd_word},
+    {"rw_rd_long", "VRAM read  MOVEP.L (RW)", bench_rw_rd_long},
+    {"xr_wr_word", "XR write   MOVEP.W data", bench_xr_wr_word},
+    {"xr_wr_long", "XR write   MOVEP.L addr+data", bench_xr_wr_long},
+    {"xr_rd_word", "XR read    addr+wait+data", bench_xr_rd_word},
+};
+
+static uint32_t bench_ticks[NUM_ELEMENTS(benches)][NUM_CONDS];        // 1/10th ms per test
+
+// blit done interrupt, keep blitter busy with another copy (XR_ADDR restored by dispatcher)
+static void bench_blit_restart(void)
+{
+    if (bench_blit_on)
+    {
+        // 64 lines of 4096 words, -4096 stride so each line re-copies the same words
+        xv_blit_copy(BENCH_BLIT_DST, 0, BENCH_BLIT_SRC, 0, 0x1000, 64);
+    }
+}
+
+static void bench_blit(bool on)
+{
+    bench_blit_on = on;
+    if (on)
+    {
+        xv_intr_set(INTR_BLIT_B, bench_blit_restart);
+        bench_blit_restart();
+    }
+    else
+    {
+        while (xv_blit_pending())
+            ;
+        xv_intr_set(INTR_BLIT_B, NULL);
+    }
+}
+
+static void bench_display(bool on, uint16_t pa_gfx_ctrl, uint16_t pb_gfx_ctrl)
+{
+    xv_prep();
+
+    xreg_setw(PA_GFX_CTRL, on ? pa_gfx_ctrl : (pa_gfx_ctrl | 0x0080));        // GFX_CTRL[7] blank
+    xreg_setw(PB_GFX_CTRL, on ? pb_gfx_ctrl : (pb_gfx_ctrl | 0x0080));
+}
+
+static uint32_t words_per_sec(uint32_t ticks)
+{
+    return ticks ? (uint32_t)((BENCH_WORDS * 10000UL) / ticks) : 0;
+}
+
+static const char * cond_name(uint8_t cond)
+{
+    static const char * names[NUM_CONDS] = {"on,idle", "on,busy", "blank,idle", "blank,busy"};
+
+    return names[cond];
+}
+
+void xosera_bench()
+{
+    xv_prep();
+
+    dprintf("\033cXosera_bench_m68k\n");
+
+    bool success = xosera_init(0);
+    dprintf(
+        "xosera_init(0) %s (%dx%d)\n", success ? "succeeded" : "FAILED", xreg_getw(VID_HSIZE), xreg_getw(VID_VSIZE));
+    if (!success)
+    {
+        return;
+    }
+    char * init_ptr = (char *)&initdata;
+    for (int i = XR_COPPER_ADDR + XR_COPPER_SIZE - 16; i < XR_COPPER_ADDR + XR_COPPER_SIZE; i++)
+    {
+        *init_ptr++ = (char)xmem_getbh_wait(i);
+        *init_ptr++ = (char)xm_getbl(XR_DATA);
+    }
+    initdata.name_version[sizeof(initdata.name_version) - 1] = '\0';
+    uint16_t features = xreg_getw(VERSION);
+    dprintf("Xosera [%04x] Git:0x%08x ID:\"%s\"\n",
+            (unsigned int)features,
+            (unsigned int)initdata.githash,
+            initdata.name_version);
+
+    xreg_setw(COPP_CTRL, 0x0000);        // disable copper (XR test writes copper memory)
+    uint16_t pa_gfx_ctrl = xreg_getw(PA_GFX_CTRL);
+    uint16_t pb_gfx_ctrl = xreg_getw(PB_GFX_CTRL);
+    xv_intr_install();
+
+    dprintf("Running %u tests x %d conditions (%u words each)",
+            (unsigned int)NUM_ELEMENTS(benches),
+            NUM_CONDS,
+            (unsigned int)BENCH_WORDS);
+    bool aborted = false;
+    for (uint8_t cond = 0; cond < NUM_CONDS && !aborted; cond++)
+    {
+        bench_display(!(cond & 2), pa_gfx_ctrl, pb_gfx_ctrl);
+        bench_blit(cond & 1);
+        for (uint16_t b = 0; b < NUM_ELEMENTS(benches); b++)
+        {
+            uint16_t start = xm_getw(TIMER);
+            benches[b].fn();
+            uint16_t stop        = xm_getw(TIMER);
+            bench_ticks[b][cond] = (uint16_t)(stop - start);
+            if (checkchar())
+            {
+                aborted = true;
+                break;
+            }
+        }
+        bench_blit(false);
+        dprintf(".");
+    }
+    bench_display(true, pa_gfx_ctrl, pb_gfx_ctrl);
+    xv_intr_remove();
+    dprintf("\n\n");
+
+    if (aborted)
+    {
+        readchar();
+        dprintf("Aborted.\n");
+    }
+    else
+    {
+        dprintf("%-28s %10s %10s %10s %10s  (words/sec)\n",
+                "Display, blitter:",
+                cond_name(0),
+                cond_name(1),
+                cond_name(2),
+                cond_name(3));
+        for (uint16_t b = 0; b < NUM_ELEMENTS(benches); b++)
+        {
+            dprintf("%-28s", benches[b].name);
+            for (uint8_t cond = 0; cond < NUM_CONDS; cond++)
+            {
+                dprintf(" %10u", (unsigned int)words_per_sec(bench_ticks[b][cond]));
+            }
+            dprintf("\n");
+        }
+
+        // machine readable: BENCH,<githash>,<test>,<display>,<blitter>,<words>,<tenth ms>,<words/sec>
+        dprintf("\n");
+        for (uint16_t b = 0; b < NUM_ELEMENTS(benches); b++)
+        {
+            for (uint8_t cond = 0; cond < NUM_CONDS; cond++)
+            {
+                dprintf("BENCH,%08x,%s,%s,%s,%u,%u,%u\n",
+                        (unsigned int)initdata.githash,
+                        benches[b].id,
+                        (cond & 2) ? "blank" : "on",
+                        (cond & 1) ? "busy" : "idle",
+                        (unsigned int)BENCH_WORDS,
+                        (unsigned int)bench_ticks[b][cond],
+                        (unsigned int)words_per_sec(bench_ticks[b][cond]));
+            }
+        }
+    }
+
+    xosera_init(0);        // restore display (VRAM and copper memory were overwritten)
+    dprintf("\nDone.\n");
+}
@@ -827,15 +827,6 @@ void vram_sequence_tiled(int      width_tiles,
     }
 }
 
-void copper_load_list(uint16_t length, uint32_t list[length], uint16_t base)
-{
-    for (uint16_t i = 0; i < length; ++i)
-    {
-        xmem_setw(base + i * 2 + 0, (list[i] >> 16) & 0xFFFF);
-        xmem_setw(base + i * 2 + 1, (list[i] >> 0) & 0xFFFF);
-    }
-}
-
 void xosera_boing()
 {
     xosera_init(xreg_getw(VID_HSIZE) > 640 ? 1 : 0);
@@ -856,7 +847,7 @@ void xosera_boing()
 #endif
 
 #if USE_COPPER
-    copper_load_list(sizeof copper_list / sizeof copper_list[0], copper_list, XR_COPPER_ADDR);
+    xv_copper_load(0, copper_list, sizeof copper_list / sizeof copper_list[0]);
 #endif
 
     xreg_setw(PA_GFX_CTRL, MAKE_GFX_CTRL(0x00, 0, XR_GFX_BPP_1, 1, 1, 1));
@@ -0,0 +1,282 @@
+/*
+ * vim: set et ts=4 sw=4
+ *------------------------------------------------------------
+ *  __ __
+ * |  |  |___ ___ ___ ___ ___
+ * |-   -| . |_ -| -_|  _| .'|
+ * |__|__|___|___|___|_| |__,|
+ *
+ * Xark's Open Source Enhanced Retro Adapter
+ *
+ * - "Not as clumsy or random as a GPU, an embedded retro
+ *    adapter for a more civilized age."
+ *
+ * ------------------------------------------------------------
+ * Copyright (c) 2021 Xark
+ * MIT License
+ *
+ * Xosera host register model for building m68k API code natively
+ * ------------------------------------------------------------
+ */
+
+#include <string.h>
+
+#include "xv_host_model.h"
+
+// Models the XM registers as in rtl/reg_interface.sv: an even byte write is latched and the odd byte write completes
+// the register write (starting any VRAM/XR access), reading the odd byte of XM_DATA/XM_RW_DATA pre-reads the next
+// word.  VRAM and XR memory accesses complete instantly (so SYS_CTRL mem_wait is never set).  Interrupts, blitter,
+// copper and video are not modelled.
+
+// 68000 instruction cycles for the register access each macro uses
+#define CYCLES_MOVEP_L 24
+#define CYCLES_MOVEP_W 16
+#define CYCLES_MOVE_B  12
+
+xmreg_t          xv_model_regs[16];
+uint16_t         xv_model_vram[65536];
+xv_model_stats_t xv_model_stats;
+
+static uint16_t xv_model_xr[65536];        // XR registers and memory (sparse regions used)
+
+static struct
+{
+    uint16_t xr_addr;
+    uint16_t xr_data;
+    uint16_t rd_incr;
+    uint16_t rd_addr;
+    uint16_t rd_data;
+    uint16_t wr_incr;
+    uint16_t wr_addr;
+    uint16_t rw_incr;
+    uint16_t rw_addr;
+    uint16_t rw_data;
+    uint8_t  even[16];        // latched even byte per register
+    uint8_t  intr_mask;
+    uint8_t  wrmask;
+    bool     rw_rd_inc;
+} regs;
+
+void xv_model_reset(void)
+{
+    memset(&regs, 0, sizeof(regs));
+    regs.wrmask = 0xF;
+    memset(xv_model_vram, 0, sizeof(xv_model_vram));
+    memset(xv_model_xr, 0, sizeof(xv_model_xr));
+    memset(&xv_model_stats, 0, sizeof(xv_model_stats));
+}
+
+static uint16_t vram_read(uint16_t addr)
+{
+    xv_model_stats.vram_reads++;
+    return xv_model_vram[addr];
+}
+
+static void vram_write(uint16_t addr, uint16_t data)
+{
+    uint16_t mask = ((regs.wrmask & 0x8) ? 0xF000 : 0) | ((regs.wrmask & 0x4) ? 0x0F00 : 0) |
+                    ((regs.wrmask & 0x2) ? 0x00F0 : 0) | ((regs.wrmask & 0x1) ? 0x000F : 0);
+
+    xv_model_stats.vram_writes++;
+    xv_model_vram[addr] = (uint16_t)((xv_model_vram[addr] & ~mask) | (data & mask));
+}
+
+// register number (0-15) for XM_* offset xm_reg relative to ptr (which may be offset from xv_model_regs)
+static uint8_t reg_num(volatile xmreg_t * ptr, uint8_t xm_reg)
+{
+    return (uint8_t)(((ptr - (volatile xmreg_t *)xv_model_regs) + (xm_reg >> 2)) & 0xF);
+}
+
+uint16_t xv_model_reg(uint8_t xm_reg)
+{
+    switch (xm_reg)
+    {
+        case XM_XR_ADDR:
+            return regs.xr_addr;
+        case XM_XR_DATA:
+            return regs.xr_data;
+        case XM_RD_INCR:
+            return regs.rd_incr;
+        case XM_RD_ADDR:
+            return regs.rd_addr;
+        case XM_WR_INCR:
+            return regs.wr_incr;
+        case XM_WR_ADDR:
+            return regs.wr_addr;
+        case XM_DATA:
+        case XM_DATA_2:
+            return regs.rd_data;
+        case XM_SYS_CTRL:
+            return (uint16_t)((regs.intr_mask << 8) | (regs.rw_rd_inc ? 0x10 : 0) | regs.wrmask);
+        case XM_RW_INCR:
+            return regs.rw_incr;
+        case XM_RW_ADDR:
+            return regs.rw_addr;
+        case XM_RW_DATA:
+        case XM_RW_DATA_2:
+            return regs.rw_data;
+        default:
+            return 0;
+    }
+}
+
+static uint8_t read_byte(uint8_t r, bool odd)
+{
+    uint16_t v = xv_model_reg((uint8_t)(r << 2));
+
+    xv_model_stats.reg_reads++;
+    if (odd)
+    {
+        // odd byte read of data registers pre-reads next word
+        if (r == (XM_DATA >> 2) || r == (XM_DATA_2 >> 2))
+        {
+            regs.rd_data = vram_read(regs.rd_addr);
+            regs.rd_addr = (uint16_t)(regs.rd_addr + regs.rd_incr);
+        }
+        else if (r == (XM_RW_DATA >> 2) || r == (XM_RW_DATA_2 >> 2))
+        {
+            regs.rw_data = vram_read(regs.rw_addr);
+            if (regs.rw_rd_inc)
+            {
+                regs.rw_addr = (uint16_t)(regs.rw_addr + regs.rw_incr);
+            }
+        }
+        return (uint8_t)v;
+    }
+
+    return (uint8_t)(v >> 8);
+}
+
+static void write_byte(uint8_t r, bool odd, uint8_t data)
+{
+    xv_model_stats.reg_writes++;
+    if (!odd)
+    {
+        regs.even[r] = data;
+        if (r == (XM_SYS_CTRL >> 2))
+        {
+            regs.intr_mask = data & 0xF;
+        }
+        return;
+    }
+
+    uint16_t word = (uint16_t)((regs.even[r] << 8) | data);
+    switch (r << 2)
+    {
+        case XM_XR_ADDR:
+            regs.xr_addr = word;
+            regs.xr_data = xv_model_xr[word];
+            break;
+        case XM_XR_DATA:
+            xv_model_xr[regs.xr_addr] = word;
+            regs.xr_addr++;
+            break;
+        case XM_RD_INCR:
+            regs.rd_incr = word;
+            break;
+        case XM_RD_ADDR:
+            regs.rd_addr = word;
+            regs.rd_data = vram_read(regs.rd_addr);
+            regs.rd_addr = (uint16_t)(regs.rd_addr + regs.rd_incr);
+            break;
+        case XM_WR_INCR:
+            regs.wr_incr = word;
+            break;
+        case XM_WR_ADDR:
+            regs.wr_addr = word;
+            break;
+        case XM_DATA:
+        case XM_DATA_2:
+            vram_write(regs.wr_addr, word);
+            regs.wr_addr = (uint16_t)(regs.wr_addr + regs.wr_incr);
+            break;
+        case XM_SYS_CTRL:
+            regs.rw_rd_inc = (data & 0x10) != 0;
+            regs.wrmask    = data & 0xF;
+            break;
+        case XM_RW_INCR:
+            regs.rw_incr = word;
+            break;
+        case XM_RW_ADDR:
+            regs.rw_addr = word;
+            regs.rw_data = vram_read(regs.rw_addr);
+            if (regs.rw_rd_inc)
+            {
+                regs.rw_addr = (uint16_t)(regs.rw_addr + regs.rw_incr);
+            }
+            break;
+        case XM_RW_DATA:
+        case XM_RW_DATA_2:
+            vram_write(regs.rw_addr, word);
+            regs.rw_addr = (uint16_t)(regs.rw_addr + regs.rw_incr);
+            break;
+        default:
+            break;
+    }
+}
+
+void xv_model_bus_write(uint8_t reg_num, bool odd, uint8_t val)
+{
+    write_byte(reg_num & 0xF, odd, val);
+}
+
+uint8_t xv_model_bus_read(uint8_t reg_num, bool odd)
+{
+    return read_byte(reg_num & 0xF, odd);
+}
+
+void xv_model_setb(volatile xmreg_t * ptr, uint8_t xm_reg, bool odd, uint8_t val)
+{
+    xv_model_stats.cycles += CYCLES_MOVE_B;
+    write_byte(reg_num(ptr, xm_reg), odd, val);
+}
+
+uint8_t xv_model_getb(volatile xmreg_t * ptr, uint8_t xm_reg, bool odd)
+{
+    xv_model_stats.cycles += CYCLES_MOVE_B;
+    return read_byte(reg_num(ptr, xm_reg), odd);
+}
+
+void xv_model_setw(volatile xmreg_t * ptr, uint8_t xm_reg, uint16_t val)
+{
+    uint8_t r = reg_num(ptr, xm_reg);
+    xv_model_stats.cycles += CYCLES_MOVEP_W;
+    write_byte(r, false, (uint8_t)(val >> 8));
+    write_byte(r, true, (uint8_t)val);
+    xv_model_stats.reg_writes--;        // count MOVEP as one access
+}
+
+uint16_t xv_model_getw(volatile xmreg_t * ptr, uint8_t xm_reg)
+{
+    uint8_t r = reg_num(ptr, xm_reg);
+    xv_model_stats.cycles += CYCLES_MOVEP_W;
+    uint16_t v = (uint16_t)(read_byte(r, false) << 8);
+    v |= read_byte(r, true);
+    xv_model_stats.reg_reads--;
+
+    return v;
+}
+
+void xv_model_setl(volatile xmreg_t * ptr, uint8_t xm_reg, uint32_t val)
+{
+    uint8_t r = reg_num(ptr, xm_reg);
+    xv_model_stats.cycles += CYCLES_MOVEP_L;
+    write_byte(r, false, (uint8_t)(val >> 24));
+    write_byte(r, true, (uint8_t)(val >> 16));
+    write_byte((r + 1) & 0xF, false, (uint8_t)(val >> 8));
+    write_byte((r + 1) & 0xF, true, (uint8_t)val);
+    xv_model_stats.reg_writes -= 3;
+}
+
+uint32_t xv_model_getl(volatile xmreg_t * ptr, uint8_t xm_reg)
+{
+    uint8_t r = reg_num(ptr, xm_reg);
+    xv_model_stats.cycles += CYCLES_MOVEP_L;
+    uint32_t v = (uint32_t)read_byte(r, false) << 24;
+    v |= (uint32_t)read_byte(r, true) << 16;
+    v |= (uint32_t)read_byte((r + 1) & 0xF, false) << 8;
+    v |= read_byte((r + 1) & 0xF, true);
+    xv_model_stats.reg_reads -= 3;
+
+    return v;
+}
@@ -0,0 +1,86 @@
+/*
+ * vim: set et ts=4 sw=4
+ *------------------------------------------------------------
+ *  __ __
+ * |  |  |___ ___ ___ ___ ___
+ * |-   -| . |_ -| -_|  _| .'|
+ * |__|__|___|___|___|_| |__,|
+ *
+ * Xark's Open Source Enhanced Retro Adapter
+ *
+ * - "Not as clumsy or random as a GPU, an embedded retro
+ *    adapter for a more civilized age."
+ *
+ * ------------------------------------------------------------
+ * Copyright (c) 2021 Xark
+ * MIT License
+ *
+ * Xosera host register model for building m68k API code natively
+ * ------------------------------------------------------------
+ */
+
+// Including this instead of xosera_m68k_api.h (when XV_HOST_MODEL is defined) replaces the MOVEP based XM register
+// access macros with calls into an in-process model of the XM registers and VRAM (following rtl/reg_interface.sv
+// byte level behavior).  Each access also adds the 68000/68010 cycle count of the instruction the real macro uses
+// (MOVEP.L 24, MOVEP.W 16, MOVE.B 12) so register traffic of API routines can be compared off-target.  RAM access and
+// loop overhead are not counted.
+
+#if !defined(XV_HOST_MODEL_H)
+#define XV_HOST_MODEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if !defined(XV_PREP_REQUIRED)
+#define XV_PREP_REQUIRED
+#endif
+#include "xosera_m68k_api.h"
+
+typedef struct _xv_model_stats
+{
+    uint32_t reg_reads;         // XM register word/byte/long reads
+    uint32_t reg_writes;        // XM register word/byte/long writes
+    uint32_t vram_reads;        // VRAM words read (including pre-reads)
+    uint32_t vram_writes;       // VRAM words written
+    uint32_t cycles;            // 68000 cycles of register access instructions
+} xv_model_stats_t;
+
+extern xmreg_t          xv_model_regs[16];        // stands in for XM_BASEADDR (only used for address arithmetic)
+extern uint16_t         xv_model_vram[65536];     // 64K words of VRAM
+extern xv_model_stats_t xv_model_stats;
+
+void     xv_model_reset(void);               // reset registers, clear VRAM and stats
+uint16_t xv_model_reg(uint8_t xm_reg);        // peek at register (XM_* offset) without side effects
+
+// byte access to register reg_num (0-15) as seen on the bus (for CPU emulators, no cycles added)
+void    xv_model_bus_write(uint8_t reg_num, bool odd, uint8_t val);
+uint8_t xv_model_bus_read(uint8_t reg_num, bool odd);
+
+void     xv_model_setb(volatile xmreg_t * ptr, uint8_t xm_reg, bool odd, uint8_t val);
+uint8_t  xv_model_getb(volatile xmreg_t * ptr, uint8_t xm_reg, bool odd);
+void     xv_model_setw(volatile xmreg_t * ptr, uint8_t xm_reg, uint16_t val);
+uint16_t xv_model_getw(volatile xmreg_t * ptr, uint8_t xm_reg);
+void     xv_model_setl(volatile xmreg_t * ptr, uint8_t xm_reg, uint32_t val);
+uint32_t xv_model_getl(volatile xmreg_t * ptr, uint8_t xm_reg);
+
+#undef xv_prep
+#undef xm_setbh
+#undef xm_setbl
+#undef xm_setw
+#undef xm_setl
+#undef xm_getbh
+#undef xm_getbl
+#undef xm_getw
+#undef xm_getl
+
+#define xv_prep()                  volatile xmreg_t * const xosera_ptr = xv_model_regs
+#define xm_setbh(xmreg, high_byte) xv_model_setb(xosera_ptr, XM_##xmreg, false, (high_byte))
+#define xm_setbl(xmreg, low_byte)  xv_model_setb(xosera_ptr, XM_##xmreg, true, (low_byte))
+#define xm_setw(xmreg, word_value) xv_model_setw(xosera_ptr, XM_##xmreg, (word_value))
+#define xm_setl(xmreg, long_value) xv_model_setl(xosera_ptr, XM_##xmreg, (long_value))
+#define xm_getbh(xmreg)            xv_model_getb(xosera_ptr, XM_##xmreg, false)
+#define xm_getbl(xmreg)            xv_model_getb(xosera_ptr, XM_##xmreg, true)
+#define xm_getw(xmreg)             xv_model_getw(xosera_ptr, XM_##xmreg)
+#define xm_getl(xmreg)             xv_model_getl(xosera_ptr, XM_##xmreg)
+
+#endif        // XV_HOST_MODEL_H
@@ -0,0 +1,554 @@
+/*
+ * vim: set et ts=4 sw=4
+ *------------------------------------------------------------
+ *  __ __
+ * |  |  |___ ___ ___ ___ ___
+ * |-   -| . |_ -| -_|  _| .'|
+ * |__|__|___|___|___|_| |__,|
+ *
+ * Xark's Open Source Enhanced Retro Adapter
+ *
+ * - "Not as clumsy or random as a GPU, an embedded retro
+ *    adapter for a more civilized age."
+ *
+ * ------------------------------------------------------------
+ * Copyright (c) 2021 Xark
+ * MIT License
+ *
+ * Host 68010 emulation harness to count cycles of functions in a rosco_m68k Xosera program ELF
+ * ------------------------------------------------------------
+ */
+
+// Runs functions of a rosco_m68k program ELF (e.g., xosera_vramtest_m68k.elf) one instruction at a time on the Musashi
+// 68000 family emulator (https://github.com/kstenerud/Musashi, built from source by the Makefile) with the XM
+// registers at XM_BASEADDR mapped to the register model in xv_host_model.c.  For each function named on the command
+// line it reports the cycles and instructions from call to return, XM register byte accesses and VRAM words, and the
+// cycles spent in each function called (by symbol).
+//
+// Memory map: 1MB RAM (program loaded from its PT_LOAD segments, stack at top), Xosera registers at XM_BASEADDR, all
+// else reads 0.  Every exception vector points at an RTE, so firmware traps (printing etc.) return without doing
+// anything.  Cycles are Musashi 68010 instruction timings with no wait states (real Xosera bus accesses may be slower).
+// Functions run in command line order without reloading, so initialization functions can be listed first.
+//
+// Functions are found by .symtab name, including static (local) functions.  If there is no exact match, a single gcc
+// clone of the function (e.g., "fill_LFSR.part.0" or ".constprop.0") is used instead.
+//
+// usage: xv_m68k_prof [-l max_instructions] program.elf function[:arg,arg...] ...
+// (each arg is a number or the name of a symbol for its address, pushed as a long)
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "m68k.h"
+#include "xv_host_model.h"
+
+#define RAM_SIZE         0x100000                        // 1MB
+#define XV_RTE_ADDR      0x000400                        // RTE for all exception vectors
+#define XV_RETURN_ADDR   0x000404                        // return address of called function (STOP)
+#define XV_STACK_TOP     RAM_SIZE                        // initial supervisor stack
+#define XV_XM_END        (XM_BASEADDR + (16 * 4))        // end of XM register addresses
+#define XV_MAX_ARGS      8
+#define XV_DEFAULT_LIMIT 100000000UL
+
+#if !defined(XV_MUSASHI_VERSION)
+#define XV_MUSASHI_VERSION "unknown"        // Musashi revision (set by Makefile)
+#endif
+
+typedef struct _xv_sym
+{
+    uint32_t     addr;
+    uint32_t     size;
+    const char * name;
+    bool         func;               // function (else data object)
+    uint64_t     self_cycles;        // cycles of instructions within symbol (for current function)
+} xv_sym_t;
+
+static uint8_t    ram[RAM_SIZE];
+static uint8_t *  elf_data;
+static size_t     elf_size;
+static xv_sym_t * syms;
+static size_t     num_syms;
+
+// Musashi memory callbacks
+
+static bool is_xm(unsigned int address)
+{
+    return address >= XM_BASEADDR && address < XV_XM_END;
+}
+
+static unsigned int xm_read(unsigned int address)
+{
+    uint32_t offset = address - XM_BASEADDR;
+    if (offset & 1)
+    {
+        return 0xFF;        // pad byte lanes are not connected
+    }
+    return xv_model_bus_read((uint8_t)(offset >> 2), (offset & 2) != 0);
+}
+
+static void xm_write(unsigned int address, unsigned int value)
+{
+    uint32_t offset = address - XM_BASEADDR;
+    if (!(offset & 1))
+    {
+        xv_model_bus_write((uint8_t)(offset >> 2), (offset & 2) != 0, (uint8_t)value);
+    }
+}
+
+unsigned int m68k_read_memory_8(unsigned int address)
+{
+    address &= 0xFFFFFF;
+    if (address < RAM_SIZE)
+    {
+        return ram[address];
+    }
+    if (is_xm(address))
+    {
+        return xm_read(address);
+    }
+    return 0;
+}
+
+unsigned int m68k_read_memory_16(unsigned int address)
+{
+    return (m68k_read_memory_8(address) << 8) | m68k_read_memory_8(address + 1);
+}
+
+unsigned int m68k_read_memory_32(unsigned int address)
+{
+    return (m68k_read_memory_16(address) << 16) | m68k_read_memory_16(address + 2);
+}
+
+unsigned int m68k_read_disassembler_16(unsigned int address)
+{
+    return m68k_read_memory_16(address);
+}
+
+unsigned int m68k_read_disassembler_32(unsigned int address)
+{
+    return m68k_read_memory_32(address);
+}
+
+void m68k_write_memory_8(unsigned int address, unsigned int value)
+{
+    address &= 0xFFFFFF;
+    if (address < RAM_SIZE)
+    {
+        ram[address] = (uint8_t)value;
+    }
+    else if (is_xm(address))
+    {
+        xm_write(address, value);
+    }
+}
+
+void m68k_write_memory_16(unsigned int address, unsigned int value)
+{
+    m68k_write_memory_8(address, value >> 8);
+    m68k_write_memory_8(address + 1, value);
+}
+
+void m68k_write_memory_32(unsigned int address, unsigned int value)
+{
+    m68k_write_memory_16(address, value >> 16);
+    m68k_write_memory_16(address + 2, value);
+}
+
+// ELF loading (32-bit big-endian m68k)
+
+static uint32_t be16(const uint8_t * p)
+{
+    return ((uint32_t)p[0] << 8) | p[1];
+}
+
+static uint32_t be32(const uint8_t * p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static bool elf_read(const char * filename)
+{
+    FILE * fp = fopen(filename, "rb");
+    if (fp == NULL)
+    {
+        perror(filename);
+        return false;
+    }
+    fseek(fp, 0, SEEK_END);
+    elf_size = (size_t)ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    elf_data = malloc(elf_size);
+    bool ok  = elf_data != NULL && fread(elf_data, 1, elf_size, fp) == elf_size;
+    fclose(fp);
+
+    if (!ok || elf_size < 52 || memcmp(elf_data, "\177ELF\001\002", 6) != 0 || be16(elf_data + 18) != 4)
+    {
+        fprintf(stderr, "%s: not a 32-bit big-endian m68k ELF\n", filename);
+        return false;
+    }
+
+    return true;
+}
+
+// copy PT_LOAD segments to RAM (and zero BSS)
+static bool elf_load(void)
+{
+    uint32_t phoff = be32(elf_data + 28);
+    uint32_t phent = be16(elf_data + 42);
+    uint32_t phnum = be16(elf_data + 44);
+
+    for (uint32_t i = 0; i < phnum; i++)
+    {
+        const uint8_t * ph = elf_data + phoff + i * phent;
+        if (be32(ph + 0) != 1)        // PT_LOAD
+        {
+            continue;
+        }
+        uint32_t offset = be32(ph + 4);
+        uint32_t paddr  = be32(ph + 12);
+        uint32_t filesz = be32(ph + 16);
+        uint32_t memsz  = be32(ph + 20);
+        if (paddr + memsz > RAM_SIZE || offset + filesz > elf_size)
+        {
+            fprintf(stderr, "segment at 0x%06x (0x%x bytes) outside RAM\n", paddr, memsz);
+            return false;
+        }
+        memcpy(ram + paddr, elf_data + offset, filesz);
+        memset(ram + paddr + filesz, 0, memsz - filesz);
+    }
+
+    return true;
+}
+
+static int sym_compare(const void * a, const void * b)
+{
+    const xv_sym_t * sa = a;
+    const xv_sym_t * sb = b;
+
+    return sa->addr < sb->addr ? -1 : sa->addr > sb->addr;
+}
+
+// read function and data object symbols from .symtab (local and global, defined only)
+static void elf_symbols(void)
+{
+    uint32_t shoff = be32(elf_data + 32);
+    uint32_t shent = be16(elf_data + 46);
+    uint32_t shnum = be16(elf_data + 48);
+
+    for (uint32_t i = 0; i < shnum; i++)
+    {
+        const uint8_t * sh = elf_data + shoff + i * shent;
+        if (be32(sh + 4) != 2)        // SHT_SYMTAB
+        {
+            continue;
+        }
+        const uint8_t * strsh   = elf_data + shoff + be32(sh + 24) * shent;
+        const char *    strtab  = (const char *)elf_data + be32(strsh + 16);
+        const uint8_t * symtab  = elf_data + be32(sh + 16);
+        uint32_t        entsize = be32(sh + 36);
+        uint32_t        count   = be32(sh + 20) / entsize;
+
+        syms = calloc(count, sizeof(xv_sym_t));
+        for (uint32_t s = 0; s < count; s++)
+        {
+            const uint8_t * sym = symtab + s * entsize;
+            // NOTE: binding (upper bits of st_info) not checked, so static functions (STB_LOCAL) are included
+            uint8_t type = sym[12] & 0xF;
+            if ((type == 1 || type == 2) && be16(sym + 14) != 0)        // STT_OBJECT or STT_FUNC, not SHN_UNDEF
+            {
+                syms[num_syms].addr = be32(sym + 4);
+                syms[num_syms].size = be32(sym + 8);
+                syms[num_syms].name = strtab + be32(sym + 0);
+                syms[num_syms].func = type == 2;
+                num_syms++;
+            }
+        }
+        qsort(syms, num_syms, sizeof(xv_sym_t), sym_compare);
+        return;
+    }
+}
+
+static xv_sym_t * sym_find(const char * name)
+{
+    for (size_t i = 0; i < num_syms; i++)
+    {
+        if (strcmp(syms[i].name, name) == 0)
+        {
+            return &syms[i];
+        }
+    }
+    return NULL;
+}
+
+// find function to call by name, or by a unique gcc clone of it ("name.part.0", "name.constprop.0" etc.)
+static xv_sym_t * func_find(const char * name)
+{
+    xv_sym_t * fn    = NULL;
+    int        found = 0;
+    size_t     len   = strlen(name);
+    for (size_t i = 0; i < num_syms; i++)
+    {
+        if (syms[i].func && strcmp(syms[i].name, name) == 0)
+        {
+            if (found++ == 0)
+            {
+                fn = &syms[i];
+            }
+        }
+    }
+    if (found == 0)
+    {
+        for (size_t i = 0; i < num_syms; i++)
+        {
+            if (syms[i].func && strncmp(syms[i].name, name, len) == 0 && syms[i].name[len] == '.')
+            {
+                if (found++ == 0)
+                {
+                    fn = &syms[i];
+                }
+            }
+        }
+    }
+    if (found > 1)
+    {
+        printf("*** %s: %d functions match, using %s at 0x%06x\n", name, found, fn->name, fn->addr);
+    }
+
+    return fn;
+}
+
+// return function symbol containing address (or NULL)
+static xv_sym_t * sym_at(uint32_t addr)
+{
+    size_t lo = 0;
+    size_t hi = num_syms;
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (syms[mid].addr <= addr)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    if (lo == 0)
+    {
+        return NULL;
+    }
+    xv_sym_t * s = &syms[lo - 1];
+
+    return (s->func && addr < s->addr + (s->size ? s->size : 1)) ? s : NULL;
+}
+
+// call function with args (pushed as longs right to left), returns false if it did not return within limit
+static bool run_function(const xv_sym_t * fn, const uint32_t * args, int num_args, unsigned long limit)
+{
+    xv_model_stats_t before = xv_model_stats;
+
+    uint32_t sp = XV_STACK_TOP;
+    for (int i = num_args - 1; i >= 0; i--)
+    {
+        sp -= 4;
+        m68k_write_memory_32(sp, args[i]);
+    }
+    sp -= 4;
+    m68k_write_memory_32(sp, XV_RETURN_ADDR);
+    m68k_set_reg(M68K_REG_SR, 0x2700);        // supervisor, interrupts masked
+    m68k_set_reg(M68K_REG_SP, sp);
+    m68k_set_reg(M68K_REG_PC, fn->addr);
+
+    for (size_t i = 0; i < num_syms; i++)
+    {
+        syms[i].self_cycles = 0;
+    }
+
+    uint64_t      cycles       = 0;
+    uint64_t      other_cycles = 0;
+    unsigned long instructions = 0;
+    uint32_t      pc           = fn->addr;
+    while (pc != XV_RETURN_ADDR)
+    {
+        if (instructions >= limit)
+        {
+            printf("*** %s: no return after %lu instructions (PC 0x%06x)\n", fn->name, instructions, pc);
+            return false;
+        }
+        int c = m68k_execute(1);        // one instruction (or exception)
+        if (c <= 0)
+        {
+            printf("*** %s: CPU stopped (waiting for interrupt) at PC 0x%06x\n", fn->name, pc);
+            return false;
+        }
+        xv_sym_t * s = sym_at(pc);
+        if (s)
+        {
+            s->self_cycles += (uint64_t)c;
+        }
+        else
+        {
+            other_cycles += (uint64_t)c;
+        }
+        cycles += (uint64_t)c;
+        instructions++;
+        pc = m68k_get_reg(NULL, M68K_REG_PC);
+    }
+
+    printf("%-32s %10llu cycles %9lu instructions  XM bytes rd %7u wr %7u  VRAM words rd %6u wr %6u\n",
+           fn->name,
+           (unsigned long long)cycles,
+           instructions,
+           xv_model_stats.reg_reads - before.reg_reads,
+           xv_model_stats.reg_writes - before.reg_writes,
+           xv_model_stats.vram_reads - before.vram_reads,
+           xv_model_stats.vram_writes - before.vram_writes);
+    for (size_t i = 0; i < num_syms; i++)
+    {
+        if (syms[i].self_cycles)
+        {
+            printf("    %-28s %10llu %5.1f%%\n",
+                   syms[i].name,
+                   (unsigned long long)syms[i].self_cycles,
+                   100.0 * (double)syms[i].self_cycles / (double)cycles);
+        }
+    }
+    if (other_cycles)
+    {
+        printf("    %-28s %10llu %5.1f%%\n",
+               "(no symbol)",
+               (unsigned long long)other_cycles,
+               100.0 * (double)other_cycles / (double)cycles);
+    }
+    // one line per function for scripts (as xosera_bench_m68k BENCH lines)
+    printf("PROF,%s,%llu,%lu,%u,%u,%u,%u\n",
+           fn->name,
+           (unsigned long long)cycles,
+           instructions,
+           xv_model_stats.reg_reads - before.reg_reads,
+           xv_model_stats.reg_writes - before.reg_writes,
+           xv_model_stats.vram_reads - before.vram_reads,
+           xv_model_stats.vram_writes - before.vram_writes);
+
+    return true;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: xv_m68k_prof [-l max_instructions] program.elf function[:arg,arg...] ...\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char ** argv)
+{
+    unsigned long limit = XV_DEFAULT_LIMIT;
+    int           argn  = 1;
+
+    if (argn + 1 < argc && strcmp(argv[argn], "-l") == 0)
+    {
+        limit = strtoul(argv[argn + 1], NULL, 0);
+        argn += 2;
+    }
+    if (argn + 1 >= argc)
+    {
+        usage();
+    }
+
+    if (!elf_read(argv[argn]) || !elf_load())
+    {
+        return EXIT_FAILURE;
+    }
+    elf_symbols();
+    if (num_syms == 0)
+    {
+        fprintf(stderr, "%s: no function symbols (stripped?)\n", argv[argn]);
+        return EXIT_FAILURE;
+    }
+    printf("Xosera m68k function profile: %s (68010, no wait states, Musashi %s)\n\n", argv[argn], XV_MUSASHI_VERSION);
+    argn++;
+
+    // all exception vectors to RTE, called functions return to STOP
+    for (uint32_t v = 0; v < 256; v++)
+    {
+        m68k_write_memory_32(v * 4, XV_RTE_ADDR);
+    }
+    m68k_write_memory_32(0, XV_STACK_TOP);               // reset SSP
+    m68k_write_memory_32(4, XV_RETURN_ADDR);             // reset PC
+    m68k_write_memory_16(XV_RTE_ADDR, 0x4E73);           // RTE
+    m68k_write_memory_16(XV_RETURN_ADDR, 0x4E72);        // STOP #$2700
+    m68k_write_memory_16(XV_RETURN_ADDR + 2, 0x2700);
+
+    xv_model_reset();
+    m68k_init();
+    m68k_set_cpu_type(M68K_CPU_TYPE_68010);
+    m68k_pulse_reset();
+
+    int failures = 0;
+    for (; argn < argc; argn++)
+    {
+        char *   name = argv[argn];
+        uint32_t args[XV_MAX_ARGS];
+        int      num_args = 0;
+        bool     bad_arg  = false;
+        char *   colon    = strchr(name, ':');
+        if (colon)
+        {
+            *colon       = '\0';
+            char * arg   = colon + 1;
+            while (*arg && num_args < XV_MAX_ARGS)
+            {
+                // number, or symbol name for its address (e.g., a data array)
+                char * end = strchr(arg, ',');
+                if (end)
+                {
+                    *end = '\0';
+                }
+                xv_sym_t * sym = sym_find(arg);
+                if (sym)
+                {
+                    args[num_args++] = sym->addr;
+                }
+                else
+                {
+                    char * num_end;
+                    args[num_args++] = (uint32_t)strtoul(arg, &num_end, 0);
+                    if (num_end == arg || *num_end)
+                    {
+                        printf("*** %s: bad argument \"%s\"\n", name, arg);
+                        bad_arg = true;
+                    }
+                }
+                if (!end)
+                {
+                    break;
+                }
+                arg = end + 1;
+            }
+        }
+
+        if (bad_arg)
+        {
+            failures++;
+            continue;
+        }
+
+        xv_sym_t * fn = func_find(name);
+        if (fn == NULL)
+        {
+            printf("*** %s: function not found\n", name);
+            failures++;
+            continue;
+        }
+        if (!run_function(fn, args, num_args, limit))
+        {
+            failures++;
+        }
+        printf("\n");
+    }
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,244 @@
+/*
+ * vim: set et ts=4 sw=4
+ *------------------------------------------------------------
+ *  __ __
+ * |  |  |___ ___ ___ ___ ___
+ * |-   -| . |_ -| -_|  _| .'|
+ * |__|__|___|___|___|_| |__,|
+ *
+ * Xark's Open Source Enhanced Retro Adapter
+ *
+ * - "Not as clumsy or random as a GPU, an embedded retro
+ *    adapter for a more civilized age."
+ *
+ * ------------------------------------------------------------
+ * Copyright (c) 2021 Xark
+ * MIT License
+ *
+ * Host check of bulk VRAM functions against the register model
+ * ------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xv_host_model.h"
+
+#define VRAM_WORDS 65536
+
+static uint16_t ref_vram[VRAM_WORDS];        // expected VRAM contents
+static uint16_t buffer[VRAM_WORDS + 1];      // RAM side data
+static uint32_t rand_state = 0x12345678;
+static int      failures;
+
+static uint16_t rand16(void)
+{
+    rand_state = rand_state * 1103515245 + 12345;
+    return (uint16_t)(rand_state >> 16);
+}
+
+// fill model VRAM and reference with the same random contents
+static void random_vram(void)
+{
+    xv_model_reset();
+    for (uint32_t i = 0; i < VRAM_WORDS; i++)
+    {
+        ref_vram[i] = xv_model_vram[i] = rand16();
+    }
+}
+
+static void check(const char * what, uint32_t num_words, uint16_t vaddr)
+{
+    if (memcmp(ref_vram, xv_model_vram, sizeof(ref_vram)) != 0)
+    {
+        printf("*** %s: VRAM mismatch (vaddr 0x%04x, %u words)\n", what, vaddr, num_words);
+        failures++;
+    }
+}
+
+static void test_write(bool rw, uint16_t vaddr, uint32_t num_words)
+{
+    random_vram();
+    for (uint32_t i = 0; i < num_words; i++)
+    {
+        buffer[i]                          = rand16();
+        ref_vram[(uint16_t)(vaddr + i)] = buffer[i];
+    }
+    uint16_t wr_addr = xv_model_reg(XM_WR_ADDR);
+    if (rw)
+    {
+        xv_vram_write_rw(vaddr, buffer, num_words);
+        if (xv_model_reg(XM_WR_ADDR) != wr_addr)
+        {
+            printf("*** xv_vram_write_rw: changed WR_ADDR\n");
+            failures++;
+        }
+    }
+    else
+    {
+        xv_vram_write(vaddr, buffer, num_words);
+    }
+    check(rw ? "xv_vram_write_rw" : "xv_vram_write", num_words, vaddr);
+}
+
+static void test_read(bool rw, uint16_t vaddr, uint32_t num_words)
+{
+    random_vram();
+    buffer[num_words] = 0xDEAD;
+    uint16_t sys_ctrl = xv_model_reg(XM_SYS_CTRL);
+    if (rw)
+    {
+        xv_vram_read_rw(vaddr, buffer, num_words);
+    }
+    else
+    {
+        xv_vram_read(vaddr, buffer, num_words);
+    }
+    for (uint32_t i = 0; i < num_words; i++)
+    {
+        if (buffer[i] != ref_vram[(uint16_t)(vaddr + i)])
+        {
+            printf("*** %s: data mismatch at word %u (vaddr 0x%04x, %u words)\n",
+                   rw ? "xv_vram_read_rw" : "xv_vram_read",
+                   i,
+                   vaddr,
+                   num_words);
+            failures++;
+            break;
+        }
+    }
+    if (buffer[num_words] != 0xDEAD || xv_model_reg(XM_SYS_CTRL) != sys_ctrl)
+    {
+        printf("*** %s: wrote past buffer or changed SYS_CTRL\n", rw ? "xv_vram_read_rw" : "xv_vram_read");
+        failures++;
+    }
+}
+
+static void test_fill(bool rw, uint16_t vaddr, uint32_t num_words)
+{
+    random_vram();
+    uint16_t word = rand16();
+    for (uint32_t i = 0; i < num_words; i++)
+    {
+        ref_vram[(uint16_t)(vaddr + i)] = word;
+    }
+    if (rw)
+    {
+        xv_vram_fill_rw(vaddr, word, num_words);
+    }
+    else
+    {
+        xv_vram_fill(vaddr, word, num_words);
+    }
+    check(rw ? "xv_vram_fill_rw" : "xv_vram_fill", num_words, vaddr);
+}
+
+static void test_copy(uint16_t dst_vaddr, uint16_t src_vaddr, uint32_t num_words)
+{
+    random_vram();
+    for (uint32_t i = 0; i < num_words; i++)
+    {
+        buffer[i] = ref_vram[(uint16_t)(src_vaddr + i)];
+    }
+    for (uint32_t i = 0; i < num_words; i++)
+    {
+        ref_vram[(uint16_t)(dst_vaddr + i)] = buffer[i];
+    }
+    xv_vram_copy(dst_vaddr, src_vaddr, num_words);
+    check("xv_vram_copy", num_words, dst_vaddr);
+}
+
+// print register access counts and cycles for each function transferring num_words
+static void report(uint32_t num_words)
+{
+    static const char * names[] = {"xv_vram_write",
+                                   "xv_vram_read",
+                                   "xv_vram_fill",
+                                   "xv_vram_copy",
+                                   "xv_vram_write_rw",
+                                   "xv_vram_read_rw",
+                                   "xv_vram_fill_rw"};
+
+    printf("\n%u word transfers (register access cycles only, 68000 timing):\n", num_words);
+    printf("  %-18s %8s %8s %10s %8s\n", "function", "reg wr", "reg rd", "cycles", "cyc/word");
+    for (int f = 0; f < 7; f++)
+    {
+        xv_model_reset();
+        switch (f)
+        {
+            case 0:
+                xv_vram_write(0, buffer, num_words);
+                break;
+            case 1:
+                xv_vram_read(0, buffer, num_words);
+                break;
+            case 2:
+                xv_vram_fill(0, 0, num_words);
+                break;
+            case 3:
+                xv_vram_copy(0x8000, 0, num_words);
+                break;
+            case 4:
+                xv_vram_write_rw(0, buffer, num_words);
+                break;
+            case 5:
+                xv_vram_read_rw(0, buffer, num_words);
+                break;
+            case 6:
+                xv_vram_fill_rw(0, 0, num_words);
+                break;
+        }
+        printf("  %-18s %8u %8u %10u %8.2f\n",
+               names[f],
+               xv_model_stats.reg_writes,
+               xv_model_stats.reg_reads,
+               xv_model_stats.cycles,
+               (double)xv_model_stats.cycles / num_words);
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    (void)argc;
+    (void)argv;
+
+    static const uint32_t sizes[]   = {0, 1, 2, 3, 15, 16, 17, 31, 32, 33, 100, 1000, 4097, VRAM_WORDS};
+    static const uint16_t addrs[]   = {0x0000, 0x0001, 0x7FFF, 0xFFF0};
+    static const int32_t  overlap[] = {-33, -16, -1, 1, 2, 16, 33, 0x1000};
+
+    printf("Xosera bulk VRAM function check (host register model)\n");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        for (size_t a = 0; a < sizeof(addrs) / sizeof(addrs[0]); a++)
+        {
+            for (int rw = 0; rw < 2; rw++)
+            {
+                test_write(rw, addrs[a], sizes[s]);
+                test_read(rw, addrs[a], sizes[s]);
+                test_fill(rw, addrs[a], sizes[s]);
+            }
+            for (size_t o = 0; o < sizeof(overlap) / sizeof(overlap[0]); o++)
+            {
+                if (sizes[s] < VRAM_WORDS)
+                {
+                    test_copy((uint16_t)(addrs[a] + overlap[o]), addrs[a], sizes[s]);
+                }
+            }
+        }
+    }
+
+    report(16);
+    report(1000);
+    report(32768);
+
+    if (failures)
+    {
+        printf("\n*** %d failures\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("\nAll checks passed.\n");
+
+    return EXIT_SUCCESS;
+}
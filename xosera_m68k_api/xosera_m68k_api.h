@@ -27,6 +27,7 @@
 #if !defined(XOSERA_M68K_API_H)
 #define XOSERA_M68K_API_H
 
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -35,6 +36,162 @@ bool xosera_init(int reconfig_num);        // wait a bit for Xosera to respond a
 void cpu_delay(int ms);                    // delay approx milliseconds with CPU busy wait
 void xv_delay(uint32_t ms);                // delay milliseconds using Xosera TIMER
 
+// Bulk VRAM transfer (see xosera_m68k_vram.c), unrolled MOVEP.L through XM_DATA/XM_DATA_2 or XM_RW_DATA/XM_RW_DATA_2
+// (_rw versions leave XM_WR_ADDR and XM_WR_INCR untouched, e.g. for a text cursor).  Any length up to 64K words.
+void xv_vram_write(uint16_t vaddr, const uint16_t * src, uint32_t num_words);           // RAM to VRAM (WR_INCR=1)
+void xv_vram_read(uint16_t vaddr, uint16_t * dst, uint32_t num_words);                  // VRAM to RAM (RD_INCR=1)
+void xv_vram_fill(uint16_t vaddr, uint16_t word, uint32_t num_words);                   // fill VRAM (WR_INCR=1)
+void xv_vram_copy(uint16_t dst_vaddr, uint16_t src_vaddr, uint32_t num_words);          // VRAM to VRAM, overlap safe
+void xv_vram_write_rw(uint16_t vaddr, const uint16_t * src, uint32_t num_words);        // RAM to VRAM (RW_INCR=1)
+void xv_vram_read_rw(uint16_t vaddr, uint16_t * dst, uint32_t num_words);               // VRAM to RAM (RW_INCR=1)
+void xv_vram_fill_rw(uint16_t vaddr, uint16_t word, uint32_t num_words);                // fill VRAM (RW_INCR=1)
+void xv_data_write(const uint16_t * src, uint32_t num_words);        // RAM to VRAM at current WR_ADDR/WR_INCR
+void xv_data_fill(uint16_t word, uint32_t num_words);                // fill VRAM at current WR_ADDR/WR_INCR
+
+// Xosera interrupt dispatch (see xosera_m68k_intr.c), one handler per source INTR_*_B (called in interrupt context)
+typedef void (*xv_intr_fn)(void);
+void xv_intr_install(void);                            // hook Xosera level 2 autovector (all sources masked)
+void xv_intr_remove(void);                             // mask all sources and restore previous vector
+void xv_intr_set(uint8_t intr_b, xv_intr_fn fn);        // set handler for source (NULL masks source)
+
+// Vertical blank service and PA_DISP_ADDR page flipping (see xosera_m68k_vsync.c), uses vsync interrupt
+void     xv_vsync_init(xv_intr_fn fn);        // install vsync interrupt, fn called each vertical blank (or NULL)
+void     xv_vsync_remove(void);                // mask vsync interrupt
+uint32_t xv_vsync_frame(void);                 // frame counter (vertical blanks since xv_vsync_init)
+void     xv_vsync_wait(void);                  // wait for next vertical blank (CPU stopped while waiting)
+void     xv_vsync_buffers(uint8_t num_buffers, const uint16_t * disp_addr);        // 2 or 3 buffers, first displayed
+uint16_t xv_vsync_draw_buffer(void);           // VRAM address of buffer to draw into (waits for free buffer)
+void     xv_vsync_flip(void);                  // display drawn buffer from next vertical blank
+void     xv_vblank_xr_setw(uint16_t xr_addr, uint16_t value);        // queue XR write for vertical blank
+uint32_t xv_vblank_commit(void);                  // queued XR writes applied in next vertical blank, returns fence
+bool     xv_vblank_done(uint32_t fence);          // true if committed XR writes have been applied
+void     xv_vblank_fence_wait(uint32_t fence);        // wait for committed XR writes to be applied
+
+// Copper lists (see xosera_m68k_copper.c), cop_addr is word offset in copper memory, instructions from COP_* macros
+void     xv_copper_load(uint16_t cop_addr, const uint32_t * list, uint16_t num_insns);        // one XR_ADDR write
+void     xv_copper_start(uint16_t cop_addr);                                // enable copper at cop_addr from next frame
+void     xv_copper_stop(void);                                              // disable copper
+void     xv_copper_double(uint16_t cop_addr_0, uint16_t cop_addr_1);        // set double buffered list addresses
+uint16_t xv_copper_back(void);        // address of list to build (waits while copper may still be running it)
+void     xv_copper_swap(void);        // run list just built from next frame
+
+// Queued blitter operations (see xosera_m68k_blit.c).  Address strides are line lengths in words, shift is 4-bit
+// pixels to shift right (0-3, one extra word per line is written).  Operations are queued in RAM when the blitter
+// queue is full and fed to the blitter from the blit done interrupt (if xv_blit_init(true)), else the CPU waits.
+typedef struct _xv_blit
+{
+    uint16_t ctrl;         // XR_BLIT_CTRL
+    uint16_t mod_a;        // XR_BLIT_MOD_A
+    uint16_t src_a;        // XR_BLIT_SRC_A
+    uint16_t mod_b;        // XR_BLIT_MOD_B
+    uint16_t src_b;        // XR_BLIT_SRC_B
+    uint16_t mod_c;        // XR_BLIT_MOD_C
+    uint16_t val_c;        // XR_BLIT_VAL_C
+    uint16_t mod_d;        // XR_BLIT_MOD_D
+    uint16_t dst_d;        // XR_BLIT_DST_D
+    uint16_t shift;        // XR_BLIT_SHIFT
+    uint16_t lines;        // XR_BLIT_LINES (lines - 1)
+    uint16_t words;        // XR_BLIT_WORDS (words - 1, written last to start blit)
+} xv_blit_t;
+
+void xv_blit_init(bool use_intr);                    // reset queue, use_intr feeds queue from blit done interrupt
+void xv_blit_queue(const xv_blit_t * op);            // start or queue blit with raw register values
+bool xv_blit_pending(void);                          // true if queued or blitter busy
+void xv_blit_wait(void);                             // wait until all queued blits have completed
+void xv_blit_fill(uint16_t dst, uint16_t dst_stride, uint16_t words, uint16_t lines, uint16_t value);
+void xv_blit_copy(uint16_t dst,
+                  uint16_t dst_stride,
+                  uint16_t src,
+                  uint16_t src_stride,
+                  uint16_t words,
+                  uint16_t lines);
+void xv_blit_copy_shifted(uint16_t dst,
+                          uint16_t dst_stride,
+                          uint16_t src,
+                          uint16_t src_stride,
+                          uint16_t words,
+                          uint16_t lines,
+                          uint8_t  shift);
+// source where mask pixel is 0xF, 0x0 leaves destination (mask in VRAM with same stride as source)
+void xv_blit_copy_masked(uint16_t dst,
+                         uint16_t dst_stride,
+                         uint16_t src,
+                         uint16_t mask,
+                         uint16_t src_stride,
+                         uint16_t words,
+                         uint16_t lines,
+                         uint8_t  shift);
+// source where pixel not transp (4-bit pixels match transp high/low nibble alternately, e.g. 0x00, or 8-bit pixels)
+void xv_blit_copy_transp(uint16_t dst,
+                         uint16_t dst_stride,
+                         uint16_t src,
+                         uint16_t src_stride,
+                         uint16_t words,
+                         uint16_t lines,
+                         uint8_t  shift,
+                         uint8_t  transp,
+                         bool     transp_8b);
+
+// Blitter objects drawn over a clean background bitmap with dirty rectangle restore (see xosera_m68k_bob.c), 4-bit
+// pixels with x in pixels (BLIT_SHIFT used for pixel within word) and mask 0xF for each pixel drawn
+#define XV_BOB_NO_MASK 0xFFFF        // xv_bob_t mask value to use pixel value 0 as transparent instead
+typedef struct _xv_bob
+{
+    int16_t  x;            // pixel position (clipped to bitmap)
+    int16_t  y;            // line position (clipped to bitmap)
+    uint16_t image;        // VRAM address of image
+    uint16_t mask;         // VRAM address of mask (same size as image) or XV_BOB_NO_MASK
+    uint8_t  words;        // image words per line (4 pixels each)
+    uint8_t  lines;        // image lines
+} xv_bob_t;
+
+typedef struct _xv_bobs_stats
+{
+    uint16_t cpu_ticks;         // XM_TIMER ticks (1/10 ms) for xv_bobs_draw() to queue blits
+    uint16_t blit_ticks;        // XM_TIMER ticks from xv_bobs_draw() until blitter idle (set by xv_bobs_wait)
+    uint16_t restores;          // background rectangles restored
+    uint16_t draws;             // BOBs drawn (not clipped out)
+    uint32_t blit_words;        // words written by blitter
+} xv_bobs_stats_t;
+
+void     xv_bobs_init(uint16_t background, uint16_t stride, uint16_t lines);        // set clean background bitmap
+uint16_t xv_bob_load(uint16_t vaddr, const uint16_t * image, uint8_t words, uint8_t lines, bool make_mask);
+void     xv_bobs_draw(uint16_t dst, const xv_bob_t * bobs, uint8_t num_bobs);        // restore dst, queue BOB blits
+void     xv_bobs_wait(void);                                  // wait for blits and record blitter time
+const xv_bobs_stats_t * xv_bobs_stats(void);                  // statistics for last frame drawn
+
+// Text screen output (see xosera_m68k_text.c), color+glyph words in VRAM (long pairs to XM_DATA/XM_DATA_2) or XR
+// memory, one address register write per run of characters
+typedef struct _xv_text
+{
+    uint16_t addr;           // text screen address (VRAM or XR)
+    uint8_t  columns;        // characters per line
+    uint8_t  rows;           // lines
+    uint8_t  x;              // current column
+    uint8_t  y;              // current line
+    uint8_t  color;          // current color (high byte of each character word)
+    bool     xr;             // text screen in XR memory (else VRAM)
+} xv_text_t;
+
+void xv_text_init(xv_text_t * t, uint16_t addr, uint8_t columns, uint8_t rows, bool xr);
+void xv_text_pos(xv_text_t * t, uint8_t x, uint8_t y);
+void xv_text_color(xv_text_t * t, uint8_t color);
+void xv_text_cls(xv_text_t * t);                                          // clear to current color and home
+void xv_text_write(xv_text_t * t, const char * str, uint16_t len);        // write len chars (with \n \r \b \f)
+void xv_text_print(xv_text_t * t, const char * str);
+void xv_text_vprintf(xv_text_t * t, const char * fmt, va_list args);
+void xv_text_printf(xv_text_t * t, const char * fmt, ...) __attribute__((format(__printf__, 2, 3)));
+
+// Double buffered audio streaming on channel 0 (see xosera_m68k_audio.c), two VRAM halves refilled from the audio
+// reload interrupt.  Fill function copies up to num_words of 8-bit signed samples (two per word) into buf and returns
+// words copied (zero ends stream), it is called in interrupt context.
+typedef uint16_t (*xv_audio_fill_fn)(uint16_t * buf, uint16_t num_words);
+uint16_t xv_audio_period(uint16_t rate);        // AUD0_PERIOD for sample rate in Hz (current video mode)
+bool     xv_audio_stream_start(uint16_t vaddr, uint16_t half_words, uint16_t rate, xv_audio_fill_fn fill);
+void     xv_audio_stream_stop(void);                 // stop stream (channel plays silence)
+bool     xv_audio_stream_active(void);               // true until last samples played (or stopped)
+uint32_t xv_audio_stream_underruns(void);            // number of halves filled short
+
 // Low-level C API reference:
 //
 // set/get XM registers (main registers):
@@ -395,4 +552,28 @@ extern volatile xmreg_t * const xosera_ptr;
         word_value;                                                                                                    \
     })
 
+// write copper instruction insn to XR_DATA (after xm_setw(XR_ADDR, XR_COPPER_ADDR + cop_addr), XR_ADDR increments)
+#define xv_copper_emit(insn)                                                                                           \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        uint32_t cop_insn = (insn);                                                                                    \
+        xm_setw(XR_DATA, (uint16_t)(cop_insn >> 16));                                                                  \
+        xm_setw(XR_DATA, (uint16_t)cop_insn);                                                                          \
+    } while (false)
+
+// disable CPU interrupts, returning previous SR (rosco_m68k programs run in supervisor mode)
+#define xv_intr_disable()                                                                                              \
+    ({                                                                                                                 \
+        uint16_t sr_value;                                                                                             \
+        __asm__ __volatile__("move.w %%sr,%[sr] ; or.w #0x0700,%%sr" : [sr] "=d"(sr_value) : : "memory");            \
+        sr_value;                                                                                                      \
+    })
+// restore SR (and CPU interrupt level) returned by xv_intr_disable()
+#define xv_intr_restore(sr_value)                                                                                      \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        uint16_t sr_restore = (sr_value);                                                                              \
+        __asm__ __volatile__("move.w %[sr],%%sr" : : [sr] "d"(sr_restore) : "memory");                                \
+    } while (false)
+
 #endif        // XOSERA_M68K_API_H
@@ -0,0 +1,195 @@
+/*
+ * vim: set et ts=4 sw=4
+ *------------------------------------------------------------
+ *  __ __
+ * |  |  |___ ___ ___ ___ ___
+ * |-   -| . |_ -| -_|  _| .'|
+ * |__|__|___|___|___|_| |__,|
+ *
+ * Xark's Open Source Enhanced Retro Adapter
+ *
+ * - "Not as clumsy or random as a GPU, an embedded retro
+ *    adapter for a more civilized age."
+ *
+ * ------------------------------------------------------------
+ * Copyright (c) 2021 Xark
+ * MIT License
+ *
+ * Xosera rosco_m68k C API double buffered audio streaming
+ * ------------------------------------------------------------
+ */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define XV_PREP_REQUIRED
+#include "xosera_m68k_api.h"
+
+// Audio channel 0 plays AUD0_LENGTH+1 words from AUD0_START, then reloads the start and length registers and plays
+// again.  At each reload it raises interrupt source #0, and from then until the next reload the registers can be set
+// to the buffer to play next.  A stream uses two buffers (halves) in VRAM: while the channel plays one half, the
+// interrupt refills the other half from the fill callback and queues it, so the CPU only touches VRAM once per half
+// instead of once per sample.  A silence word follows the two halves and is queued once the fill callback runs dry.
+//
+// The fill callback runs in interrupt context, so it should only copy from RAM.  To stream from SD card (or anything
+// else slow), have mainline code keep a RAM FIFO topped up and have the callback take from that FIFO (returning fewer
+// words, or zero, if it underruns).
+//
+// The interrupt saves and restores XM_WR_ADDR, XM_WR_INCR and the SYS_CTRL write mask around the VRAM write, but
+// mainline code must not be interrupted between the two byte writes of xm_setbh(DATA)/xm_setbl(DATA) while streaming.
+
+#if !defined(XV_AUDIO_MAX_HALF)
+#define XV_AUDIO_MAX_HALF 1024        // maximum words per half buffer (RAM staging buffer size)
+#endif
+
+static xv_audio_fill_fn  xv_audio_fill;
+static uint16_t          xv_audio_vaddr[2];                     // VRAM address of each half
+static uint16_t          xv_audio_silence;                      // VRAM address of silence word
+static uint16_t          xv_audio_half_words;
+static uint16_t          xv_audio_rate_period;                  // AUD0_PERIOD for stream sample rate
+static uint8_t           xv_audio_next;                         // half to refill at next reload
+static volatile bool     xv_audio_active;                       // stream playing
+static volatile bool     xv_audio_ending;                       // silence queued (fill callback returned zero)
+static volatile uint32_t xv_audio_underruns;                    // halves filled short
+static uint16_t          xv_audio_buffer[XV_AUDIO_MAX_HALF];        // RAM staging buffer for fill callback
+
+// fill half buffer from callback, write it to VRAM and queue it as next to play (returns words queued)
+static uint16_t xv_audio_refill(uint8_t half)
+{
+    xv_prep();
+
+    uint16_t words = xv_audio_fill(xv_audio_buffer, xv_audio_half_words);
+    if (words > xv_audio_half_words)
+    {
+        words = xv_audio_half_words;
+    }
+    if (words == 0)
+    {
+        xreg_setw(AUD0_START, xv_audio_silence);
+        xreg_setw(AUD0_LENGTH, 0);
+        return 0;
+    }
+    if (words < xv_audio_half_words)
+    {
+        xv_audio_underruns++;
+    }
+
+    uint16_t wr_addr  = xm_getw(WR_ADDR);
+    uint16_t wr_incr  = xm_getw(WR_INCR);
+    uint8_t  sys_ctrl = xm_getbl(SYS_CTRL) & 0x1F;        // RW_RD_INC flag and write mask
+    xm_setbl(SYS_CTRL, sys_ctrl | 0x0F);                 // write all nibbles
+    xv_vram_write(xv_audio_vaddr[half], xv_audio_buffer, words);
+    xm_setbl(SYS_CTRL, sys_ctrl);
+    xm_setw(WR_INCR, wr_incr);
+    xm_setw(WR_ADDR, wr_addr);
+
+    xreg_setw(AUD0_START, xv_audio_vaddr[half]);
+    xreg_setw(AUD0_LENGTH, words - 1);
+
+    return words;
+}
+
+// audio 0 reload interrupt, channel just started playing the queued half (or silence), refill and queue the other
+static void xv_audio_handler(void)
+{
+    if (!xv_audio_active)
+    {
+        return;
+    }
+    if (xv_audio_ending)
+    {
+        // silence latched, so last samples have played
+        xv_audio_active = false;
+        xv_intr_set(INTR_AUDIO_B, NULL);
+        return;
+    }
+
+    if (xv_audio_refill(xv_audio_next) == 0)
+    {
+        xv_audio_ending = true;
+    }
+    xv_audio_next ^= 1;
+}
+
+// return AUD0_PERIOD for sample rate in Hz (for current video mode pixel clock)
+uint16_t xv_audio_period(uint16_t rate)
+{
+    xv_prep();
+
+    uint32_t clk_hz = xreg_getw(VID_HSIZE) > 640 ? 33750000 : 25125000;
+    uint32_t period = (clk_hz + rate - 1) / rate;
+
+    return period > 0x7FFF ? 0x7FFF : (uint16_t)period;
+}
+
+// start streaming 8-bit signed samples (two per word, high byte first) at rate Hz from fill callback (called in
+// interrupt context) using VRAM at vaddr for two halves of half_words each plus a silence word (2 * half_words + 1)
+bool xv_audio_stream_start(uint16_t vaddr, uint16_t half_words, uint16_t rate, xv_audio_fill_fn fill)
+{
+    if (fill == NULL || half_words == 0 || half_words > XV_AUDIO_MAX_HALF)
+    {
+        return false;
+    }
+
+    xv_audio_stream_stop();
+
+    xv_prep();
+
+    xv_audio_fill       = fill;
+    xv_audio_half_words = half_words;
+    xv_audio_vaddr[0]   = vaddr;
+    xv_audio_vaddr[1]   = vaddr + half_words;
+    xv_audio_silence    = vaddr + 2 * half_words;
+    xv_audio_underruns  = 0;
+    xv_audio_ending     = false;
+    xv_vram_fill(xv_audio_silence, 0x0000, 1);        // zero = silence sample
+
+    // queue first half so the restart below latches it (and interrupts to have the second half queued)
+    if (xv_audio_refill(0) == 0)
+    {
+        return false;
+    }
+    xv_audio_next   = 1;
+    xv_audio_active = true;
+
+    xv_intr_install();
+    xv_intr_set(INTR_AUDIO_B, xv_audio_handler);
+
+    xv_audio_rate_period = xv_audio_period(rate);
+    xreg_setw(AUD0_VOL, 0x8080);                                         // 100% left and right
+    xreg_setw(VID_CTRL, (xreg_getw(VID_CTRL) & 0xFF00) | 0x0010);        // keep border, enable audio
+    xreg_setw(AUD0_PERIOD, 0x8000 | xv_audio_rate_period);               // restart channel (latches first half)
+
+    return true;
+}
+
+// stop audio stream (channel left playing silence)
+void xv_audio_stream_stop(void)
+{
+    if (!xv_audio_active)
+    {
+        return;
+    }
+
+    xv_prep();
+
+    xv_intr_set(INTR_AUDIO_B, NULL);
+    xv_audio_active = false;
+    xreg_setw(AUD0_START, xv_audio_silence);
+    xreg_setw(AUD0_LENGTH, 0);
+    xreg_setw(AUD0_PERIOD, 0x8000 | xv_audio_rate_period);        // restart on silence
+}
+
+// return true while audio stream is playing (false once last samples played or stopped)
+bool xv_audio_stream_active(void)
+{
+    return xv_audio_active;
+}
+
+// return number of half buffers the fill callback filled short since xv_audio_stream_start()
+uint32_t xv_audio_stream_underruns(void)
+{
+    return xv_audio_underruns;
+}
@@ -0,0 +1,250 @@
+/*
+ * vim: set et ts=4 sw=4
+ *------------------------------------------------------------
+ *  __ __
+ * |  |  |___ ___ ___ ___ ___
+ * |-   -| . |_ -| -_|  _| .'|
+ * |__|__|___|___|___|_| |__,|
+ *
+ * Xark's Open Source Enhanced Retro Adapter
+ *
+ * - "Not as clumsy or random as a GPU, an embedded retro
+ *    adapter for a more civilized age."
+ *
+ * ------------------------------------------------------------
+ * Copyright (c) 2021 Xark
+ * MIT License
+ *
+ * Xosera rosco_m68k C API queued blitter operations
+ * ------------------------------------------------------------
+ */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define XV_PREP_REQUIRED
+#include "xosera_m68k_api.h"
+
+// The blitter has one operation in progress and one queued in its registers (SYS_CTRL BLIT_FULL set when the queued
+// slot is taken).  Operations beyond that wait in a RAM ring here.  With interrupts, the blit done interrupt moves
+// operations from the ring into the blitter whenever its queued slot is free, so the CPU only waits if the ring itself
+// is full.  Without interrupts, xv_blit_queue() waits for BLIT_FULL to clear and writes the operation directly.
+
+#if !defined(XV_BLIT_QUEUE_SIZE)
+#define XV_BLIT_QUEUE_SIZE 16        // must be power of two
+#endif
+
+#define XV_BLIT_FULL (1 << SYS_CTRL_BLITFULL_B)
+#define XV_BLIT_BUSY (1 << SYS_CTRL_BLITBUSY_B)
+
+static xv_blit_t        xv_blit_ring[XV_BLIT_QUEUE_SIZE];
+static volatile uint8_t xv_blit_head;        // next operation to start (advanced by interrupt)
+static volatile uint8_t xv_blit_tail;        // next free slot (advanced by xv_blit_queue)
+static bool             xv_blit_intr;        // true if blit done interrupt feeds the blitter
+
+// write operation to blitter registers (BLIT_FULL must be clear), XR_BLIT_WORDS write last starts it
+static void xv_blit_start(const xv_blit_t * op)
+{
+    xv_prep();
+    const uint16_t * reg = &op->ctrl;
+
+    xm_setw(XR_ADDR, XR_BLIT_CTRL);        // XR_DATA writes increment XR_ADDR
+    for (uint8_t i = 0; i < 12; i++)
+    {
+        xm_setw(XR_DATA, *reg++);
+    }
+}
+
+// blit done interrupt, start queued operations while blitter has room (XR_ADDR restored by dispatcher)
+static void xv_blit_intr_handler(void)
+{
+    xv_prep();
+    uint8_t head = xv_blit_head;
+
+    while (head != xv_blit_tail && !(xm_getbl(SYS_CTRL) & XV_BLIT_FULL))
+    {
+        xv_blit_start(&xv_blit_ring[head]);
+        head = (head + 1) & (XV_BLIT_QUEUE_SIZE - 1);
+    }
+    xv_blit_head = head;
+}
+
+void xv_blit_init(bool use_intr)
+{
+    xv_blit_wait();
+
+    xv_blit_head = 0;
+    xv_blit_tail = 0;
+    xv_blit_intr = use_intr;
+    if (use_intr)
+    {
+        xv_intr_install();
+        xv_intr_set(INTR_BLIT_B, xv_blit_intr_handler);
+    }
+    else
+    {
+        xv_intr_set(INTR_BLIT_B, NULL);
+    }
+}
+
+void xv_blit_queue(const xv_blit_t * op)
+{
+    xv_prep();
+
+    if (!xv_blit_intr)
+    {
+        xwait_blit_full();
+        xv_blit_start(op);
+        return;
+    }
+
+    for (;;)
+    {
+        uint16_t sr = xv_intr_disable();
+        if (xv_blit_head == xv_blit_tail && !(xm_getbl(SYS_CTRL) & XV_BLIT_FULL))
+        {
+            xv_blit_start(op);
+            xv_intr_restore(sr);
+            return;
+        }
+        uint8_t tail = xv_blit_tail;
+        uint8_t next = (tail + 1) & (XV_BLIT_QUEUE_SIZE - 1);
+        if (next != xv_blit_head)
+        {
+            xv_blit_ring[tail] = *op;
+            xv_blit_tail       = next;
+            xv_intr_restore(sr);
+            return;
+        }
+        xv_intr_restore(sr);        // ring full, let blit done interrupt drain it
+    }
+}
+
+bool xv_blit_pending(void)
+{
+    xv_prep();
+
+    return xv_blit_head != xv_blit_tail || (xm_getbl(SYS_CTRL) & (XV_BLIT_BUSY | XV_BLIT_FULL));
+}
+
+void xv_blit_wait(void)
+{
+    while (xv_blit_pending())
+        ;
+}
+
+// masks and shift for BLIT_SHIFT: first word keeps pixels not shifted in, last (extra) word keeps pixels shifted out
+static inline uint16_t xv_blit_shift(uint8_t shift)
+{
+    return (uint16_t)(((0xF0 >> shift) << 8) | shift);
+}
+
+void xv_blit_fill(uint16_t dst, uint16_t dst_stride, uint16_t words, uint16_t lines, uint16_t value)
+{
+    xv_blit_t op = {.ctrl  = MAKE_BLIT_CTRL(0x00, BLIT_CTRL_A_CONST | BLIT_CTRL_B_CONST),
+                    .src_a = value,
+                    .src_b = 0xFFFF,        // B term all ones, so also no transparent pixels
+                    .mod_d = (uint16_t)(dst_stride - words),
+                    .dst_d = dst,
+                    .shift = 0xFF00,
+                    .lines = (uint16_t)(lines - 1),
+                    .words = (uint16_t)(words - 1)};
+    xv_blit_queue(&op);
+}
+
+void xv_blit_copy(uint16_t dst,
+                  uint16_t dst_stride,
+                  uint16_t src,
+                  uint16_t src_stride,
+                  uint16_t words,
+                  uint16_t lines)
+{
+    xv_blit_t op = {.ctrl  = MAKE_BLIT_CTRL(0x00, BLIT_CTRL_B_CONST),
+                    .mod_a = (uint16_t)(src_stride - words),
+                    .src_a = src,
+                    .src_b = 0xFFFF,
+                    .mod_d = (uint16_t)(dst_stride - words),
+                    .dst_d = dst,
+                    .shift = 0xFF00,
+                    .lines = (uint16_t)(lines - 1),
+                    .words = (uint16_t)(words - 1)};
+    xv_blit_queue(&op);
+}
+
+void xv_blit_copy_shifted(uint16_t dst,
+                          uint16_t dst_stride,
+                          uint16_t src,
+                          uint16_t src_stride,
+                          uint16_t words,
+                          uint16_t lines,
+                          uint8_t  shift)
+{
+    if ((shift &= 3) == 0)
+    {
+        xv_blit_copy(dst, dst_stride, src, src_stride, words, lines);
+        return;
+    }
+
+    xv_blit_t op = {.ctrl  = MAKE_BLIT_CTRL(0x00, BLIT_CTRL_B_CONST),
+                    .mod_a = (uint16_t)(src_stride - words - 1),        // reads one extra word per line
+                    .src_a = src,
+                    .src_b = 0xFFFF,
+                    .mod_d = (uint16_t)(dst_stride - words - 1),
+                    .dst_d = dst,
+                    .shift = xv_blit_shift(shift),
+                    .lines = (uint16_t)(lines - 1),
+                    .words = words};
+    xv_blit_queue(&op);
+}
+
+void xv_blit_copy_masked(uint16_t dst,
+                         uint16_t dst_stride,
+                         uint16_t src,
+                         uint16_t mask,
+                         uint16_t src_stride,
+                         uint16_t words,
+                         uint16_t lines,
+                         uint8_t  shift)
+{
+    shift &= 3;
+    uint16_t extra = shift ? 1 : 0;
+    // B is mask data, pixels with zero mask nibble (== T) are left unchanged
+    xv_blit_t op = {.ctrl  = MAKE_BLIT_CTRL(0x00, 0),
+                    .mod_a = (uint16_t)(src_stride - words - extra),
+                    .src_a = src,
+                    .mod_b = (uint16_t)(src_stride - words - extra),
+                    .src_b = mask,
+                    .mod_d = (uint16_t)(dst_stride - words - extra),
+                    .dst_d = dst,
+                    .shift = shift ? xv_blit_shift(shift) : 0xFF00,
+                    .lines = (uint16_t)(lines - 1),
+                    .words = (uint16_t)(words - 1 + extra)};
+    xv_blit_queue(&op);
+}
+
+void xv_blit_copy_transp(uint16_t dst,
+                         uint16_t dst_stride,
+                         uint16_t src,
+                         uint16_t src_stride,
+                         uint16_t words,
+                         uint16_t lines,
+                         uint8_t  shift,
+                         uint8_t  transp,
+                         bool     transp_8b)
+{
+    shift &= 3;
+    uint16_t extra = shift ? 1 : 0;
+    // source read as B (transparency is tested on B), A constant all ones so D = B
+    xv_blit_t op = {.ctrl  = MAKE_BLIT_CTRL(transp, BLIT_CTRL_A_CONST | (transp_8b ? BLIT_CTRL_TRANSP_8B : 0)),
+                    .src_a = 0xFFFF,
+                    .mod_b = (uint16_t)(src_stride - words - extra),
+                    .src_b = src,
+                    .mod_d = (uint16_t)(dst_stride - words - extra),
+                    .dst_d = dst,
+                    .shift = shift ? xv_blit_shift(shift) : 0xFF00,
+                    .lines = (uint16_t)(lines - 1),
+                    .words = (uint16_t)(words - 1 + extra)};
+    xv_blit_queue(&op);
+}
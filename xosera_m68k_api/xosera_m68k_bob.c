@@ -0,0 +1,251 @@
+/*
+ * vim: set et ts=4 sw=4
+ *------------------------------------------------------------
+ *  __ __
+ * |  |  |___ ___ ___ ___ ___
+ * |-   -| . |_ -| -_|  _| .'|
+ * |__|__|___|___|___|_| |__,|
+ *
+ * Xark's Open Source Enhanced Retro Adapter
+ *
+ * - "Not as clumsy or random as a GPU, an embedded retro
+ *    adapter for a more civilized age."
+ *
+ * ------------------------------------------------------------
+ * Copyright (c) 2021 Xark
+ * MIT License
+ *
+ * Xosera rosco_m68k C API blitter objects (BOBs) with dirty rectangle restore
+ * ------------------------------------------------------------
+ */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define XV_PREP_REQUIRED
+#include "xosera_m68k_api.h"
+
+// BOBs are 4-bit pixel images (and optional masks) in VRAM drawn over a 4-bit bitmap by the blitter.  A clean copy of
+// the background bitmap is kept in VRAM, and each frame xv_bobs_draw() first queues copies from it over the rectangles
+// drawn into the destination last time, then queues the BOB blits (using BLIT_SHIFT for the pixel within the word).
+// The CPU only computes addresses and writes blitter registers, so it is free once the operations are queued.
+//
+// Dirty rectangles are kept per destination address, so with page flipping (see xosera_m68k_vsync.c) each buffer
+// restores what was last drawn into it.  BOBs are clipped to the bitmap in whole words, so up to 3 pixels of a BOB
+// partly off the left or right edge may not be drawn.
+
+#if !defined(XV_BOBS_MAX)
+#define XV_BOBS_MAX 64        // maximum BOBs drawn per frame
+#endif
+#define XV_BOBS_MAX_BUFFERS 3
+
+typedef struct _xv_bob_rect
+{
+    uint16_t offset;        // word offset in bitmap
+    uint16_t words;
+    uint16_t lines;
+} xv_bob_rect_t;
+
+typedef struct _xv_bob_dirty
+{
+    uint16_t      dst;               // destination bitmap address
+    uint8_t       num_rects;
+    xv_bob_rect_t rects[XV_BOBS_MAX];
+} xv_bob_dirty_t;
+
+static uint16_t        xv_bobs_background;        // clean background bitmap address
+static uint16_t        xv_bobs_stride;            // bitmap words per line
+static uint16_t        xv_bobs_lines;             // bitmap lines
+static uint8_t         xv_bobs_num_dirty;
+static xv_bob_dirty_t  xv_bobs_dirty[XV_BOBS_MAX_BUFFERS];
+static uint16_t        xv_bobs_start;        // XM_TIMER at start of last xv_bobs_draw()
+static xv_bobs_stats_t xv_bobs_last;
+
+// return dirty rectangle list for destination address (reusing oldest if new)
+static xv_bob_dirty_t * xv_bobs_dirty_list(uint16_t dst)
+{
+    for (uint8_t i = 0; i < xv_bobs_num_dirty; i++)
+    {
+        if (xv_bobs_dirty[i].dst == dst)
+        {
+            return &xv_bobs_dirty[i];
+        }
+    }
+
+    xv_bob_dirty_t * dl;
+    if (xv_bobs_num_dirty < XV_BOBS_MAX_BUFFERS)
+    {
+        dl = &xv_bobs_dirty[xv_bobs_num_dirty++];
+    }
+    else
+    {
+        // more destinations than buffers, forget first (its rectangles are not restored)
+        for (uint8_t i = 1; i < XV_BOBS_MAX_BUFFERS; i++)
+        {
+            xv_bobs_dirty[i - 1] = xv_bobs_dirty[i];
+        }
+        dl = &xv_bobs_dirty[XV_BOBS_MAX_BUFFERS - 1];
+    }
+    dl->dst       = dst;
+    dl->num_rects = 0;
+
+    return dl;
+}
+
+// set clean background bitmap (stride words per line and lines) BOBs are drawn over, forgets dirty rectangles
+void xv_bobs_init(uint16_t background, uint16_t stride, uint16_t lines)
+{
+    xv_bobs_background = background;
+    xv_bobs_stride     = stride;
+    xv_bobs_lines      = lines;
+    xv_bobs_num_dirty  = 0;
+}
+
+// upload BOB image (words per line * lines) to VRAM at vaddr, followed by a mask (0xF for each non-zero pixel) if
+// make_mask, returns VRAM address after image (and mask)
+uint16_t xv_bob_load(uint16_t vaddr, const uint16_t * image, uint8_t words, uint8_t lines, bool make_mask)
+{
+    uint16_t size = (uint16_t)(words * lines);
+
+    xv_vram_write(vaddr, image, size);
+    vaddr += size;
+    if (!make_mask)
+    {
+        return vaddr;
+    }
+
+    xv_prep();
+
+    uint16_t mask[16];
+    uint8_t  n = 0;
+    xm_setw(WR_INCR, 1);
+    xm_setw(WR_ADDR, vaddr);
+    for (uint16_t i = 0; i < size; i++)
+    {
+        uint16_t p = image[i];
+        uint16_t m = 0;
+        for (uint16_t nibble = 0xF; nibble != 0; nibble <<= 4)
+        {
+            if (p & nibble)
+            {
+                m |= nibble;
+            }
+        }
+        mask[n++] = m;
+        if (n == 16)
+        {
+            xv_data_write(mask, n);
+            n = 0;
+        }
+    }
+    xv_data_write(mask, n);
+
+    return vaddr + size;
+}
+
+// restore rectangles drawn into dst last time, then draw BOBs (blits queued, use xv_bobs_wait() to wait for them)
+void xv_bobs_draw(uint16_t dst, const xv_bob_t * bobs, uint8_t num_bobs)
+{
+    xv_prep();
+
+    xv_bobs_start = xm_getw(TIMER);
+
+    xv_bobs_stats_t  stats = {0};
+    xv_bob_dirty_t * dl    = xv_bobs_dirty_list(dst);
+
+    for (uint8_t i = 0; i < dl->num_rects; i++)
+    {
+        const xv_bob_rect_t * r = &dl->rects[i];
+        xv_blit_copy(dst + r->offset,
+                     xv_bobs_stride,
+                     xv_bobs_background + r->offset,
+                     xv_bobs_stride,
+                     r->words,
+                     r->lines);
+        stats.restores++;
+        stats.blit_words += (uint32_t)r->words * r->lines;
+    }
+    dl->num_rects = 0;
+
+    if (num_bobs > XV_BOBS_MAX)
+    {
+        num_bobs = XV_BOBS_MAX;
+    }
+    for (uint8_t i = 0; i < num_bobs; i++)
+    {
+        const xv_bob_t * bp    = &bobs[i];
+        uint16_t         src   = bp->image;
+        uint16_t         mask  = bp->mask;
+        int16_t          col   = (int16_t)(bp->x >> 2);        // NOTE: arithmetic shift, so floor for negative x
+        int16_t          y     = bp->y;
+        int16_t          words = bp->words;
+        int16_t          lines = bp->lines;
+        uint8_t          shift = bp->x & 3;
+        int16_t          extra = shift ? 1 : 0;
+
+        // clip to bitmap (in whole words horizontally)
+        if (y < 0)
+        {
+            src += (uint16_t)(-y * bp->words);
+            mask += (uint16_t)(-y * bp->words);
+            lines += y;
+            y = 0;
+        }
+        if (y + lines > (int16_t)xv_bobs_lines)
+        {
+            lines = (int16_t)xv_bobs_lines - y;
+        }
+        if (col < 0)
+        {
+            src -= (uint16_t)col;
+            mask -= (uint16_t)col;
+            words += col;
+            col = 0;
+        }
+        if (col + words + extra > (int16_t)xv_bobs_stride)
+        {
+            words = (int16_t)xv_bobs_stride - col - extra;
+        }
+        if (words <= 0 || lines <= 0)
+        {
+            continue;
+        }
+
+        uint16_t offset = (uint16_t)(y * xv_bobs_stride + col);
+        if (bp->mask == XV_BOB_NO_MASK)
+        {
+            xv_blit_copy_transp(dst + offset, xv_bobs_stride, src, bp->words, words, lines, shift, 0x00, false);
+        }
+        else
+        {
+            xv_blit_copy_masked(dst + offset, xv_bobs_stride, src, mask, bp->words, words, lines, shift);
+        }
+
+        xv_bob_rect_t * r = &dl->rects[dl->num_rects++];
+        r->offset         = offset;
+        r->words          = (uint16_t)(words + extra);
+        r->lines          = (uint16_t)lines;
+        stats.draws++;
+        stats.blit_words += (uint32_t)r->words * r->lines;
+    }
+
+    stats.cpu_ticks = xm_getw(TIMER) - xv_bobs_start;
+    xv_bobs_last    = stats;
+}
+
+// wait for blits queued by last xv_bobs_draw() to complete (and record blitter time)
+void xv_bobs_wait(void)
+{
+    xv_prep();
+
+    xv_blit_wait();
+    xv_bobs_last.blit_ticks = xm_getw(TIMER) - xv_bobs_start;
+}
+
+// return statistics for last xv_bobs_draw() (blit_ticks set by xv_bobs_wait())
+const xv_bobs_stats_t * xv_bobs_stats(void)
+{
+    return &xv_bobs_last;
+}
@@ -0,0 +1,118 @@
+/*
+ * vim: set et ts=4 sw=4
+ *------------------------------------------------------------
+ *  __ __
+ * |  |  |___ ___ ___ ___ ___
+ * |-   -| . |_ -| -_|  _| .'|
+ * |__|__|___|___|___|_| |__,|
+ *
+ * Xark's Open Source Enhanced Retro Adapter
+ *
+ * - "Not as clumsy or random as a GPU, an embedded retro
+ *    adapter for a more civilized age."
+ *
+ * ------------------------------------------------------------
+ * Copyright (c) 2021 Xark
+ * MIT License
+ *
+ * Xosera rosco_m68k C API copper list loading and double buffering
+ * ------------------------------------------------------------
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define XV_PREP_REQUIRED
+#include "xosera_m68k_api.h"
+
+// Copper instructions are built with the COP_* macros in xosera_m68k_defs.h (constant expressions, so static lists
+// are encoded at compile time).  XR_ADDR auto-increments on XR_DATA writes, so a list is loaded with one XR_ADDR write
+// then two XR_DATA writes per instruction (or emitted directly into copper memory with xv_copper_emit()).
+//
+// Copper addresses here are word offsets in copper memory (even, as each instruction is two words).  COPP_CTRL
+// takes the instruction index (address / 2), COP_JUMP() takes the word offset.
+//
+// Writing COPP_CTRL only sets the PC the copper restarts at after the next vertical blank, so switching lists is
+// already atomic with the frame.  Double buffering just needs to know when the previous list is no longer running:
+// after a swap, the old list is in use until the frame ends (vertical blank reached or the scanline count wraps).
+
+static uint16_t xv_copper_addr[2];          // copper addresses of double buffered lists
+static uint8_t  xv_copper_back_num;         // list being built
+static bool     xv_copper_pending;          // swap done, but previous list may still be running
+static uint16_t xv_copper_swap_line;        // scanline when swap was done
+
+// write num_insns copper instructions from list to copper memory at cop_addr (word offset in copper memory)
+void xv_copper_load(uint16_t cop_addr, const uint32_t * list, uint16_t num_insns)
+{
+    xv_prep();
+
+    xm_setw(XR_ADDR, XR_COPPER_ADDR + cop_addr);
+    for (uint16_t i = num_insns >> 2; i != 0; --i)
+    {
+        xv_copper_emit(list[0]);
+        xv_copper_emit(list[1]);
+        xv_copper_emit(list[2]);
+        xv_copper_emit(list[3]);
+        list += 4;
+    }
+    for (uint16_t i = num_insns & 3; i != 0; --i)
+    {
+        xv_copper_emit(*list++);
+    }
+}
+
+// enable copper starting at cop_addr (from next frame)
+void xv_copper_start(uint16_t cop_addr)
+{
+    xv_prep();
+
+    xreg_setw(COPP_CTRL, 0x8000 | (cop_addr >> 1));
+}
+
+// disable copper
+void xv_copper_stop(void)
+{
+    xv_prep();
+
+    xreg_setw(COPP_CTRL, 0x0000);
+}
+
+// set copper addresses for double buffered lists (display starts with first xv_copper_swap())
+void xv_copper_double(uint16_t cop_addr_0, uint16_t cop_addr_1)
+{
+    xv_copper_addr[0]  = cop_addr_0;
+    xv_copper_addr[1]  = cop_addr_1;
+    xv_copper_back_num = 0;
+    xv_copper_pending  = false;
+}
+
+// return copper address of list to build, waiting (if needed) until it is no longer being run by the copper
+uint16_t xv_copper_back(void)
+{
+    xv_prep();
+
+    while (xv_copper_pending)
+    {
+        uint16_t scanline = xreg_getw(SCANLINE);
+        if ((scanline & 0x8000) || (scanline & 0x07FF) < xv_copper_swap_line)
+        {
+            xv_copper_pending = false;
+        }
+    }
+
+    return xv_copper_addr[xv_copper_back_num];
+}
+
+// run back list from next frame (old front list becomes back list once the current frame ends)
+void xv_copper_swap(void)
+{
+    xv_prep();
+
+    xreg_setw(COPP_CTRL, 0x8000 | (xv_copper_addr[xv_copper_back_num] >> 1));
+    uint16_t scanline = xreg_getw(SCANLINE);
+    // NOTE: if swapped during vertical blank, the new list starts at end of blank and the old list is already done
+    xv_copper_pending   = !(scanline & 0x8000);
+    xv_copper_swap_line = scanline & 0x07FF;
+    xv_copper_back_num ^= 1;
+}
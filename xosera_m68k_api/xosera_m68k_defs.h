@@ -66,6 +66,12 @@
 #define SYS_CTRL_BLITBUSY_B 6
 #define SYS_CTRL_BLITFULL_B 5
 
+// Xosera interrupt sources (bit numbers in SYS_CTRL interrupt mask, VID_CTRL status and TIMER clear)
+#define INTR_AUDIO_B  0        // audio channel 0 reload
+#define INTR_BLIT_B   1        // blit operation done
+#define INTR_COPPER_B 2        // copper signal
+#define INTR_VSYNC_B  3        // vertical sync (start of vertical blank)
+
 #define MK_SYS_CTRL(reboot, bootcfg, intena, wrmask)                                                                   \
     (XB_(reboot, 15, 1) | XB_(bootcfg, 14, 2) | XB_(intena, 11, 4) | XB_(wrmask, 3, 0))
 
@@ -136,6 +142,17 @@
 #define XR_BLIT_LINES 0x2A        // (R /W) blit number of lines minus 1, (repeats blit word count after modulo calc)
 #define XR_BLIT_WORDS 0x2B        // (R /W) blit word count minus 1 per line (write starts blit operation)
 
+// XR_BLIT_CTRL flags
+#define BLIT_CTRL_A_CONST   0x0001        // A term is SRC_A constant (vs VRAM read)
+#define BLIT_CTRL_B_CONST   0x0002        // B term is SRC_B constant (vs VRAM read)
+#define BLIT_CTRL_NOT_B     0x0004        // invert B term in logic operation (not transparency test)
+#define BLIT_CTRL_C_USE_B   0x0008        // C term is B term (vs VAL_C constant)
+#define BLIT_CTRL_DECR      0x0010        // decrement addresses (and shift left)
+#define BLIT_CTRL_TRANSP_8B 0x0020        // transparency test 8-bit pixels (vs 4-bit)
+
+#define MAKE_BLIT_CTRL(transp, flags)           (XB_(transp, 8, 8) | (flags))
+#define MAKE_BLIT_SHIFT(f_mask, l_mask, shift) (XB_(f_mask, 12, 4) | XB_(l_mask, 8, 4) | XB_(shift, 0, 2))
+
 // Copper instruction helper macros
 #define COP_WAIT_HV(h_pos, v_pos)   (0x00000000 | XB_((uint32_t)(v_pos), 16, 12) | XB_((uint32_t)(h_pos), 4, 12))
 #define COP_WAIT_H(h_pos)           (0x00000001 | XB_((uint32_t)(h_pos), 4, 12))
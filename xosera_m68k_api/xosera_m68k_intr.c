@@ -0,0 +1,138 @@
+/*
+ * vim: set et ts=4 sw=4
+ *------------------------------------------------------------
+ *  __ __
+ * |  |  |___ ___ ___ ___ ___
+ * |-   -| . |_ -| -_|  _| .'|
+ * |__|__|___|___|___|_| |__,|
+ *
+ * Xark's Open Source Enhanced Retro Adapter
+ *
+ * - "Not as clumsy or random as a GPU, an embedded retro
+ *    adapter for a more civilized age."
+ *
+ * ------------------------------------------------------------
+ * Copyright (c) 2021 Xark
+ * MIT License
+ *
+ * Xosera rosco_m68k C API interrupt dispatch
+ * ------------------------------------------------------------
+ */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define XV_PREP_REQUIRED
+#include "xosera_m68k_api.h"
+
+// Xosera interrupts arrive on the rosco_m68k level 2 autovector.  The handler reads the pending sources from the low
+// bits of XR_VID_CTRL, acknowledges them by writing the same bits to XM_TIMER, then calls the handler set for each
+// source (blit done first so the blitter is fed with minimum delay).  XM_XR_ADDR is saved and restored around all of it
+// (restoring it also re-reads XM_XR_DATA), so handlers may use xreg_*/xmem_* freely, but must save and restore any
+// other XM registers they change.
+
+#define XV_INTR_VECTOR     0x68        // level 2 autovector (Xosera)
+#define XV_SPURIOUS_VECTOR 0x60        // spurious interrupt vector
+
+static xv_intr_fn xv_intr_handlers[4];        // indexed by INTR_*_B
+static uint32_t   xv_intr_old_vector;
+static bool       xv_intr_installed;
+
+static void __attribute__((interrupt_handler)) xv_intr_handler(void)
+{
+    xv_prep();
+    uint16_t xr_addr = xm_getw(XR_ADDR);
+    xm_setw(XR_ADDR, XR_VID_CTRL);
+    uint8_t status = xm_getbl(XR_DATA) & 0x0F;
+    xm_setbl(TIMER, status);        // acknowledge sources being serviced
+
+    if (status & (1 << INTR_BLIT_B))
+    {
+        xv_intr_handlers[INTR_BLIT_B]();
+    }
+    if (status & (1 << INTR_VSYNC_B))
+    {
+        xv_intr_handlers[INTR_VSYNC_B]();
+    }
+    if (status & (1 << INTR_COPPER_B))
+    {
+        xv_intr_handlers[INTR_COPPER_B]();
+    }
+    if (status & (1 << INTR_AUDIO_B))
+    {
+        xv_intr_handlers[INTR_AUDIO_B]();
+    }
+
+    xm_setw(XR_ADDR, xr_addr);
+}
+
+// do nothing handler for masked sources (status bits are set even when masked)
+static void xv_intr_none(void)
+{
+}
+
+void xv_intr_install(void)
+{
+    if (xv_intr_installed)
+    {
+        return;
+    }
+
+    xv_prep();
+    uint16_t sr = xv_intr_disable();
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        xv_intr_handlers[i] = xv_intr_none;
+    }
+    xm_setbh(SYS_CTRL, 0x00);        // mask all sources (NOTE: bit 7 would reconfigure FPGA)
+    xm_setbl(TIMER, 0x0F);           // clear any pending
+    xv_intr_old_vector                   = *(volatile uint32_t *)XV_INTR_VECTOR;
+    *(volatile uint32_t *)XV_INTR_VECTOR = (uint32_t)(uintptr_t)xv_intr_handler;
+    xv_intr_installed                    = true;
+    xv_intr_restore(sr & 0xF8FF);        // enable interrupts
+}
+
+void xv_intr_remove(void)
+{
+    if (!xv_intr_installed)
+    {
+        return;
+    }
+
+    xv_prep();
+    uint16_t sr = xv_intr_disable();
+    xm_setbh(SYS_CTRL, 0x00);
+    xm_setbl(TIMER, 0x0F);
+    // previous vector if it was set, else spurious interrupt handler (as firmware)
+    uint32_t vector = xv_intr_old_vector ? xv_intr_old_vector : *(volatile uint32_t *)XV_SPURIOUS_VECTOR;
+    *(volatile uint32_t *)XV_INTR_VECTOR = vector;
+    xv_intr_installed                    = false;
+    xv_intr_restore(sr);
+}
+
+void xv_intr_set(uint8_t intr_b, xv_intr_fn fn)
+{
+    if (!xv_intr_installed || intr_b > INTR_VSYNC_B)
+    {
+        return;
+    }
+
+    xv_prep();
+    uint16_t sr   = xv_intr_disable();
+    uint8_t  mask = xm_getbh(SYS_CTRL) & 0x0F;
+    if (fn != NULL)
+    {
+        xv_intr_handlers[intr_b] = fn;
+        mask |= (uint8_t)(1 << intr_b);
+    }
+    else
+    {
+        xv_intr_handlers[intr_b] = xv_intr_none;
+        mask &= (uint8_t)~(1 << intr_b);
+    }
+    xm_setbl(TIMER, (uint8_t)(1 << intr_b));        // clear stale status
+    xm_setbh(SYS_CTRL, mask);
+    xv_intr_restore(sr);
+}
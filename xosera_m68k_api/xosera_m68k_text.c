@@ -0,0 +1,256 @@
+/*
+ * vim: set et ts=4 sw=4
+ *------------------------------------------------------------
+ *  __ __
+ * |  |  |___ ___ ___ ___ ___
+ * |-   -| . |_ -| -_|  _| .'|
+ * |__|__|___|___|___|_| |__,|
+ *
+ * Xark's Open Source Enhanced Retro Adapter
+ *
+ * - "Not as clumsy or random as a GPU, an embedded retro
+ *    adapter for a more civilized age."
+ *
+ * ------------------------------------------------------------
+ * Copyright (c) 2021 Xark
+ * MIT License
+ *
+ * Xosera rosco_m68k C API text screen output
+ * ------------------------------------------------------------
+ */
+
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define XV_PREP_REQUIRED
+#include "xosera_m68k_api.h"
+
+// Text is written in runs: the longest string of printable characters that fits on the current line is written after
+// one address register write, then control characters move the position.  For VRAM screens each pair of characters is
+// one MOVEP.L of two color+glyph words to XM_DATA/XM_DATA_2 (so half the register writes of one word per character,
+// and no separate color byte writes).  XR screens (e.g. in tile memory) set XM_XR_ADDR once per run and write one word
+// per character to XM_XR_DATA.  xv_text_printf() formats into a RAM line buffer first, so a whole formatted line is
+// normally a single run.
+//
+// XM_WR_INCR is not written per run: VRAM text needs it to be 1, which xv_text_init() and xv_text_cls() set (as do
+// xv_vram_write() and xv_vram_fill()).  Code that sets another increment (or uses xv_vram_copy()) between text calls
+// must set it back to 1 before writing text.
+
+#if !defined(XV_TEXT_BUFFER_SIZE)
+#define XV_TEXT_BUFFER_SIZE 256        // xv_text_printf() line buffer (longer output is truncated)
+#endif
+
+static char xv_text_buffer[XV_TEXT_BUFFER_SIZE];
+
+// set address register for current position (WR_ADDR for VRAM, XR_ADDR for XR)
+static void xv_text_addr(const xv_text_t * t)
+{
+    xv_prep();
+
+    uint16_t addr = (uint16_t)(t->addr + (t->y * t->columns) + t->x);
+    if (t->xr)
+    {
+        xm_setw(XR_ADDR, addr);
+    }
+    else
+    {
+        xm_setw(WR_ADDR, addr);        // NOTE: XM_WR_INCR already 1 (see above)
+    }
+}
+
+// write num printable characters at current position (must fit on line)
+static void xv_text_run(xv_text_t * t, const char * str, uint8_t num)
+{
+    xv_prep();
+
+    uint16_t attr = (uint16_t)(t->color << 8);
+    xv_text_addr(t);
+    t->x += num;
+
+    if (t->xr)
+    {
+        while (num--)
+        {
+            xm_setw(XR_DATA, attr | (uint8_t)*str++);
+        }
+        return;
+    }
+
+    uint32_t attr2 = ((uint32_t)attr << 16) | attr;
+    for (uint8_t i = num >> 1; i != 0; --i)
+    {
+        xm_setl(DATA, attr2 | ((uint32_t)(uint8_t)str[0] << 16) | (uint8_t)str[1]);
+        str += 2;
+    }
+    if (num & 1)
+    {
+        xm_setw(DATA, attr | (uint8_t)*str);
+    }
+}
+
+// write num spaces at current position (must fit on line)
+static void xv_text_spaces(xv_text_t * t, uint16_t num)
+{
+    xv_prep();
+
+    uint16_t word = (uint16_t)((t->color << 8) | ' ');
+    xv_text_addr(t);
+    t->x += num;
+
+    if (t->xr)
+    {
+        while (num--)
+        {
+            xm_setw(XR_DATA, word);
+        }
+        return;
+    }
+    xv_data_fill(word, num);
+}
+
+static void xv_text_newline(xv_text_t * t)
+{
+    t->x = 0;
+    if (++t->y >= t->rows)
+    {
+        t->y = 0;
+    }
+}
+
+// set text screen address (in VRAM or XR memory), size and default color (home position, sets WR_INCR to 1 for VRAM)
+void xv_text_init(xv_text_t * t, uint16_t addr, uint8_t columns, uint8_t rows, bool xr)
+{
+    xv_prep();
+
+    t->addr    = addr;
+    t->columns = columns;
+    t->rows    = rows;
+    t->x       = 0;
+    t->y       = 0;
+    t->color   = 0x02;        // dark green on black
+    t->xr      = xr;
+
+    if (!xr)
+    {
+        xm_setw(WR_INCR, 1);
+    }
+}
+
+void xv_text_pos(xv_text_t * t, uint8_t x, uint8_t y)
+{
+    t->x = x < t->columns ? x : t->columns - 1;
+    t->y = y < t->rows ? y : t->rows - 1;
+}
+
+void xv_text_color(xv_text_t * t, uint8_t color)
+{
+    t->color = color;
+}
+
+// fill screen with spaces in current color and home position (sets WR_INCR to 1 for VRAM)
+void xv_text_cls(xv_text_t * t)
+{
+    uint16_t word = (uint16_t)((t->color << 8) | ' ');
+    uint16_t size = (uint16_t)(t->columns * t->rows);
+
+    if (t->xr)
+    {
+        xv_prep();
+        xm_setw(XR_ADDR, t->addr);
+        for (uint16_t i = 0; i < size; i++)
+        {
+            xm_setw(XR_DATA, word);
+        }
+    }
+    else
+    {
+        xv_vram_fill(t->addr, word, size);
+    }
+    t->x = 0;
+    t->y = 0;
+}
+
+// write len characters, '\n' clears rest of line and moves to start of next, '\r' to start of line, '\b' back one
+// character and '\f' clears screen (other control characters ignored, position wraps to top after last line)
+void xv_text_write(xv_text_t * t, const char * str, uint16_t len)
+{
+    while (len)
+    {
+        uint8_t room = t->columns - t->x;
+        uint8_t num  = 0;
+        while (num < room && num < len && (uint8_t)str[num] >= ' ')
+        {
+            num++;
+        }
+        if (num)
+        {
+            xv_text_run(t, str, num);
+            str += num;
+            len -= num;
+            if (t->x >= t->columns)
+            {
+                xv_text_newline(t);
+            }
+            continue;
+        }
+
+        char c = *str++;
+        len--;
+        switch (c)
+        {
+            case '\n':
+                xv_text_spaces(t, t->columns - t->x);
+                xv_text_newline(t);
+                break;
+            case '\r':
+                t->x = 0;
+                break;
+            case '\b':
+                if (t->x)
+                {
+                    t->x--;
+                }
+                else if (t->y)
+                {
+                    t->x = t->columns - 1;
+                    t->y--;
+                }
+                break;
+            case '\f':
+                xv_text_cls(t);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void xv_text_print(xv_text_t * t, const char * str)
+{
+    xv_text_write(t, str, (uint16_t)strlen(str));
+}
+
+void xv_text_vprintf(xv_text_t * t, const char * fmt, va_list args)
+{
+    int len = vsnprintf(xv_text_buffer, sizeof(xv_text_buffer), fmt, args);
+    if (len >= (int)sizeof(xv_text_buffer))
+    {
+        len = sizeof(xv_text_buffer) - 1;        // truncated
+    }
+    if (len > 0)
+    {
+        xv_text_write(t, xv_text_buffer, (uint16_t)len);
+    }
+}
+
+void xv_text_printf(xv_text_t * t, const char * fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    xv_text_vprintf(t, fmt, args);
+    va_end(args);
+}
@@ -0,0 +1,253 @@
+/*
+ * vim: set et ts=4 sw=4
+ *------------------------------------------------------------
+ *  __ __
+ * |  |  |___ ___ ___ ___ ___
+ * |-   -| . |_ -| -_|  _| .'|
+ * |__|__|___|___|___|_| |__,|
+ *
+ * Xark's Open Source Enhanced Retro Adapter
+ *
+ * - "Not as clumsy or random as a GPU, an embedded retro
+ *    adapter for a more civilized age."
+ *
+ * ------------------------------------------------------------
+ * Copyright (c) 2021 Xark
+ * MIT License
+ *
+ * Xosera rosco_m68k C API bulk VRAM transfer functions
+ * ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(XV_HOST_MODEL)
+#include "xv_host_model.h"        // host build against register model (see host_model/)
+#else
+#define XV_PREP_REQUIRED
+#include "xosera_m68k_api.h"
+#endif
+
+// The loops below move 8 longs (16 words) per iteration with MOVEP.L to XM_DATA/XM_DATA_2, then any remaining longs
+// and a final odd word.  The RD/WR and RW register pairs are the same distance apart (XM_RW_* = XM_* + 0x20), so the
+// _rw functions use the same loops with xosera_ptr offset to make XM_DATA refer to XM_RW_DATA.
+#define XV_RW_OFFSET ((XM_RW_DATA - XM_DATA) >> 2)        // xmreg_t offset from XM_DATA to XM_RW_DATA
+
+// long load/store of word buffers (as 68000 big-endian longs)
+#if defined(XV_HOST_MODEL)
+static inline uint32_t xv_load_long(const uint16_t * p)
+{
+    return ((uint32_t)p[0] << 16) | p[1];
+}
+
+static inline void xv_store_long(uint16_t * p, uint32_t v)
+{
+    p[0] = (uint16_t)(v >> 16);
+    p[1] = (uint16_t)v;
+}
+#else
+typedef uint32_t __attribute__((may_alias)) xv_long_t;
+
+static inline uint32_t xv_load_long(const uint16_t * p)
+{
+    return *(const xv_long_t *)p;
+}
+
+static inline void xv_store_long(uint16_t * p, uint32_t v)
+{
+    *(xv_long_t *)p = v;
+}
+#endif
+
+// write num_words from src to XM_DATA (at xosera_ptr), using current WR_ADDR and WR_INCR
+static void xv_write_words(volatile xmreg_t * const xosera_ptr, const uint16_t * src, uint32_t num_words)
+{
+    for (uint32_t i = num_words >> 4; i != 0; --i)
+    {
+        xm_setl(DATA, xv_load_long(src + 0));
+        xm_setl(DATA, xv_load_long(src + 2));
+        xm_setl(DATA, xv_load_long(src + 4));
+        xm_setl(DATA, xv_load_long(src + 6));
+        xm_setl(DATA, xv_load_long(src + 8));
+        xm_setl(DATA, xv_load_long(src + 10));
+        xm_setl(DATA, xv_load_long(src + 12));
+        xm_setl(DATA, xv_load_long(src + 14));
+        src += 16;
+    }
+    for (uint16_t i = (num_words >> 1) & 7; i != 0; --i)
+    {
+        xm_setl(DATA, xv_load_long(src));
+        src += 2;
+    }
+    if (num_words & 1)
+    {
+        xm_setw(DATA, *src);
+    }
+}
+
+// read num_words from XM_DATA (at xosera_ptr) to dst, using current RD_ADDR and RD_INCR
+static void xv_read_words(volatile xmreg_t * const xosera_ptr, uint16_t * dst, uint32_t num_words)
+{
+    for (uint32_t i = num_words >> 4; i != 0; --i)
+    {
+        xv_store_long(dst + 0, xm_getl(DATA));
+        xv_store_long(dst + 2, xm_getl(DATA));
+        xv_store_long(dst + 4, xm_getl(DATA));
+        xv_store_long(dst + 6, xm_getl(DATA));
+        xv_store_long(dst + 8, xm_getl(DATA));
+        xv_store_long(dst + 10, xm_getl(DATA));
+        xv_store_long(dst + 12, xm_getl(DATA));
+        xv_store_long(dst + 14, xm_getl(DATA));
+        dst += 16;
+    }
+    for (uint16_t i = (num_words >> 1) & 7; i != 0; --i)
+    {
+        xv_store_long(dst, xm_getl(DATA));
+        dst += 2;
+    }
+    if (num_words & 1)
+    {
+        *dst = xm_getw(DATA);
+    }
+}
+
+// write word num_words times to XM_DATA (at xosera_ptr), using current WR_ADDR and WR_INCR
+static void xv_fill_words(volatile xmreg_t * const xosera_ptr, uint16_t word, uint32_t num_words)
+{
+    uint32_t lval = ((uint32_t)word << 16) | word;
+    for (uint32_t i = num_words >> 4; i != 0; --i)
+    {
+        xm_setl(DATA, lval);
+        xm_setl(DATA, lval);
+        xm_setl(DATA, lval);
+        xm_setl(DATA, lval);
+        xm_setl(DATA, lval);
+        xm_setl(DATA, lval);
+        xm_setl(DATA, lval);
+        xm_setl(DATA, lval);
+    }
+    for (uint16_t i = (num_words >> 1) & 7; i != 0; --i)
+    {
+        xm_setl(DATA, lval);
+    }
+    if (num_words & 1)
+    {
+        xm_setw(DATA, word);
+    }
+}
+
+// write num_words from src to VRAM at current WR_ADDR (e.g., streaming loader)
+void xv_data_write(const uint16_t * src, uint32_t num_words)
+{
+    xv_prep();
+    xv_write_words(xosera_ptr, src, num_words);
+}
+
+// write word num_words times to VRAM at current WR_ADDR
+void xv_data_fill(uint16_t word, uint32_t num_words)
+{
+    xv_prep();
+    xv_fill_words(xosera_ptr, word, num_words);
+}
+
+// write num_words from src to VRAM at vaddr (sets WR_INCR to 1)
+void xv_vram_write(uint16_t vaddr, const uint16_t * src, uint32_t num_words)
+{
+    xv_prep();
+    xm_setw(WR_INCR, 1);
+    xm_setw(WR_ADDR, vaddr);
+    xv_write_words(xosera_ptr, src, num_words);
+}
+
+// read num_words from VRAM at vaddr to dst (sets RD_INCR to 1)
+void xv_vram_read(uint16_t vaddr, uint16_t * dst, uint32_t num_words)
+{
+    xv_prep();
+    xm_setw(RD_INCR, 1);
+    xm_setw(RD_ADDR, vaddr);
+    xv_read_words(xosera_ptr, dst, num_words);
+}
+
+// fill num_words of VRAM at vaddr with word (sets WR_INCR to 1)
+void xv_vram_fill(uint16_t vaddr, uint16_t word, uint32_t num_words)
+{
+    xv_prep();
+    xm_setw(WR_INCR, 1);
+    xm_setw(WR_ADDR, vaddr);
+    xv_fill_words(xosera_ptr, word, num_words);
+}
+
+// copy num_words of VRAM from src_vaddr to dst_vaddr, overlap safe (sets RD_INCR and WR_INCR to 1 or -1)
+void xv_vram_copy(uint16_t dst_vaddr, uint16_t src_vaddr, uint32_t num_words)
+{
+    if (dst_vaddr == src_vaddr || num_words == 0)
+    {
+        return;
+    }
+
+    xv_prep();
+
+    // copy backwards (last word first) when destination starts inside source
+    uint16_t incr = 1;
+    if ((uint16_t)(dst_vaddr - src_vaddr) < num_words)
+    {
+        incr = 0xFFFF;
+        src_vaddr += (uint16_t)(num_words - 1);
+        dst_vaddr += (uint16_t)(num_words - 1);
+    }
+    xm_setw(RD_INCR, incr);
+    xm_setw(WR_INCR, incr);
+    xm_setw(RD_ADDR, src_vaddr);
+    xm_setw(WR_ADDR, dst_vaddr);
+
+    for (uint32_t i = num_words >> 4; i != 0; --i)
+    {
+        xm_setl(DATA, xm_getl(DATA));
+        xm_setl(DATA, xm_getl(DATA));
+        xm_setl(DATA, xm_getl(DATA));
+        xm_setl(DATA, xm_getl(DATA));
+        xm_setl(DATA, xm_getl(DATA));
+        xm_setl(DATA, xm_getl(DATA));
+        xm_setl(DATA, xm_getl(DATA));
+        xm_setl(DATA, xm_getl(DATA));
+    }
+    for (uint16_t i = (num_words >> 1) & 7; i != 0; --i)
+    {
+        xm_setl(DATA, xm_getl(DATA));
+    }
+    if (num_words & 1)
+    {
+        xm_setw(DATA, xm_getw(DATA));
+    }
+}
+
+// write num_words from src to VRAM at vaddr using RW registers (sets RW_INCR to 1, WR_ADDR/WR_INCR untouched)
+void xv_vram_write_rw(uint16_t vaddr, const uint16_t * src, uint32_t num_words)
+{
+    xv_prep();
+    xm_setw(RW_INCR, 1);
+    xm_setw(RW_ADDR, vaddr);
+    xv_write_words(xosera_ptr + XV_RW_OFFSET, src, num_words);
+}
+
+// read num_words from VRAM at vaddr to dst using RW registers (sets RW_INCR to 1, SYS_CTRL RW_RD_INC restored)
+void xv_vram_read_rw(uint16_t vaddr, uint16_t * dst, uint32_t num_words)
+{
+    xv_prep();
+    uint8_t sys_ctrl = xm_getbl(SYS_CTRL) & 0x1F;        // RW_RD_INC flag and write mask
+    xm_setbl(SYS_CTRL, sys_ctrl | 0x10);                 // RW_DATA reads add RW_INCR
+    xm_setw(RW_INCR, 1);
+    xm_setw(RW_ADDR, vaddr);
+    xv_read_words(xosera_ptr + XV_RW_OFFSET, dst, num_words);
+    xm_setbl(SYS_CTRL, sys_ctrl);
+}
+
+// fill num_words of VRAM at vaddr with word using RW registers (sets RW_INCR to 1, WR_ADDR/WR_INCR untouched)
+void xv_vram_fill_rw(uint16_t vaddr, uint16_t word, uint32_t num_words)
+{
+    xv_prep();
+    xm_setw(RW_INCR, 1);
+    xm_setw(RW_ADDR, vaddr);
+    xv_fill_words(xosera_ptr + XV_RW_OFFSET, word, num_words);
+}
@@ -0,0 +1,269 @@
+/*
+ * vim: set et ts=4 sw=4
+ *------------------------------------------------------------
+ *  __ __
+ * |  |  |___ ___ ___ ___ ___
+ * |-   -| . |_ -| -_|  _| .'|
+ * |__|__|___|___|___|_| |__,|
+ *
+ * Xark's Open Source Enhanced Retro Adapter
+ *
+ * - "Not as clumsy or random as a GPU, an embedded retro
+ *    adapter for a more civilized age."
+ *
+ * ------------------------------------------------------------
+ * Copyright (c) 2021 Xark
+ * MIT License
+ *
+ * Xosera rosco_m68k C API vertical blank service and page flipping
+ * ------------------------------------------------------------
+ */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define XV_PREP_REQUIRED
+#include "xosera_m68k_api.h"
+
+// The vsync interrupt arrives at the start of vertical blank, so a PA_DISP_ADDR written from it takes effect with the
+// next frame (never mid-frame).  Page flipping keeps up to three display buffers: one being displayed, one drawn and
+// ready to display at the next vertical blank, and one being drawn.  With two buffers, xv_vsync_draw_buffer() waits
+// for the ready buffer to be displayed before the previously displayed one can be drawn into.  Waits use the 68010
+// STOP instruction, so the CPU idles until the next interrupt instead of polling XR_SCANLINE.
+//
+// XR register writes that must land in blanking (scroll, GFX_CTRL, palette etc.) can be queued with xv_vblank_xr_setw()
+// and are published together by xv_vblank_commit().  The vsync interrupt writes all committed entries with one MOVEP.L
+// each (XM_XR_ADDR and XM_XR_DATA are adjacent registers), so a committed batch is always applied within one vertical
+// blank.  The fence returned by xv_vblank_commit() can be tested or waited on to know when it has been applied.
+
+#define XV_VSYNC_MAX_BUFFERS 3
+#define XV_VSYNC_NONE        0xFF
+
+#if !defined(XV_VBLANK_QUEUE_SIZE)
+#define XV_VBLANK_QUEUE_SIZE 64        // must be power of two (and <= 256)
+#endif
+
+static volatile uint32_t xv_vsync_frames;                           // vsync interrupt count
+static xv_intr_fn        xv_vsync_fn;                               // user callback (or NULL)
+static bool              xv_vsync_active;                           // vsync interrupt handler installed
+static uint16_t          xv_vsync_addr[XV_VSYNC_MAX_BUFFERS];        // PA_DISP_ADDR of each buffer
+static uint8_t           xv_vsync_num_buffers;
+static volatile uint8_t  xv_vsync_display;        // buffer being displayed
+static volatile uint8_t  xv_vsync_ready;          // buffer to display next vertical blank (or NONE)
+static uint8_t           xv_vsync_draw;           // buffer being drawn (or NONE)
+
+static uint32_t          xv_vblank_queue[XV_VBLANK_QUEUE_SIZE];        // XR address << 16 | value
+static volatile uint8_t  xv_vblank_head;             // next entry to write (advanced by interrupt)
+static volatile uint8_t  xv_vblank_commit_end;       // end of committed entries
+static uint8_t           xv_vblank_tail;             // next free entry (advanced by xv_vblank_xr_setw)
+static volatile uint32_t xv_vblank_committed;        // fence of last commit
+static volatile uint32_t xv_vblank_applied;          // fence of last commit written by interrupt
+
+// vsync interrupt, display ready buffer then call user callback (XR_ADDR restored by dispatcher)
+static void xv_vsync_handler(void)
+{
+    xv_prep();
+
+    uint8_t ready = xv_vsync_ready;
+    if (ready != XV_VSYNC_NONE)
+    {
+        xreg_setw(PA_DISP_ADDR, xv_vsync_addr[ready]);
+        xv_vsync_display = ready;
+        xv_vsync_ready   = XV_VSYNC_NONE;
+    }
+
+    uint8_t head = xv_vblank_head;
+    uint8_t end  = xv_vblank_commit_end;
+    while (head != end)
+    {
+        xm_setl(XR_ADDR, xv_vblank_queue[head]);        // XR_ADDR and XR_DATA
+        head = (head + 1) & (XV_VBLANK_QUEUE_SIZE - 1);
+    }
+    xv_vblank_head    = head;
+    xv_vblank_applied = xv_vblank_committed;
+
+    xv_vsync_frames++;
+    if (xv_vsync_fn != NULL)
+    {
+        xv_vsync_fn();
+    }
+}
+
+// start vsync interrupt service (fn is called every vertical blank in interrupt context, may be NULL)
+void xv_vsync_init(xv_intr_fn fn)
+{
+    xv_vsync_fn          = fn;
+    xv_vsync_num_buffers = 0;
+    xv_vsync_ready       = XV_VSYNC_NONE;
+    xv_vsync_draw        = XV_VSYNC_NONE;
+    xv_vblank_head       = 0;
+    xv_vblank_commit_end = 0;
+    xv_vblank_tail       = 0;
+    xv_vblank_committed  = 0;
+    xv_vblank_applied    = 0;
+    xv_intr_install();
+    xv_intr_set(INTR_VSYNC_B, xv_vsync_handler);
+    xv_vsync_active = true;
+}
+
+// stop vsync interrupt service
+void xv_vsync_remove(void)
+{
+    xv_intr_set(INTR_VSYNC_B, NULL);
+    xv_vsync_active = false;
+}
+
+// return number of vertical blanks since xv_vsync_init()
+uint32_t xv_vsync_frame(void)
+{
+    return xv_vsync_frames;
+}
+
+// wait until next vertical blank (CPU stopped until interrupts)
+void xv_vsync_wait(void)
+{
+    if (!xv_vsync_active)
+    {
+        xv_prep();
+        while (xreg_getw(SCANLINE) & 0x8000)
+            ;
+        while (!(xreg_getw(SCANLINE) & 0x8000))
+            ;
+        return;
+    }
+
+    uint32_t frame = xv_vsync_frames;
+    for (;;)
+    {
+        // interrupts disabled so vsync can't be missed between test and STOP (which re-enables them)
+        uint16_t sr = xv_intr_disable();
+        if (xv_vsync_frames != frame)
+        {
+            xv_intr_restore(sr);
+            break;
+        }
+        __asm__ __volatile__("stop #0x2000" : : : "memory");
+        xv_intr_restore(sr);
+    }
+}
+
+// set display buffers for page flipping (2 or 3 PA_DISP_ADDR values), first buffer is displayed
+void xv_vsync_buffers(uint8_t num_buffers, const uint16_t * disp_addr)
+{
+    xv_prep();
+
+    if (num_buffers > XV_VSYNC_MAX_BUFFERS)
+    {
+        num_buffers = XV_VSYNC_MAX_BUFFERS;
+    }
+
+    uint16_t sr = xv_intr_disable();
+    for (uint8_t i = 0; i < num_buffers; i++)
+    {
+        xv_vsync_addr[i] = disp_addr[i];
+    }
+    xv_vsync_num_buffers = num_buffers;
+    xv_vsync_display     = 0;
+    xv_vsync_ready       = XV_VSYNC_NONE;
+    xv_vsync_draw        = XV_VSYNC_NONE;
+    xreg_setw(PA_DISP_ADDR, disp_addr[0]);
+    xv_intr_restore(sr);
+}
+
+// return VRAM address of buffer to draw next frame into (waits until a buffer is not displayed or ready)
+uint16_t xv_vsync_draw_buffer(void)
+{
+    if (xv_vsync_num_buffers < 2)
+    {
+        return xv_vsync_addr[0];        // no page flipping
+    }
+
+    while (xv_vsync_draw == XV_VSYNC_NONE)
+    {
+        uint16_t sr = xv_intr_disable();        // vsync may move ready buffer to display
+        for (uint8_t i = 0; i < xv_vsync_num_buffers; i++)
+        {
+            if (i != xv_vsync_display && i != xv_vsync_ready)
+            {
+                xv_vsync_draw = i;
+                break;
+            }
+        }
+        xv_intr_restore(sr);
+        if (xv_vsync_draw == XV_VSYNC_NONE)
+        {
+            xv_vsync_wait();
+        }
+    }
+
+    return xv_vsync_addr[xv_vsync_draw];
+}
+
+// display buffer just drawn from next vertical blank (waits if previous flip has not been displayed yet)
+void xv_vsync_flip(void)
+{
+    if (xv_vsync_draw == XV_VSYNC_NONE)
+    {
+        return;
+    }
+
+    while (xv_vsync_ready != XV_VSYNC_NONE)
+    {
+        xv_vsync_wait();
+    }
+    xv_vsync_ready = xv_vsync_draw;
+    xv_vsync_draw  = XV_VSYNC_NONE;
+}
+
+// queue XR register (or XR memory) write for next vertical blank after xv_vblank_commit()
+void xv_vblank_xr_setw(uint16_t xr_addr, uint16_t value)
+{
+    if (!xv_vsync_active)
+    {
+        xv_prep();
+        xm_setl(XR_ADDR, ((uint32_t)xr_addr << 16) | value);
+        return;
+    }
+
+    uint8_t next = (xv_vblank_tail + 1) & (XV_VBLANK_QUEUE_SIZE - 1);
+    while (next == xv_vblank_head)
+    {
+        // queue full, batch too large to be applied in one vertical blank (commit what is queued)
+        if (xv_vblank_commit_end != xv_vblank_tail)
+        {
+            xv_vblank_commit();
+        }
+        xv_vsync_wait();
+    }
+    xv_vblank_queue[xv_vblank_tail] = ((uint32_t)xr_addr << 16) | value;
+    xv_vblank_tail                  = next;
+}
+
+// publish queued writes to be applied together at next vertical blank, returns fence for xv_vblank_done()
+uint32_t xv_vblank_commit(void)
+{
+    uint16_t sr          = xv_intr_disable();
+    uint32_t fence       = xv_vblank_committed + 1;
+    xv_vblank_committed  = fence;
+    xv_vblank_commit_end = xv_vblank_tail;
+    xv_intr_restore(sr);
+
+    return fence;
+}
+
+// return true if writes committed with fence have been applied
+bool xv_vblank_done(uint32_t fence)
+{
+    return !xv_vsync_active || (int32_t)(xv_vblank_applied - fence) >= 0;
+}
+
+// wait until writes committed with fence have been applied
+void xv_vblank_fence_wait(uint32_t fence)
+{
+    while (!xv_vblank_done(fence))
+    {
+        xv_vsync_wait();
+    }
+}
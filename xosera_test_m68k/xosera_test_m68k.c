@@ -46,6 +46,7 @@
 #endif
 
 #include "xosera_m68k_api.h"
+#include "xosera_rle.h"
 
 extern void install_intr(void);
 extern void remove_intr(void);
@@ -337,49 +338,38 @@ static void dprintf(const char * fmt, ...)
     va_end(args);
 }
 
-static uint16_t screen_addr;
-static uint8_t  text_columns;
-static uint8_t  text_rows;
-static uint8_t  text_color = 0x02;        // dark green on black
+static xv_text_t text_screen;        // VRAM text (playfield A)
+static uint8_t   text_columns;
 
 static void get_textmode_settings()
 {
     uint16_t vx          = (xreg_getw(PA_GFX_CTRL) & 3) + 1;
     uint16_t tile_height = (xreg_getw(PA_TILE_CTRL) & 0xf) + 1;
-    screen_addr          = xreg_getw(PA_DISP_ADDR);
     text_columns         = (uint8_t)xreg_getw(PA_LINE_LEN);
-    text_rows            = (uint8_t)(((xreg_getw(VID_VSIZE) / vx) + (tile_height - 1)) / tile_height);
+    xv_text_init(&text_screen,
+                 xreg_getw(PA_DISP_ADDR),
+                 text_columns,
+                 (uint8_t)(((xreg_getw(VID_VSIZE) / vx) + (tile_height - 1)) / tile_height),
+                 false);
 }
 
 static void xcls()
 {
     get_textmode_settings();
-    xm_setw(WR_INCR, 1);
-    xm_setw(WR_ADDR, screen_addr);
-    xm_setbh(DATA, text_color);
-    for (uint16_t i = 0; i < (text_columns * text_rows); i++)
-    {
-        xm_setbl(DATA, ' ');
-    }
-    xm_setw(WR_ADDR, screen_addr);
+    xv_text_cls(&text_screen);
+    xm_setw(WR_ADDR, text_screen.addr);
 }
 
 static const char * xmsg(int x, int y, int color, const char * msg)
 {
-    xm_setw(WR_ADDR, (y * text_columns) + x);
-    xm_setbh(DATA, color);
-    char c;
-    while ((c = *msg) != '\0')
-    {
-        msg++;
-        if (c == '\n')
-        {
-            break;
-        }
+    const char * end = strchr(msg, '\n');
+    uint16_t     len = end ? (uint16_t)(end - msg) : (uint16_t)strlen(msg);
 
-        xm_setbl(DATA, c);
-    }
-    return msg;
+    xv_text_pos(&text_screen, x, y);
+    xv_text_color(&text_screen, color);
+    xv_text_write(&text_screen, msg, len);
+
+    return end ? end + 1 : msg + len;
 }
 
 static void reset_vid(void)
@@ -444,32 +434,19 @@ _NOINLINE void delay_check(int ms)
     }
 }
 
-static uint16_t xr_screen_addr = XR_TILE_ADDR + 0x1000;
-static uint8_t  xr_text_columns;
-static uint8_t  xr_text_rows;
-static uint8_t  xr_text_color = 0x07;        // white on gray
-static uint8_t  xr_x;
-static uint8_t  xr_y;
+static xv_text_t xr_text;        // XR text (playfield B in tile memory)
 
 static void xr_cls()
 {
-    xv_prep();
-
-    xm_setw(XR_ADDR, xr_screen_addr);
-    for (int i = 0; i < xr_text_columns * xr_text_rows; i++)
-    {
-        xm_setw(XR_DATA, ' ');
-    }
-    xr_x = 0;
-    xr_y = 0;
+    xv_text_cls(&xr_text);
 }
 
 static void xr_textmode_pb()
 {
     xv_prep();
 
-    xr_text_columns = 28;
-    xr_text_rows    = 20;
+    xv_text_init(&xr_text, XR_TILE_ADDR + 0x1000, 28, 20, true);
+    xv_text_color(&xr_text, 0x07);        // white on gray
 
     wait_vsync_start();
     xreg_setw(PB_GFX_CTRL, 0x0080);
@@ -489,65 +466,30 @@ static void xr_textmode_pb()
     wait_vsync();
     xreg_setw(PB_GFX_CTRL, 0xF00A);         // colorbase = 0xF0 tiled + 1-bpp + Hx3 + Vx2
     xreg_setw(PB_TILE_CTRL, 0x0E07);        // tile=0x0C00,tile=tile_mem, map=tile_mem, 8x8 tiles
-    xreg_setw(PB_LINE_LEN, xr_text_columns);
-    xreg_setw(PB_DISP_ADDR, xr_screen_addr);
+    xreg_setw(PB_LINE_LEN, xr_text.columns);
+    xreg_setw(PB_DISP_ADDR, xr_text.addr);
 }
 
 static void xr_msg_color(uint8_t c)
 {
-    xr_text_color = c;
+    xv_text_color(&xr_text, c);
 }
 
 static void xr_pos(int x, int y)
 {
-    xr_x = x;
-    xr_y = y;
-}
-
-static void xr_putc(const char c)
-{
-    xm_setw(XR_ADDR, xr_screen_addr + (xr_y * xr_text_columns) + xr_x);
-    if (c == '\n')
-    {
-        while (xr_x < xr_text_columns)
-        {
-            xm_setw(XR_DATA, ' ');
-            xr_x++;
-        }
-        xr_x = 0;
-        xr_y += 1;
-    }
-    else if (c == '\r')
-    {
-        xr_x = 0;
-    }
-    else
-    {
-        xm_setw(XR_DATA, (xr_text_color << 8) | (uint8_t)c);
-        xr_x++;
-        if (xr_x >= xr_text_columns)
-        {
-            xr_x = 0;
-            xr_y++;
-        }
-    }
+    xv_text_pos(&xr_text, x, y);
 }
 
 static void xr_print(const char * str)
 {
-    register char c;
-    while ((c = *str++) != '\0')
-    {
-        xr_putc(c);
-    }
+    xv_text_print(&xr_text, str);
 }
 
 static void xr_printf(const char * fmt, ...)
 {
     va_list args;
     va_start(args, fmt);
-    vsnprintf(dprint_buff, sizeof(dprint_buff), fmt, args);
-    xr_print(dprint_buff);
+    xv_text_vprintf(&xr_text, fmt, args);
     va_end(args);
 }
 
@@ -556,8 +498,7 @@ static void xr_printfxy(int x, int y, const char * fmt, ...)
     va_list args;
     va_start(args, fmt);
     xr_pos(x, y);
-    vsnprintf(dprint_buff, sizeof(dprint_buff), fmt, args);
-    xr_print(dprint_buff);
+    xv_text_vprintf(&xr_text, fmt, args);
     va_end(args);
 }
 
@@ -669,9 +610,9 @@ static bool load_test_audio(const char * filename, void ** out, int * size)
             dprintf("\rReading \"%s\": %d KB ", filename, rsize >> 10);
             if (rsize)
             {
-                uint8_t ox = xr_x;
+                uint8_t ox = xr_text.x;
                 xr_printf("%3dK", rsize >> 10);
-                xr_x = ox;
+                xr_text.x = ox;
             }
         }
 
@@ -730,9 +671,9 @@ static bool load_test_image(int mode, const char * filename, const char * colorn
             dprintf("\rReading \"%s\": %d KB ", filename, rsize >> 10);
             if (rsize)
             {
-                uint8_t ox = xr_x;
+                uint8_t ox = xr_text.x;
                 xr_printf("%3dK", rsize >> 10);
-                xr_x = ox;
+                xr_text.x = ox;
             }
         }
 
@@ -906,6 +847,33 @@ void show_test_pic(int pic_num, uint16_t addr)
     }
 }
 
+// XRLE decoder output, words go straight to XM_DATA (WR_ADDR and WR_INCR already set)
+static void xrle_vram_literal(void * ctx, const uint8_t * words, uint32_t num_words)
+{
+    (void)ctx;
+    xv_prep();
+
+    if (((uintptr_t)words & 1) == 0)
+    {
+        xv_data_write((const uint16_t *)words, num_words);
+    }
+    else
+    {
+        while (num_words--)
+        {
+            xm_setw(DATA, (words[0] << 8) | words[1]);
+            words += 2;
+        }
+    }
+}
+
+static void xrle_vram_repeat(void * ctx, uint16_t word, uint32_t num_words)
+{
+    (void)ctx;
+    xv_data_fill(word, num_words);
+}
+
+// loads raw bitmap, or XRLE compressed bitmap (see utils/xosera_rle.h) decoded as it is read
 static void load_sd_bitmap(const char * filename, int vaddr)
 {
     dprintf("Loading bitmap: \"%s\"", filename);
@@ -913,25 +881,56 @@ static void load_sd_bitmap(const char * filename, int vaddr)
 
     if (file != NULL)
     {
-        int cnt = 0;
+        int            cnt    = 0;
+        int            blocks = 0;
+        bool           rle    = false;
+        int            rc     = XRLE_MORE;
+        xrle_decoder_t dec;
 
         while ((cnt = fl_fread(mem_buffer, 1, 512, file)) > 0)
         {
-            if ((vaddr & 0xFFF) == 0)
+            if (blocks++ == 0 && cnt >= XRLE_HEADER && xrle_check((uint8_t *)mem_buffer))
             {
-                dprintf(".");
+                rle = true;
+                xrle_decode_init(&dec, xrle_vram_literal, xrle_vram_repeat, NULL);
+                xm_setw(WR_INCR, 1);
+                xm_setw(WR_ADDR, vaddr);
+                dprintf(" (XRLE)");
             }
 
-            uint16_t * maddr = (uint16_t *)mem_buffer;
-            xm_setw(WR_INCR, 1);
-            xm_setw(WR_ADDR, vaddr);
-            for (int i = 0; i < (cnt >> 1); i++)
+            if (rle)
             {
-                xm_setw(DATA, *maddr++);
+                if ((blocks & 0xF) == 0)
+                {
+                    dprintf(".");
+                }
+
+                rc = xrle_decode(&dec, (uint8_t *)mem_buffer, cnt);
+                if (rc != XRLE_MORE)
+                {
+                    if (rc == XRLE_ERROR)
+                    {
+                        dprintf(" - bad XRLE data");
+                    }
+                    break;
+                }
+                checkbail();
+                continue;
             }
+
+            if ((vaddr & 0xFFF) == 0)
+            {
+                dprintf(".");
+            }
+
+            xv_vram_write(vaddr, (uint16_t *)mem_buffer, cnt >> 1);
             vaddr += (cnt >> 1);
             checkbail();
         }
+        if (rle && rc == XRLE_MORE)
+        {
+            dprintf(" - truncated XRLE data");        // file ended before all words decoded
+        }
 
         fl_fclose(file);
         dprintf("done!\n");
@@ -1037,6 +1036,7 @@ void draw8bpp_v_line(uint16_t base, uint8_t color, int x, int y, int len)
         xm_setw(DATA, word);        // set full word
     }
     xm_setbl(SYS_CTRL, 0xf);
+    xm_setw(WR_INCR, 1);        // restore write inc (for text output)
 }
 
 static inline void wait_blit_done()
@@ -1051,12 +1051,11 @@ static inline void wait_blit_ready()
 #define NUM_BOBS 10        // number of sprites (ideally no "red" border)
 struct bob
 {
-    int8_t   x_delta, y_delta;
-    int16_t  x_pos, y_pos;
-    uint16_t w_offset;
+    int8_t x_delta, y_delta;
 };
 
 struct bob      bobs[NUM_BOBS];
+xv_bob_t        bob_sprites[NUM_BOBS];
 static uint16_t blit_shift[4]  = {0xF000, 0x7801, 0x3C02, 0x1E03};
 static uint16_t blit_rshift[4] = {0x8700, 0xC301, 0xE102, 0xF003};
 
@@ -1125,20 +1124,8 @@ void test_blit()
         xr_printfxy(0, 0, "Blit 320x240 16 color\n");        // set write address
 
         // 2D screen screen copy 0x0000 -> 0x4B00 320x240 4-bpp
-        wait_blit_ready();
-        xreg_setw(BLIT_CTRL, 0x0002);             // constB
-        xreg_setw(BLIT_MOD_A, 0x0000);            // no modulo A
-        xreg_setw(BLIT_SRC_A, paddr);             // A = source
-        xreg_setw(BLIT_MOD_B, 0x0000);            // no modulo B
-        xreg_setw(BLIT_SRC_B, 0xFFFF);            // AND with B (and disable transparency)
-        xreg_setw(BLIT_MOD_C, 0x0000);            // no modulo C
-        xreg_setw(BLIT_VAL_C, 0x0000);            // XOR with C
-        xreg_setw(BLIT_MOD_D, 0x0000);            // no modulo D
-        xreg_setw(BLIT_DST_D, daddr);             // VRAM display end address
-        xreg_setw(BLIT_SHIFT, 0xFF00);            // no edge masking or shifting
-        xreg_setw(BLIT_LINES, H_4BPP - 1);        // lines (0 for 1-D blit)
-        xreg_setw(BLIT_WORDS, W_4BPP - 1);        // words to write -1
-        wait_blit_done();
+        xv_blit_copy(daddr, W_4BPP, paddr, W_4BPP, W_4BPP, H_4BPP);
+        xv_blit_wait();
         xreg_setw(PA_DISP_ADDR, daddr);
 
         xr_printfxy(0, 0, "Blit 320x240 16 color\nShift right\n");        // set write address
@@ -1210,8 +1197,12 @@ void test_blit()
 
         for (int b = 0; b < NUM_BOBS; b++)
         {
-            bobs[b].x_pos = b * 22;
-            bobs[b].y_pos = b * 18;
+            bob_sprites[b].x     = b * 22;
+            bob_sprites[b].y     = b * 18;
+            bob_sprites[b].image = maddr;
+            bob_sprites[b].mask  = XV_BOB_NO_MASK;        // pixel value 0 transparent
+            bob_sprites[b].words = W_LOGO;
+            bob_sprites[b].lines = H_LOGO;
             uint16_t r;
             r               = xm_getw(LFSR);
             bobs[b].x_delta = r & 0x8 ? -((r & 3) - 1) : ((r & 3) + 1);
@@ -1236,66 +1227,45 @@ void test_blit()
         xr_printfxy(0, 0, "Blit 320x240 16 color\nBOB test (single buffered)\n");        // set write address
         int nb = NUM_BOBS;
         dprintf("Num bobs = %d\n", nb);
+        xv_bobs_init(paddr, W_4BPP, H_4BPP);
+        uint32_t cpu_ticks  = 0;
+        uint32_t blit_ticks = 0;
         for (int i = 0; i < 256; i++)
         {
             for (int b = 0; b < nb; b++)
             {
+                xv_bob_t *   sp = &bob_sprites[b];
                 struct bob * bp = &bobs[b];
-                wait_blit_ready();                             // make sure blit ready (previous blit started)
-                xreg_setw(BLIT_CTRL, 0xEE02);                  // constB, 4bpp transp=E
-                xm_setw(XR_DATA, W_4BPP - W_LOGO - 1);         // A modulo
-                xm_setw(XR_DATA, paddr + bp->w_offset);        // A initial term (not used)
-                xm_setw(XR_DATA, 0x0000);                      // B modulo
-                xm_setw(XR_DATA, 0xFFFF);                      // B source+transp VRAM addr (moto_m)
-                xm_setw(XR_DATA, 0x0000);                      // C modulo
-                xm_setw(XR_DATA, 0x0000);                      // C XOR const
-                xm_setw(XR_DATA, W_4BPP - W_LOGO - 1);         // D modulo
-                xm_setw(XR_DATA, daddr + bp->w_offset);        // D destination VRAM addr
-                xm_setw(XR_DATA, 0xFF00);                // first, last word nibble masks, and 0-3 shift (low two bits)
-                xm_setw(XR_DATA, H_LOGO - 1);            // lines (0 for 1-D blit)
-                xm_setw(XR_DATA, W_LOGO - 1 + 1);        // words to write -1
-
-                bp->x_pos += bp->x_delta;
-                if (bp->x_pos < -16)
-                    bp->x_pos += 320 + 16;
-                else if (bp->x_pos > 320)
-                    bp->x_pos -= 320;
-
-                bp->y_pos += bp->y_delta;
-                if (bp->y_pos < -16)
-                    bp->y_pos += 240 + 16;
-                else if (bp->y_pos > 240)
-                    bp->y_pos -= 240;
-            }
-            for (int b = 0; b < nb; b++)
-            {
-                struct bob * bp  = &bobs[b];
-                uint16_t     off = (uint16_t)(bp->x_pos >> 2) + (uint16_t)((uint16_t)W_4BPP * bp->y_pos);
-                bp->w_offset     = off;
-                uint8_t shift    = bp->x_pos & 3;
-
-                wait_blit_ready();                            // make sure blit ready (previous blit started)
-                xreg_setw(BLIT_CTRL, 0x0001);                 // constA
-                xm_setw(XR_DATA, 0x0000);                     // A modulo
-                xm_setw(XR_DATA, 0xFFFF);                     // A initial term (not used)
-                xm_setw(XR_DATA, -1);                         // B modulo
-                xm_setw(XR_DATA, maddr);                      // B source+transp VRAM addr (moto_m)
-                xm_setw(XR_DATA, 0x0000);                     // C modulo
-                xm_setw(XR_DATA, 0x0000);                     // C XOR const
-                xm_setw(XR_DATA, W_4BPP - W_LOGO - 1);        // D modulo
-                xm_setw(XR_DATA, daddr + off);                // D destination VRAM addr
-                xm_setw(XR_DATA,
-                        blit_shift[shift]);              // first, last word nibble masks, and 0-3 shift (low two bits)
-                xm_setw(XR_DATA, H_LOGO - 1);            // lines (0 for 1-D blit)
-                xm_setw(XR_DATA, W_LOGO - 1 + 1);        // words to write -1
+
+                sp->x += bp->x_delta;
+                if (sp->x < -16)
+                    sp->x += 320 + 16;
+                else if (sp->x > 320)
+                    sp->x -= 320;
+
+                sp->y += bp->y_delta;
+                if (sp->y < -16)
+                    sp->y += 240 + 16;
+                else if (sp->y > 240)
+                    sp->y -= 240;
             }
+            // restore background under previous bobs and draw bobs with blitter
+            xv_bobs_draw(daddr, bob_sprites, nb);
             xmem_setw(XR_COLOR_A_ADDR + 255, 0xfff0);        // set write address
             checkbail();
-            wait_blit_done();
+            xv_bobs_wait();
+            cpu_ticks += xv_bobs_stats()->cpu_ticks;
+            blit_ticks += xv_bobs_stats()->blit_ticks;
             xmem_setw(XR_COLOR_A_ADDR + 255, 0xf0f0);        // set write address
             wait_vsync();
             xmem_setw(XR_COLOR_A_ADDR + 255, 0xff00);        // set write address
         }
+        dprintf("BOB frame average: CPU %u.%02u ms, blitter %u.%02u ms (%u words)\n",
+                (unsigned int)(cpu_ticks / 2560),
+                (unsigned int)((cpu_ticks % 2560) * 100 / 2560),
+                (unsigned int)(blit_ticks / 2560),
+                (unsigned int)((blit_ticks % 2560) * 100 / 2560),
+                (unsigned int)xv_bobs_stats()->blit_words);
 
         xmem_setw(XR_COLOR_A_ADDR + 255, 0xf000);        // set write address
 
@@ -16,6 +16,7 @@
 #include <unistd.h>
 
 #include "ftdi_spi.h"
+#include "xosera_rle.h"
 
 
 typedef enum
@@ -162,9 +163,12 @@ enum
     SPI_CMD_WR      = 0x40,
     SPI_CMD_RS      = 0x20,
     SPI_CMD_BYTESEL = 0x10,
+    SPI_CMD_STREAM  = 0x40,        // stream write header: 0100RRRR, word count-1, then N even/odd byte pairs
     SPI_CMD_REGMASK = 0x0F
 };
 
+#define STREAM_WORDS 256        // maximum words in one stream write packet
+
 #define DEBUG_HEXDUMP 1
 
 #if 0
@@ -216,6 +220,33 @@ inline int spi_queue_cmd(uint8_t cmd, uint8_t data)
     return off;
 }
 
+// write num_words big-endian words from data to register r using stream write packets (see rtl/spi_bus.sv)
+// NOTE: each packet must be sent with SPI selected for the whole packet (de-select ends a stream)
+static void xvid_stream_words(uint8_t r, const uint8_t * data, size_t num_words)
+{
+    static uint8_t stream_buffer[2 + STREAM_WORDS * 2];
+
+    spi_queue_flush();
+    while (num_words)
+    {
+        size_t count     = num_words > STREAM_WORDS ? STREAM_WORDS : num_words;
+        size_t len       = 2 + count * 2;
+        stream_buffer[0] = SPI_CMD_STREAM | (r & SPI_CMD_REGMASK);
+        stream_buffer[1] = static_cast<uint8_t>(count - 1);
+        memcpy(stream_buffer + 2, data, count * 2);
+
+#if DEBUG_HEXDUMP
+        printf("STREAM[%zu words]: ", count);        // (before transfer replaces bytes sent with reply)
+        hexdump(len < 16 ? len : 16, stream_buffer);
+#endif
+        host_spi_cs(false);        // select
+        host_spi_xfer_bytes(len, stream_buffer);
+        host_spi_cs(true);        // de-select
+        data += count * 2;
+        num_words -= count;
+    }
+}
+
 void delay(int ms)
 {
     spi_queue_flush();
@@ -279,6 +310,129 @@ static inline uint8_t xvid_gethb(uint8_t r)
     return xvid_getb(r, 0);
 }
 
+// VRAM shadow for xvid_push_frame (host copy of VRAM words previously pushed)
+static uint16_t vram_shadow[64 * 1024];                 // last VRAM word value pushed
+static uint8_t  vram_shadow_known[64 * 1024 / 8];        // bit set if vram_shadow word matches VRAM
+static size_t   push_spi_bytes;                          // SPI bytes sent by xvid_push_frame
+static size_t   push_full_bytes;                         // SPI bytes a full rewrite would have sent
+
+// forget VRAM shadow (call after VRAM is written other than with xvid_push_frame)
+static void xvid_shadow_invalidate()
+{
+    memset(vram_shadow_known, 0, sizeof(vram_shadow_known));
+}
+
+static inline bool shadow_matches(uint16_t vaddr, uint16_t word)
+{
+    return (vram_shadow_known[vaddr >> 3] & (1 << (vaddr & 7))) && vram_shadow[vaddr] == word;
+}
+
+// SPI bytes to write word to XM_DATA (low byte only if XM_DATA even byte already latched)
+static inline int push_word_cost(int data_even, uint16_t word)
+{
+    return (data_even == (word >> 8)) ? 2 : 4;
+}
+
+// Push num_words frame words to VRAM at vaddr, sending only words that differ from the VRAM shadow.
+// Each run of changed words is reached with an XM_WR_ADDR jump (low byte only when high byte is unchanged) or, when
+// cheaper, by rewriting the unchanged words in between.  Words are sent as XM_DATA low byte only when the even byte
+// latched by the previous write matches.  Returns number of SPI bytes queued.
+static size_t xvid_push_frame(uint16_t vaddr, const uint16_t * frame, uint32_t num_words)
+{
+    size_t   bytes     = 0;
+    int32_t  wr_addr   = -1;        // current XM_WR_ADDR (or -1 if unknown)
+    uint32_t wr_index  = 0;         // frame index at XM_WR_ADDR
+    int      data_even = -1;        // XM_DATA even byte latched (or -1 if unknown)
+    bool     set_incr  = true;
+
+    for (uint32_t i = 0; i < num_words; i++)
+    {
+        uint16_t a = static_cast<uint16_t>(vaddr + i);
+        uint16_t w = frame[i];
+
+        if (shadow_matches(a, w))
+        {
+            continue;
+        }
+
+        if (set_incr)
+        {
+            xvid_setw(XM_WR_INCR, 1);
+            bytes += 4;
+            set_incr = false;
+        }
+
+        if (wr_addr != a)
+        {
+            int jump_cost = (wr_addr >= 0 && (wr_addr >> 8) == (a >> 8)) ? 2 : 4;
+            int gap_cost  = jump_cost + 1;        // assume jump unless rewriting gap is cheaper
+
+            if (wr_addr >= 0)
+            {
+                int de   = data_even;
+                gap_cost = 0;
+                for (uint32_t g = wr_index; g < i && gap_cost <= jump_cost; g++)
+                {
+                    gap_cost += push_word_cost(de, frame[g]);
+                    de = frame[g] >> 8;
+                }
+            }
+
+            if (gap_cost <= jump_cost)
+            {
+                for (uint32_t g = wr_index; g < i; g++)
+                {
+                    uint16_t gw = frame[g];
+                    if (push_word_cost(data_even, gw) == 2)
+                    {
+                        xvid_setlb(XM_DATA, gw & 0xff);
+                    }
+                    else
+                    {
+                        xvid_setw(XM_DATA, gw);
+                    }
+                    bytes += push_word_cost(data_even, gw);
+                    data_even = gw >> 8;
+                }
+            }
+            else if (jump_cost == 2)
+            {
+                xvid_setlb(XM_WR_ADDR, a & 0xff);
+                bytes += 2;
+            }
+            else
+            {
+                xvid_setw(XM_WR_ADDR, a);
+                bytes += 4;
+            }
+        }
+
+        if (push_word_cost(data_even, w) == 2)
+        {
+            xvid_setlb(XM_DATA, w & 0xff);
+            bytes += 2;
+        }
+        else
+        {
+            xvid_setw(XM_DATA, w);
+            bytes += 4;
+        }
+        data_even = w >> 8;
+
+        vram_shadow[a] = w;
+        vram_shadow_known[a >> 3] |= static_cast<uint8_t>(1 << (a & 7));
+        wr_addr  = static_cast<uint16_t>(a + 1);
+        wr_index = i + 1;
+    }
+
+    spi_queue_flush();
+
+    push_spi_bytes += bytes;
+    push_full_bytes += 8 + (num_words * 4);        // XM_WR_INCR, XM_WR_ADDR and XM_DATA per word
+
+    return bytes;
+}
+
 static void xcolor(uint8_t color)
 {
     uint16_t wa = xvid_getw(XM_WR_ADDR);
@@ -387,7 +541,7 @@ static void wait_vsync(uint16_t num = 1)
     {
         do
         {
-            xvid_setw(XM_XR_DATA, XR_SCANLINE);        // set scanline reg
+            xvid_setw(XM_XR_ADDR, XR_SCANLINE);        // set scanline reg
             v_flag = xvid_gethb(XM_XR_DATA);           // read scanline upper byte
         } while (!(v_flag & 0x80));                    // loop if on visible line
     }
@@ -675,6 +829,30 @@ static void problem(const char * msg, uint16_t addr, uint16_t rdata, uint16_t vd
 }
 
 
+// XRLE decoder output, literal words are streamed straight from the input buffer
+static void xrle_spi_literal(void *, const uint8_t * words, uint32_t num_words)
+{
+    xvid_stream_words(XM_DATA, words, num_words);
+}
+
+static void xrle_spi_repeat(void *, uint16_t word, uint32_t num_words)
+{
+    static uint8_t fill[STREAM_WORDS * 2];
+    uint32_t       fill_words = num_words < STREAM_WORDS ? num_words : STREAM_WORDS;
+    for (uint32_t i = 0; i < fill_words; i++)
+    {
+        fill[i * 2 + 0] = word >> 8;
+        fill[i * 2 + 1] = word & 0xff;
+    }
+    while (num_words)
+    {
+        uint32_t count = num_words < STREAM_WORDS ? num_words : STREAM_WORDS;
+        xvid_stream_words(XM_DATA, fill, count);
+        num_words -= count;
+    }
+}
+
+// loads raw bitmap, or XRLE compressed bitmap (see utils/xosera_rle.h) decoded as it is sent
 static void test_mono_bitmap(const char * filename)
 {
     printf("Loading mono bitmap: \"%s\"", filename);
@@ -684,20 +862,46 @@ static void test_mono_bitmap(const char * filename)
 
     if (file != NULL)
     {
-        int cnt   = 0;
-        int vaddr = 0;
+        int            cnt   = 0;
+        int            vaddr = 0;
+        bool           first = true;
+        bool           rle   = false;
+        int            rc    = XRLE_MORE;
+        xrle_decoder_t dec;
 
         while ((cnt = fread(mem_buffer, 1, 128 * 1024, file)) > 0)
         {
-            uint8_t * maddr = (uint8_t *)mem_buffer;
-            xvid_setw(XM_WR_ADDR, vaddr);
-            for (int i = 0; i < cnt; i += 2)
+            if (first && cnt >= XRLE_HEADER && xrle_check((uint8_t *)mem_buffer))
+            {
+                rle = true;
+                xrle_decode_init(&dec, xrle_spi_literal, xrle_spi_repeat, nullptr);
+                xvid_setw(XM_WR_ADDR, vaddr);
+                printf(" (XRLE)");
+            }
+            first = false;
+
+            if (rle)
             {
-                xvid_sethb(XM_DATA, *maddr++);
-                xvid_setlb(XM_DATA, *maddr++);
+                rc = xrle_decode(&dec, (uint8_t *)mem_buffer, cnt);
+                if (rc != XRLE_MORE)
+                {
+                    if (rc == XRLE_ERROR)
+                    {
+                        printf(" - bad XRLE data");
+                    }
+                    break;
+                }
+                continue;
             }
+
+            xvid_setw(XM_WR_ADDR, vaddr);
+            xvid_stream_words(XM_DATA, (uint8_t *)mem_buffer, cnt >> 1);
             vaddr += (cnt >> 1);
         }
+        if (rle && rc == XRLE_MORE)
+        {
+            printf(" - truncated XRLE data");        // file ended before all words decoded
+        }
 
         fclose(file);
         printf(" - done!\n");
@@ -1042,9 +1246,74 @@ void test_smoothscroll()
     delay(2000);
 }
 
+// text status screen updated each frame with xvid_push_frame (only changed words sent over SPI)
+static void test_push_frame()
+{
+    static uint16_t frame[(848 / 8) * (480 / 16)];
+
+    xvid_setw(XM_XR_ADDR, XR_VID_HSIZE);        // select width
+    width = xvid_getw(XM_XR_DATA);
+    xvid_setw(XM_XR_ADDR, XR_VID_VSIZE);        // select height
+    height  = xvid_getw(XM_XR_DATA);
+    columns = width / 8;
+    rows    = height / 16;
+
+    uint32_t num_words = columns * rows;
+    if (num_words == 0 || num_words > sizeof(frame) / sizeof(frame[0]))
+    {
+        printf("Unexpected video mode %dx%d\n", width, height);
+        return;
+    }
+
+    printf("Dirty-region frame push test (%dx%d text)\n", columns, rows);
+    xvid_setw(XM_XR_ADDR, XR_PA_GFX_CTRL);        // text mode
+    xvid_setw(XM_XR_DATA, 0x0000);
+
+    for (uint32_t i = 0; i < num_words; i++)
+    {
+        frame[i] = 0x0200 | ' ';
+    }
+    uint32_t     pos = 2 * columns;
+    const char * bp  = blurb;
+    while (*bp && pos < num_words)
+    {
+        if (*bp == '\n')
+        {
+            pos = ((pos / columns) + 1) * columns;
+        }
+        else
+        {
+            frame[pos++] = 0x0700 | static_cast<uint8_t>(*bp);
+        }
+        bp++;
+    }
+
+    xvid_shadow_invalidate();
+    push_spi_bytes  = 0;
+    push_full_bytes = 0;
+
+    for (int f = 0; f < 300; f++)
+    {
+        char line[80];
+        snprintf(line, sizeof(line), "Frame %5d  SPI bytes %8zu  %c", f, push_spi_bytes, "|/-\\"[f & 3]);
+        for (uint32_t i = 0; line[i] && i < columns; i++)
+        {
+            frame[i] = 0x0f00 | static_cast<uint8_t>(line[i]);
+        }
+
+        xvid_push_frame(0, frame, num_words);
+        wait_vsync(1);
+    }
+
+    printf("Pushed 300 frames: %zu SPI bytes vs %zu for full frames (%.1fx less)\n",
+           push_spi_bytes,
+           push_full_bytes,
+           push_spi_bytes ? static_cast<double>(push_full_bytes) / push_spi_bytes : 0.0);
+}
 
 bool reset_only    = false;
 bool no_reset      = false;
+bool push_test     = false;
 int  xosera_config = -1;
 
 #define MAX_CMDS 256
@@ -1065,6 +1334,16 @@ int main(int argc, char ** argv)
             no_reset = true;
             continue;
         }
+        else if (strcmp(argv[i], "-d") == 0)
+        {
+            push_test = true;
+            continue;
+        }
+        else if (strcmp(argv[i], "-m") == 0)
+        {
+            host_spi_set_backend(HOST_SPI_MOCK);
+            continue;
+        }
         else if (strncmp(argv[i], "-c", 2) == 0)
         {
             if (argv[i][2] < '0' || argv[i][2] > '3')
@@ -1113,6 +1392,14 @@ int main(int argc, char ** argv)
         exit(res ? EXIT_SUCCESS : EXIT_FAILURE);
     }
 
+    if (push_test)
+    {
+        test_push_frame();
+        host_spi_close();
+
+        exit(EXIT_SUCCESS);
+    }
+
     //    reboot_Xosera(xosera_config);
 
     // mono bitmap mode